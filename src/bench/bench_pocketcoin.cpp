@@ -133,6 +133,17 @@ int main(int argc, char** argv)
 
     SelectParams(CBaseChainParams::REGTEST);
 
+    // Pocket benchmarks fill database with synthetic data - never touch real datadir
+    fs::path tempDataDir;
+    if (!gArgs.IsArgSet("-datadir"))
+    {
+        tempDataDir = fs::temp_directory_path() / strprintf("bench_pocketcoin_%lu_%i", (unsigned long)GetTime(), (int)GetRand(100000));
+        fs::create_directories(tempDataDir);
+        gArgs.ForceSetArg("-datadir", tempDataDir.string());
+    }
+
+    // Checkpoints thread is not running in benchmarks - keep SQLite auto-checkpoint
+    gArgs.SoftSetBoolArg("-sqlwalcheckpoint", false);
 
     PocketDb::InitSQLite(GetDataDir() / "pocketdb");
 
@@ -146,5 +157,10 @@ int main(int argc, char** argv)
 
     benchmark::BenchRunner::RunAll(args);
 
+    PocketDb::SQLiteDbInst.DetachDatabase("web");
+    PocketDb::SQLiteDbInst.Close();
+    if (!tempDataDir.empty())
+        fs::remove_all(tempDataDir);
+
     return EXIT_SUCCESS;
 }
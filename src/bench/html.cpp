@@ -0,0 +1,47 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <bench/bench.h>
+
+#include <validation.h>
+#include <utils/html.h>
+
+#include <string>
+
+// Typical post body - mostly plain text with some markup and escaped symbols
+static std::string MakeText()
+{
+    std::string text;
+    for (int i = 0; i < 50; i++)
+        text += "<p>Lorem ipsum dolor sit amet, <b>consectetur</b> adipiscing elit%2C sed do eiusmod+tempor</p>";
+    return text;
+}
+
+static void HtmlClearTags(benchmark::Bench& bench)
+{
+    const std::string text = MakeText();
+    bench.run([&] {
+        HtmlUtils::ClearHtmlTags(text);
+    });
+}
+
+static void HtmlUrlEncode(benchmark::Bench& bench)
+{
+    const std::string text = MakeText();
+    bench.run([&] {
+        HtmlUtils::UrlEncode(text);
+    });
+}
+
+static void HtmlUrlDecode(benchmark::Bench& bench)
+{
+    const std::string text = MakeText();
+    bench.run([&] {
+        HtmlUtils::UrlDecode(text);
+    });
+}
+
+BENCHMARK(HtmlClearTags);
+BENCHMARK(HtmlUrlEncode);
+BENCHMARK(HtmlUrlDecode);
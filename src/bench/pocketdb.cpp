@@ -0,0 +1,373 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <bench/bench.h>
+
+#include <consensus/merkle.h>
+#include <key_io.h>
+#include <primitives/block.h>
+#include <random.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <version.h>
+
+#include "pocketdb/pocketnet.h"
+#include "pocketdb/consensus/Helper.h"
+#include "pocketdb/consensus/Reputation.h"
+#include "pocketdb/repositories/web/WebRpcRepository.h"
+#include "pocketdb/services/ChainPostProcessing.h"
+#include "pocketdb/services/Serializer.h"
+
+#include <vector>
+
+// Synthetic pocketdb used by all benchmarks below. Chain is built once on first use:
+//  - accounts, posts, comments and scores are spread over blocks of POCKET_BENCH_BLOCK_SIZE transactions
+//  - one more block with fresh comments and scores is written to Transactions but not indexed,
+//    this block is used for measure indexing and consensus validation of "next" block
+static constexpr int POCKET_BENCH_ACCOUNTS = 2000;
+static constexpr int POCKET_BENCH_POSTS = 5000;
+static constexpr int POCKET_BENCH_COMMENTS = 10000;
+static constexpr int POCKET_BENCH_SCORES = 20000;
+static constexpr int POCKET_BENCH_BLOCK_SIZE = 500;
+static constexpr int POCKET_BENCH_NEXT_BLOCK_SIZE = 200;
+
+using namespace PocketTx;
+using namespace PocketDb;
+using namespace PocketServices;
+using namespace PocketConsensus;
+
+// Access to the protected stages of block indexing
+struct BenchChainPostProcessing : public ChainPostProcessing
+{
+    using ChainPostProcessing::PrepareTransactions;
+    using ChainPostProcessing::IndexChain;
+    using ChainPostProcessing::IndexRatings;
+};
+
+struct PocketBenchChain
+{
+    int Height = 1;
+    int64_t Time = 1600000000;
+    uint256 PrevBlockHash;
+
+    vector<string> Accounts;
+    vector<string> Posts;
+    vector<string> Comments;
+
+    CBlock NextBlock;
+    PocketBlockRef NextPocketBlock;
+    int NextHeight = 0;
+
+    vector<string> ListHashes;
+};
+
+static CTransactionRef MakePocketTransaction(const string& opReturnType, const string& address, int64_t time)
+{
+    CMutableTransaction mtx;
+    mtx.nTime = (unsigned int) time;
+
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint(GetRandHash(), 0);
+
+    auto payloadHash = GetRandHash();
+    mtx.vout.resize(2);
+    mtx.vout[0].scriptPubKey = CScript() << OP_RETURN << ParseHex(opReturnType)
+        << std::vector<unsigned char>(payloadHash.begin(), payloadHash.end());
+    mtx.vout[0].nValue = 0;
+    mtx.vout[1].scriptPubKey = GetScriptForDestination(DecodeDestination(address));
+    mtx.vout[1].nValue = 10 * COIN;
+
+    return MakeTransactionRef(mtx);
+}
+
+static PTransactionRef MakePocketPayload(const CTransactionRef& tx, const string& address, const UniValue& payload)
+{
+    auto[ok, ptx] = Serializer::DeserializeTransactionRpc(tx, payload);
+    if (!ok)
+        throw std::runtime_error("Failed build pocket transaction for benchmark");
+
+    ptx->SetString1(address);
+    return ptx;
+}
+
+static string MakeAddress()
+{
+    uint160 keyId;
+    GetRandBytes(keyId.begin(), (int) keyId.size());
+    return EncodeDestination(CKeyID(keyId));
+}
+
+static void FinalizeBlock(PocketBenchChain& chain, CBlock& block)
+{
+    block.nVersion = 1;
+    block.nTime = (uint32_t) chain.Time;
+    block.hashPrevBlock = chain.PrevBlockHash;
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    chain.PrevBlockHash = block.GetHash();
+}
+
+// Builds block from generator, writes pocket transactions and indexes block as ConnectBlock does
+template<typename Generator>
+static void ConnectBenchBlocks(PocketBenchChain& chain, int count, Generator generate)
+{
+    for (int i = 0; i < count; i += POCKET_BENCH_BLOCK_SIZE)
+    {
+        CBlock block;
+        PocketBlock pocketBlock;
+
+        for (int j = i; j < std::min(count, i + POCKET_BENCH_BLOCK_SIZE); j++)
+        {
+            chain.Time += 1;
+            auto[tx, ptx] = generate(j);
+            block.vtx.push_back(tx);
+            pocketBlock.push_back(ptx);
+        }
+
+        chain.Height += 1;
+        FinalizeBlock(chain, block);
+
+        TransRepoInst.InsertTransactions(pocketBlock);
+        ChainPostProcessing::Index(block, chain.Height);
+    }
+}
+
+static tuple<CTransactionRef, PTransactionRef> MakeAccount(PocketBenchChain& chain, int i)
+{
+    auto& address = chain.Accounts[i];
+
+    UniValue payload(UniValue::VOBJ);
+    payload.pushKV("n", strprintf("bench_user_%d", i));
+    payload.pushKV("l", "en");
+    payload.pushKV("a", strprintf("About bench user %d", i));
+    payload.pushKV("i", "https://bastyon.com/images/avatar.png");
+
+    auto tx = MakePocketTransaction(OR_USERINFO, address, chain.Time);
+    return { tx, MakePocketPayload(tx, address, payload) };
+}
+
+static tuple<CTransactionRef, PTransactionRef> MakePost(PocketBenchChain& chain, int i)
+{
+    auto& address = chain.Accounts[i % chain.Accounts.size()];
+
+    UniValue payload(UniValue::VOBJ);
+    payload.pushKV("l", "en");
+    payload.pushKV("c", strprintf("Bench post %d", i));
+    payload.pushKV("m", strprintf("Message of bench post %d with some text for the full text search index", i));
+    payload.pushKV("t", strprintf("[\"tag%d\",\"bench\"]", i % 50));
+    payload.pushKV("i", "[\"https://bastyon.com/images/post.png\"]");
+
+    auto tx = MakePocketTransaction(OR_POST, address, chain.Time);
+    chain.Posts.push_back(tx->GetHash().GetHex());
+    return { tx, MakePocketPayload(tx, address, payload) };
+}
+
+static tuple<CTransactionRef, PTransactionRef> MakeComment(PocketBenchChain& chain, int i)
+{
+    auto& address = chain.Accounts[(i * 7) % chain.Accounts.size()];
+
+    UniValue payload(UniValue::VOBJ);
+    payload.pushKV("postid", chain.Posts[i % chain.Posts.size()]);
+    payload.pushKV("parentid", "");
+    payload.pushKV("answerid", "");
+    payload.pushKV("msg", strprintf("{\"message\":\"Bench comment %d\",\"url\":\"\",\"images\":[]}", i));
+
+    auto tx = MakePocketTransaction(OR_COMMENT, address, chain.Time);
+    chain.Comments.push_back(tx->GetHash().GetHex());
+    return { tx, MakePocketPayload(tx, address, payload) };
+}
+
+static tuple<CTransactionRef, PTransactionRef> MakeScore(PocketBenchChain& chain, int i)
+{
+    auto& address = chain.Accounts[(i * 13) % chain.Accounts.size()];
+
+    UniValue payload(UniValue::VOBJ);
+    payload.pushKV("share", chain.Posts[(i * 31) % chain.Posts.size()]);
+    payload.pushKV("value", 1 + (i % 5));
+
+    auto tx = MakePocketTransaction(OR_SCORE, address, chain.Time);
+    return { tx, MakePocketPayload(tx, address, payload) };
+}
+
+static PocketBenchChain& GetPocketBenchChain()
+{
+    static PocketBenchChain chain;
+    static bool initialized = false;
+    if (initialized)
+        return chain;
+
+    initialized = true;
+
+    for (int i = 0; i < POCKET_BENCH_ACCOUNTS; i++)
+        chain.Accounts.push_back(MakeAddress());
+
+    ConnectBenchBlocks(chain, POCKET_BENCH_ACCOUNTS, [&](int i) { return MakeAccount(chain, i); });
+    ConnectBenchBlocks(chain, POCKET_BENCH_POSTS, [&](int i) { return MakePost(chain, i); });
+    ConnectBenchBlocks(chain, POCKET_BENCH_COMMENTS, [&](int i) { return MakeComment(chain, i); });
+    ConnectBenchBlocks(chain, POCKET_BENCH_SCORES, [&](int i) { return MakeScore(chain, i); });
+
+    // Next block: written to Transactions, but not connected
+    PocketBlock nextPocketBlock;
+    for (int i = 0; i < POCKET_BENCH_NEXT_BLOCK_SIZE; i++)
+    {
+        chain.Time += 1;
+        auto[tx, ptx] = (i % 2 == 0)
+            ? MakeComment(chain, POCKET_BENCH_COMMENTS + i)
+            : MakeScore(chain, POCKET_BENCH_SCORES + i);
+
+        chain.NextBlock.vtx.push_back(tx);
+        nextPocketBlock.push_back(ptx);
+    }
+
+    chain.NextHeight = chain.Height + 1;
+    FinalizeBlock(chain, chain.NextBlock);
+    TransRepoInst.InsertTransactions(nextPocketBlock);
+    chain.NextPocketBlock = make_shared<PocketBlock>(nextPocketBlock);
+
+    // Mixed set of hashes for list requests
+    for (int i = 0; i < 100; i++)
+    {
+        chain.ListHashes.push_back(chain.Posts[(i * 47) % chain.Posts.size()]);
+        chain.ListHashes.push_back(chain.Comments[(i * 89) % chain.Comments.size()]);
+    }
+
+    return chain;
+}
+
+static void PocketDbIndexBlock(benchmark::Bench& bench)
+{
+    auto& chain = GetPocketBenchChain();
+
+    vector<TransactionIndexingInfo> txs;
+    BenchChainPostProcessing::PrepareTransactions(chain.NextBlock, txs);
+    auto blockHash = chain.NextBlock.GetHash().GetHex();
+
+    // Rollback is part of every iteration - otherwise next iteration will find block already indexed
+    bench.batch(txs.size()).unit("tx").run([&] {
+        ChainRepoInst.IndexBlock(blockHash, chain.NextHeight, txs);
+        ChainRepoInst.Rollback(chain.NextHeight);
+    });
+}
+
+static void PocketDbIndexRatings(benchmark::Bench& bench)
+{
+    auto& chain = GetPocketBenchChain();
+
+    vector<TransactionIndexingInfo> txs;
+    BenchChainPostProcessing::PrepareTransactions(chain.NextBlock, txs);
+    auto blockHash = chain.NextBlock.GetHash().GetHex();
+
+    // Ratings are calculated only for indexed scores
+    bench.batch(txs.size()).unit("tx").run([&] {
+        BenchChainPostProcessing::IndexChain(blockHash, chain.NextHeight, txs);
+        BenchChainPostProcessing::IndexRatings(chain.NextHeight, txs);
+        ChainRepoInst.Rollback(chain.NextHeight);
+    });
+}
+
+static void PocketDbConsensusValidate(benchmark::Bench& bench)
+{
+    auto& chain = GetPocketBenchChain();
+
+    bench.batch(chain.NextBlock.vtx.size()).unit("tx").run([&] {
+        auto[ok, result] = SocialConsensusHelper::Validate(chain.NextBlock, chain.NextPocketBlock, chain.NextHeight);
+        ankerl::nanobench::doNotOptimizeAway(ok);
+    });
+}
+
+static void PocketDbDeserializeBlock(benchmark::Bench& bench)
+{
+    auto& chain = GetPocketBenchChain();
+
+    auto pocketData = Serializer::SerializeBlock(*chain.NextPocketBlock);
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << pocketData->write();
+
+    bench.batch(chain.NextBlock.vtx.size()).unit("tx").run([&] {
+        CDataStream streamCopy(stream);
+        auto[ok, pocketBlock] = Serializer::DeserializeBlock(chain.NextBlock, streamCopy);
+        assert(ok && pocketBlock.size() == chain.NextBlock.vtx.size());
+    });
+}
+
+static void PocketDbTransactionList(benchmark::Bench& bench)
+{
+    auto& chain = GetPocketBenchChain();
+
+    bench.batch(chain.ListHashes.size()).unit("tx").run([&] {
+        auto pocketBlock = TransRepoInst.List(chain.ListHashes, true, true, true);
+        assert(pocketBlock->size() == chain.ListHashes.size());
+    });
+}
+
+template<typename Query>
+static void RunFeedBench(benchmark::Bench& bench, Query query)
+{
+    auto& chain = GetPocketBenchChain();
+
+    WebRpcRepository repo(SQLiteDbInst);
+    auto reputationConsensus = ReputationConsensusFactoryInst.Instance(chain.Height);
+    auto badReputationLimit = reputationConsensus->GetConsensusLimit(ConsensusLimit_bad_reputation);
+
+    bench.run([&] {
+        auto result = query(repo, chain, (int) badReputationLimit);
+        ankerl::nanobench::doNotOptimizeAway(result);
+    });
+}
+
+static const vector<int> BenchContentTypes = { CONTENT_POST, CONTENT_VIDEO, CONTENT_ARTICLE };
+
+static void PocketDbHistoricalFeed(benchmark::Bench& bench)
+{
+    RunFeedBench(bench, [](WebRpcRepository& repo, PocketBenchChain& chain, int badReputationLimit) {
+        return repo.GetHistoricalFeed(10, 0, chain.Height, "en", {}, BenchContentTypes, {}, {}, {},
+            chain.Accounts[0], badReputationLimit);
+    });
+}
+
+static void PocketDbHierarchicalFeed(benchmark::Bench& bench)
+{
+    RunFeedBench(bench, [](WebRpcRepository& repo, PocketBenchChain& chain, int badReputationLimit) {
+        return repo.GetHierarchicalFeed(10, 0, chain.Height, "en", {}, BenchContentTypes, {}, {}, {},
+            chain.Accounts[0], badReputationLimit);
+    });
+}
+
+static void PocketDbTopFeed(benchmark::Bench& bench)
+{
+    RunFeedBench(bench, [](WebRpcRepository& repo, PocketBenchChain& chain, int badReputationLimit) {
+        return repo.GetTopFeed(10, 0, chain.Height, "en", {}, BenchContentTypes, {}, {}, {},
+            chain.Accounts[0], 60 * 24 * 30, badReputationLimit);
+    });
+}
+
+static void PocketDbProfileFeed(benchmark::Bench& bench)
+{
+    RunFeedBench(bench, [](WebRpcRepository& repo, PocketBenchChain& chain, int badReputationLimit) {
+        return repo.GetProfileFeed(chain.Accounts[1], 10, 0, 0, chain.Height, "en", {}, BenchContentTypes, {}, {}, {},
+            chain.Accounts[0], "", "", "desc");
+    });
+}
+
+static void PocketDbAccountProfiles(benchmark::Bench& bench)
+{
+    vector<string> addresses;
+    auto& chain = GetPocketBenchChain();
+    for (int i = 0; i < 50; i++)
+        addresses.push_back(chain.Accounts[(i * 37) % chain.Accounts.size()]);
+
+    RunFeedBench(bench, [&](WebRpcRepository& repo, PocketBenchChain& chain, int badReputationLimit) {
+        return repo.GetAccountProfiles(addresses, true);
+    });
+}
+
+BENCHMARK(PocketDbIndexBlock);
+BENCHMARK(PocketDbIndexRatings);
+BENCHMARK(PocketDbConsensusValidate);
+BENCHMARK(PocketDbDeserializeBlock);
+BENCHMARK(PocketDbTransactionList);
+BENCHMARK(PocketDbHistoricalFeed);
+BENCHMARK(PocketDbHierarchicalFeed);
+BENCHMARK(PocketDbTopFeed);
+BENCHMARK(PocketDbProfileFeed);
+BENCHMARK(PocketDbAccountProfiles);
@@ -13,6 +13,10 @@
 #include <validation.h>
 #include <util.h>
 
+#include "pocketdb/pocketnet.h"
+#include "pocketdb/services/Accessor.h"
+#include "pocketdb/services/Serializer.h"
+
 #include <unordered_map>
 
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, bool fUseWTXID) :
@@ -103,6 +107,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         return READ_STATUS_FAILED; // Short ID collision
 
     std::vector<bool> have_txn(txn_available.size());
+    txn_from_extra.assign(txn_available.size(), false);
     {
     LOCK(pool->cs);
     const std::vector<std::pair<uint256, CTxMemPool::txiter> >& vTxHashes = pool->vTxHashes;
@@ -138,6 +143,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
                 txn_available[idit->second] = extra_txn[i].second;
+                txn_from_extra[idit->second] = true;
                 have_txn[idit->second]  = true;
                 mempool_count++;
                 extra_count++;
@@ -151,6 +157,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
                 if (txn_available[idit->second] &&
                         txn_available[idit->second]->GetWitnessHash() != extra_txn[i].second->GetWitnessHash()) {
                     txn_available[idit->second].reset();
+                    txn_from_extra[idit->second] = false;
                     mempool_count--;
                     extra_count--;
                 }
@@ -218,3 +225,99 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
 
     return READ_STATUS_OK;
 }
+
+void PartiallyDownloadedBlock::AddPocketData(const UniValue& data) {
+    if (data.isObject()) {
+        const auto& keys = data.getKeys();
+        const auto& values = data.getValues();
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (values[i].isStr())
+                pocket_data.emplace(keys[i], values[i].get_str());
+        }
+    }
+
+    for (size_t i = 0; i < txn_available.size(); i++) {
+        if (!txn_available[i] || !txn_from_extra[i])
+            continue;
+
+        if (PocketHelpers::TransactionHelper::IsPocketTransaction(txn_available[i]) &&
+            pocket_data.find(txn_available[i]->GetHash().GetHex()) == pocket_data.end()) {
+            txn_available[i].reset();
+            txn_from_extra[i] = false;
+            mempool_count--;
+            extra_count--;
+        }
+    }
+}
+
+ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing, PocketHelpers::PocketBlockRef& pocketBlock) {
+    pocketBlock = std::make_shared<PocketHelpers::PocketBlock>();
+
+    ReadStatus status = FillBlock(block, vtx_missing);
+    if (status != READ_STATUS_OK)
+        return status;
+
+    return FillPocketBlock(block, pocketBlock);
+}
+
+ReadStatus PartiallyDownloadedBlock::FillPocketBlock(const CBlock& block, PocketHelpers::PocketBlockRef& pocketBlock) const {
+    UniValue data(UniValue::VOBJ);
+    std::vector<std::string> stored;
+    for (const auto& tx : block.vtx) {
+        if (!PocketHelpers::TransactionHelper::IsPocketTransaction(tx))
+            continue;
+
+        auto txHash = tx->GetHash().GetHex();
+        if (auto it = pocket_data.find(txHash); it != pocket_data.end())
+            data.pushKV(txHash, it->second);
+        else
+            stored.push_back(txHash);
+    }
+
+    // Payloads not received with the block were accepted to mempool together with transactions
+    if (!stored.empty()) {
+        try {
+            auto storedBlock = PocketDb::TransRepoInst.List(stored, true);
+            if (!storedBlock || storedBlock->size() != stored.size()) {
+                LogPrint(BCLog::CMPCTBLOCK, "Pocket payloads for block %s not found in mempool (%lu of %lu)\n",
+                    block.GetHash().ToString(), storedBlock ? storedBlock->size() : 0, stored.size());
+                return READ_STATUS_FAILED;
+            }
+
+            for (const auto& ptx : *storedBlock) {
+                if (auto dataPtr = PocketServices::Serializer::SerializeTransaction(*ptx))
+                    data.pushKV(*ptx->GetHash(), dataPtr->write());
+            }
+        } catch (const std::exception& e) {
+            LogPrintf("Error: %s (%s) - %s\n", __func__, block.GetHash().ToString(), e.what());
+            return READ_STATUS_FAILED;
+        }
+    }
+
+    auto[ok, result] = PocketServices::Serializer::DeserializeBlock(block, data);
+    pocketBlock = std::make_shared<PocketHelpers::PocketBlock>(result);
+
+    LogPrint(BCLog::CMPCTBLOCK, "Reconstructed pocket part of block %s with %lu payloads received and %lu from mempool\n",
+        block.GetHash().ToString(), data.size() - stored.size(), stored.size());
+
+    return READ_STATUS_OK;
+}
+
+bool GetCompactPocketData(const CBlock& block, const PocketHelpers::PocketBlockRef& pocketBlock, const CTxMemPool& pool, std::string& data) {
+    if (!pocketBlock) {
+        CBlock missing;
+        for (const auto& tx : block.vtx)
+            if (!pool.exists(tx->GetHash()))
+                missing.vtx.push_back(tx);
+
+        return PocketServices::Accessor::GetBlock(missing, data);
+    }
+
+    PocketHelpers::PocketBlock missing;
+    for (const auto& ptx : *pocketBlock)
+        if (!pool.exists(uint256S(*ptx->GetHash())))
+            missing.push_back(ptx);
+
+    data = PocketServices::Serializer::SerializeBlock(missing)->write();
+    return true;
+}
@@ -7,7 +7,10 @@
 
 #include <primitives/block.h>
 
+#include "pocketdb/helpers/TransactionHelper.h"
+
 #include <memory>
+#include <unordered_map>
 
 class CTxMemPool;
 
@@ -141,8 +144,13 @@ public:
 class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
+    std::vector<bool> txn_from_extra;
     size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
     CTxMemPool* pool;
+    // Pocket payloads received with the block (transaction hash -> serialized data)
+    std::unordered_map<std::string, std::string> pocket_data;
+
+    ReadStatus FillPocketBlock(const CBlock& block, PocketHelpers::PocketBlockRef& pocketBlock) const;
 public:
     CBlockHeader header;
     std::vector<unsigned char> vchBlockSig;
@@ -152,6 +160,20 @@ public:
     ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
     bool IsTxAvailable(size_t index) const;
     ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
+
+    // Peers with COMPACT_POCKET_VERSION send only payloads we can't take from the mempool pocket store.
+    // Pocket transactions matched from extra pool have no stored payload - if it is not
+    // received with the block, transaction is marked as missing and requested with getblocktxn.
+    void AddPocketData(const UniValue& data);
+    // Fill block and build pocket part from received payloads and mempool pocket store
+    ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing, PocketHelpers::PocketBlockRef& pocketBlock);
 };
 
+/**
+ * Pocket payloads for compact block relay to peers with COMPACT_POCKET_VERSION.
+ * Transactions still in pool were relayed to peers together with payloads,
+ * so only payloads of the rest are sent - peers take others from own mempool.
+ */
+bool GetCompactPocketData(const CBlock& block, const PocketHelpers::PocketBlockRef& pocketBlock, const CTxMemPool& pool, std::string& data);
+
 #endif // POCKETCOIN_BLOCKENCODINGS_H
@@ -0,0 +1,232 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <blockreader.h>
+
+#include <clientversion.h>
+#include <compat.h>
+#include <consensus/consensus.h>
+#include <crypto/common.h>
+#include <streams.h>
+#include <util.h>
+#include <validation.h>
+
+#ifndef WIN32
+#include <sys/stat.h>
+#endif
+
+CBlockReader g_block_reader;
+
+static uint64_t RecentKey(const CDiskBlockPos& pos)
+{
+    return ((uint64_t) pos.nFile << 32) | pos.nPos;
+}
+
+CBlockReader::MappedFile::~MappedFile()
+{
+#ifndef WIN32
+    if (data)
+        munmap((void*) data, size);
+#endif
+}
+
+CBlockReader::~CBlockReader() = default;
+
+std::shared_ptr<const CBlock> CBlockReader::GetRecent(const CDiskBlockPos& pos)
+{
+    LOCK(m_recent_mutex);
+
+    auto it = m_recent_index.find(RecentKey(pos));
+    if (it == m_recent_index.end())
+        return nullptr;
+
+    m_recent.splice(m_recent.begin(), m_recent, it->second);
+    return it->second->second;
+}
+
+void CBlockReader::PutRecent(const CDiskBlockPos& pos, const CBlock& block)
+{
+    static const size_t maxSize = (size_t) std::max<int64_t>(0, gArgs.GetArg("-blockreadcache", DEFAULT_BLOCK_READ_CACHE));
+    if (maxSize == 0)
+        return;
+
+    auto key = RecentKey(pos);
+    auto recent = std::make_shared<const CBlock>(block);
+
+    LOCK(m_recent_mutex);
+
+    if (auto it = m_recent_index.find(key); it != m_recent_index.end())
+    {
+        m_recent.erase(it->second);
+        m_recent_index.erase(it);
+    }
+
+    m_recent.emplace_front(key, std::move(recent));
+    m_recent_index.emplace(key, m_recent.begin());
+
+    while (m_recent.size() > maxSize)
+    {
+        m_recent_index.erase(m_recent.back().first);
+        m_recent.pop_back();
+    }
+}
+
+std::shared_ptr<const CBlockReader::MappedFile> CBlockReader::MapFile(int nFile, size_t end)
+{
+#ifdef WIN32
+    return nullptr;
+#else
+    static const bool enabled = gArgs.GetBoolArg("-blockmmap", DEFAULT_BLOCK_MMAP);
+    if (!enabled)
+        return nullptr;
+
+    LOCK(m_files_mutex);
+
+    auto it = m_files.find(nFile);
+    if (it != m_files.end() && it->second->size >= end)
+        return it->second;
+
+    // Not mapped yet or the last file grew since mapping - readers keep the old mapping alive
+    int fd = open(GetBlockPosFilename(CDiskBlockPos(nFile, 0), "blk").string().c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || (size_t) st.st_size < end)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* addr = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+    {
+        LogPrint(BCLog::BENCH, "%s: Unable to map block file %05u\n", __func__, nFile);
+        return nullptr;
+    }
+
+    auto file = std::make_shared<MappedFile>();
+    file->data = (const unsigned char*) addr;
+    file->size = (size_t) st.st_size;
+
+    // Recent blocks are asked most - release the oldest files first
+    if (it == m_files.end() && m_files.size() >= MAX_MAPPED_BLOCK_FILES)
+        m_files.erase(m_files.begin());
+
+    m_files[nFile] = file;
+    return file;
+#endif
+}
+
+Span<const unsigned char> CBlockReader::MapBlock(const CDiskBlockPos& pos, std::shared_ptr<const MappedFile>& file)
+{
+    // Block size is stored right before the block
+    if (pos.IsNull() || pos.nPos < 4)
+        return {};
+
+    file = MapFile(pos.nFile, pos.nPos);
+    if (!file)
+        return {};
+
+    uint32_t size = ReadLE32(file->data + pos.nPos - 4);
+    if (size < 80 || size > MAX_BLOCK_SERIALIZED_SIZE)
+        return {};
+
+    if ((size_t) pos.nPos + size > file->size)
+    {
+        file = MapFile(pos.nFile, (size_t) pos.nPos + size);
+        if (!file)
+            return {};
+    }
+
+    return Span<const unsigned char>(file->data + pos.nPos, size);
+}
+
+bool CBlockReader::ReadBlock(const CDiskBlockPos& pos, CBlock& block)
+{
+    std::shared_ptr<const MappedFile> file;
+    auto data = MapBlock(pos, file);
+    if (data.size() == 0)
+        return false;
+
+    try
+    {
+        SpanReader reader(SER_DISK, CLIENT_VERSION, data);
+        reader >> block;
+    }
+    catch (const std::exception&)
+    {
+        block.SetNull();
+        return false;
+    }
+
+    return true;
+}
+
+bool CBlockReader::ReadTransaction(const CDiskBlockPos& pos, unsigned int txOffset, const uint256& hash,
+    uint256& blockHash, CTransactionRef& tx)
+{
+    if (auto recent = GetRecent(pos))
+    {
+        for (const auto& recentTx : recent->vtx)
+        {
+            if (recentTx->GetHash() == hash)
+            {
+                tx = recentTx;
+                blockHash = recent->GetHash();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::shared_ptr<const MappedFile> file;
+    auto data = MapBlock(pos, file);
+    if (data.size() == 0)
+        return false;
+
+    try
+    {
+        CBlockHeader header;
+        SpanReader reader(SER_DISK, CLIENT_VERSION, data);
+        reader >> header;
+        reader.ignore(txOffset);
+        reader >> tx;
+
+        if (tx->GetHash() != hash)
+            return false;
+
+        blockHash = header.GetHash();
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void CBlockReader::ForgetFile(int nFile)
+{
+    {
+        LOCK(m_files_mutex);
+        m_files.erase(nFile);
+    }
+
+    LOCK(m_recent_mutex);
+    for (auto it = m_recent.begin(); it != m_recent.end();)
+    {
+        if ((int) (it->first >> 32) == nFile)
+        {
+            m_recent_index.erase(it->first);
+            it = m_recent.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETCOIN_BLOCKREADER_H
+#define POCKETCOIN_BLOCKREADER_H
+
+#include <chain.h>
+#include <primitives/block.h>
+#include <sync.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+/** Default for -blockmmap */
+static const bool DEFAULT_BLOCK_MMAP = true;
+/** Default for -blockreadcache - number of recently read blocks kept deserialized */
+static const int DEFAULT_BLOCK_READ_CACHE = 32;
+/** Maximum number of block files mapped at once */
+static const size_t MAX_MAPPED_BLOCK_FILES = 64;
+
+/**
+ * Reads of stored blocks without opening block files for every request.
+ * Block files are mapped read-only and blocks are deserialized directly from the mapped memory.
+ * Recently read blocks are kept deserialized - transactions are shared, so a hit costs
+ * only copying of the transaction pointers.
+ * Stored blocks never change, only whole files are removed by pruning (see ForgetFile).
+ */
+class CBlockReader
+{
+public:
+    ~CBlockReader();
+
+    /** Recently read block at pos or nullptr */
+    std::shared_ptr<const CBlock> GetRecent(const CDiskBlockPos& pos);
+    void PutRecent(const CDiskBlockPos& pos, const CBlock& block);
+
+    /**
+     * Deserialize block at pos from the mapped block file.
+     * Returns false if the block can not be read this way - the caller reads it with the file stream then.
+     */
+    bool ReadBlock(const CDiskBlockPos& pos, CBlock& block);
+
+    /**
+     * Read transaction stored txOffset bytes after the header of block at pos.
+     * Only the header and the requested transaction are deserialized.
+     */
+    bool ReadTransaction(const CDiskBlockPos& pos, unsigned int txOffset, const uint256& hash,
+        uint256& blockHash, CTransactionRef& tx);
+
+    /** Drop mapping and recent blocks of removed block file */
+    void ForgetFile(int nFile);
+
+private:
+    struct MappedFile
+    {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+
+        ~MappedFile();
+    };
+
+    Mutex m_files_mutex;
+    std::map<int, std::shared_ptr<const MappedFile>> m_files GUARDED_BY(m_files_mutex);
+
+    Mutex m_recent_mutex;
+    std::list<std::pair<uint64_t, std::shared_ptr<const CBlock>>> m_recent GUARDED_BY(m_recent_mutex);
+    std::unordered_map<uint64_t, decltype(m_recent)::iterator> m_recent_index GUARDED_BY(m_recent_mutex);
+
+    /** Mapping of the block file covering at least end bytes - remapped if the file grew since mapping */
+    std::shared_ptr<const MappedFile> MapFile(int nFile, size_t end);
+
+    /** Serialized block at pos in mapped file - empty if not available */
+    Span<const unsigned char> MapBlock(const CDiskBlockPos& pos, std::shared_ptr<const MappedFile>& file);
+};
+
+extern CBlockReader g_block_reader;
+
+#endif // POCKETCOIN_BLOCKREADER_H
@@ -162,6 +162,9 @@ public:
         checkpointData = {
             {}};
 
+        // Published Pocket DB snapshots: height -> {block hash, snapshot hash}
+        pocketDbSnapshots = {};
+
         chainTxData = ChainTxData{
             // Data from rpc: getchaintxstats 4096 afb95bb18c88b1306208771a4d6dde19aa5d426f679d06ceb776b3603df67952
             /* nTime    */ 1617188640,
@@ -276,6 +279,9 @@ public:
         checkpointData = {
             {}};
 
+        // Published Pocket DB snapshots: height -> {block hash, snapshot hash}
+        pocketDbSnapshots = {};
+
         chainTxData = ChainTxData{
             // Data from rpc: getchaintxstats 4096 0000000000000000002e63058c023a9a1de233554f28c7b21380b6c9003f36a8
             /* nTime    */ 1532884444,
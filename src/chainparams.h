@@ -25,6 +25,14 @@ struct CCheckpointData {
     MapCheckpoints mapCheckpoints;
 };
 
+/** Known Pocket DB snapshot - block at snapshot height and hash of snapshot manifest */
+struct PocketDbSnapshotData {
+    uint256 blockHash;
+    uint256 snapshotHash;
+};
+
+typedef std::map<int, PocketDbSnapshotData> MapPocketDbSnapshots;
+
 /**
  * Holds various statistics on transactions within a chain. Used to estimate
  * verification progress during chain sync.
@@ -87,6 +95,8 @@ public:
     const std::string& Bech32HRP() const { return bech32_hrp; }
     const std::vector<SeedSpec6>& FixedSeeds() const { return vFixedSeeds; }
     const CCheckpointData& Checkpoints() const { return checkpointData; }
+    /** Pocket DB snapshots accepted by -loadpocketdbsnapshot */
+    const MapPocketDbSnapshots& PocketDbSnapshots() const { return pocketDbSnapshots; }
     const ChainTxData& TxData() const { return chainTxData; }
     void UpdateVersionBitsParameters(Consensus::DeploymentPos d, int64_t nStartTime, int64_t nTimeout);
 protected:
@@ -107,6 +117,7 @@ protected:
     bool fRequireStandard;
     bool fMineBlocksOnDemand;
     CCheckpointData checkpointData;
+    MapPocketDbSnapshots pocketDbSnapshots;
     ChainTxData chainTxData;
     bool m_fallback_fee_enabled;
 };
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <httpserver.h>
+#include <httpworkqueue.h>
 
 #include <chainparamsbase.h>
 #include <util.h>
@@ -18,6 +19,8 @@
 #include <walletinitinterface.h>
 #include "eventloop.h"
 
+#include <event2/listener.h>
+
 #ifdef EVENT__HAVE_NETINET_IN_H
 #include <netinet/in.h>
 #ifdef _XOPEN_SOURCE_EXTENDED
@@ -368,6 +371,15 @@ bool InitHTTPServer()
     int workQueuePublicDepth = std::max((long) gArgs.GetArg("-rpcpublicworkqueue", DEFAULT_HTTP_PUBLIC_WORKQUEUE), 1L);
     int workQueueStaticDepth = std::max((long) gArgs.GetArg("-rpcstaticworkqueue", DEFAULT_HTTP_STATIC_WORKQUEUE), 1L);
     int workQueueRestDepth = std::max((long) gArgs.GetArg("-rpcrestworkqueue", DEFAULT_HTTP_REST_WORKQUEUE), 1L);
+    int publicLoops = std::max((long) gArgs.GetArg("-rpcpublicloops", DEFAULT_HTTP_PUBLIC_LOOPS), 1L);
+
+    if (!g_rpcMethodCosts.Configure(gArgs.GetArgs("-rpcmethodcost")))
+    {
+        uiInterface.ThreadSafeMessageBox(
+            "Invalid -rpcmethodcost specification. Valid is <method>:<cheap|normal|heavy>.",
+            "", CClientUIInterface::MSG_ERROR);
+        return false;
+    }
 
     raii_event_base base_ctr = obtain_event_base();
     eventBase = base_ctr.get();
@@ -384,18 +396,19 @@ bool InitHTTPServer()
     RegisterZMQRPCCommands(g_socket->m_table_rpc);
 #endif
 
-    // Additional pocketnet seocket
+    // Public sockets accept and reply on their own event loops
+    // so heavy public traffic does not delay the private RPC socket
     if (gArgs.GetBoolArg("-api", DEFAULT_API_ENABLE))
     {
-        g_webSocket = new HTTPWebSocket(eventBase, timeout, workQueuePublicDepth, workQueuePostDepth, true);
+        g_webSocket = new HTTPWebSocket(nullptr, timeout, workQueuePublicDepth, workQueuePostDepth, true, publicLoops);
         RegisterPocketnetWebRPCCommands(g_webSocket->m_table_rpc, g_webSocket->m_table_post_rpc);
     }
 
     if (gArgs.GetBoolArg("-rest", DEFAULT_REST_ENABLE))
-        g_restSocket = new HTTPSocket(eventBase, timeout, workQueueRestDepth, true);
+        g_restSocket = new HTTPSocket(nullptr, timeout, workQueueRestDepth, true);
 
     if (gArgs.GetBoolArg("-static", DEFAULT_STATIC_ENABLE))
-        g_staticSocket = new HTTPSocket(eventBase, timeout, workQueueStaticDepth, true);
+        g_staticSocket = new HTTPSocket(nullptr, timeout, workQueueStaticDepth, true);
  
     if (!HTTPBindAddresses())
     {
@@ -435,6 +448,7 @@ void StartHTTPServer()
     int rpcPublicThreads = std::max((long) gArgs.GetArg("-rpcpublicthreads", DEFAULT_HTTP_PUBLIC_THREADS), 1L);
     int rpcStaticThreads = std::max((long) gArgs.GetArg("-rpcstaticthreads", DEFAULT_HTTP_STATIC_THREADS), 1L);
     int rpcRestThreads = std::max((long) gArgs.GetArg("-rpcrestthreads", DEFAULT_HTTP_REST_THREADS), 1L);
+    int rpcBatchThreads = std::max((long) gArgs.GetArg("-rpcbatchthreads", DEFAULT_HTTP_BATCH_THREADS), 1L);
 
     std::packaged_task<bool(event_base *)> task(ThreadHTTP);
     threadResult = task.get_future();
@@ -449,7 +463,7 @@ void StartHTTPServer()
     // The same worker threads will service POST and PUBLIC RPC requests
     if (g_webSocket)
     {
-        g_webSocket->StartHTTPSocket(rpcPublicThreads, rpcPostThreads, true);
+        g_webSocket->StartHTTPSocket(rpcPublicThreads, rpcPostThreads, rpcBatchThreads, true);
         LogPrintf("HTTP: starting %d Public worker threads\n", rpcPublicThreads);
     }
     if (g_staticSocket)
@@ -505,6 +519,10 @@ void StopHTTPServer()
         threadHTTP.join();
     }
 
+    if (g_webSocket) g_webSocket->StopEventLoops();
+    if (g_staticSocket) g_staticSocket->StopEventLoops();
+    if (g_restSocket) g_restSocket->StopEventLoops();
+
     delete g_socket;
     g_socket = nullptr;
 
@@ -539,23 +557,62 @@ static void httpevent_callback_fn(evutil_socket_t, short, void *data)
         delete self;
 }
 
-HTTPSocket::HTTPSocket(struct event_base *base, int timeout, int queueDepth, bool publicAccess):
-    m_http(nullptr), m_eventHTTP(nullptr), m_workQueue(nullptr), m_publicAccess(publicAccess)
+HTTPSocket::HTTPSocket(struct event_base *base, int timeout, int queueDepth, bool publicAccess, int loops):
+    m_workQueue(nullptr), m_publicAccess(publicAccess)
+{
+    if (base)
+        loops = 1;
+#if !defined(LEV_OPT_REUSEABLE_PORT) || defined(WIN32)
+    // Without SO_REUSEPORT only one loop can listen on the address
+    loops = 1;
+#endif
+
+    for (int i = 0; i < std::max(loops, 1); i++)
+    {
+        if (!AddEventLoop(base, timeout))
+            break;
+    }
+
+    m_workQueue = std::make_shared<QueueLimited<std::unique_ptr<HTTPClosure>>>(queueDepth);
+    LogPrintf("HTTP: creating work queue of depth %d\n", queueDepth);
+}
+
+HTTPSocket::~HTTPSocket()
+{
+    for (auto& loop : m_loops)
+    {
+        if (loop.http)
+            evhttp_free(loop.http);
+
+        if (loop.ownBase)
+            event_base_free(loop.base);
+    }
+
+    m_loops.clear();
+}
+
+bool HTTPSocket::AddEventLoop(struct event_base *base, int timeout)
 {
+    EventLoop loop;
+    loop.ownBase = !base;
+
+    raii_event_base base_ctr = loop.ownBase ? obtain_event_base() : raii_event_base(nullptr);
+    loop.base = loop.ownBase ? base_ctr.get() : base;
+
     /* Create a new evhttp object to handle requests. */
-    raii_evhttp http_ctr = obtain_evhttp(base);
-    m_http = http_ctr.get();
-    if (!m_http)
+    raii_evhttp http_ctr = obtain_evhttp(loop.base);
+    loop.http = http_ctr.get();
+    if (!loop.http)
     {
         LogPrintf("couldn't create evhttp. Exiting.\n");
-        return;
+        return false;
     }
 
-    evhttp_set_timeout(m_http, gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
-    evhttp_set_max_headers_size(m_http, MAX_HEADERS_SIZE);
-    evhttp_set_max_body_size(m_http, MAX_SIZE);
-    evhttp_set_gencb(m_http, http_request_cb, (void*) this);
-    evhttp_set_allowed_methods(m_http,
+    evhttp_set_timeout(loop.http, timeout);
+    evhttp_set_max_headers_size(loop.http, MAX_HEADERS_SIZE);
+    evhttp_set_max_body_size(loop.http, MAX_SIZE);
+    evhttp_set_gencb(loop.http, http_request_cb, (void*) this);
+    evhttp_set_allowed_methods(loop.http,
         evhttp_cmd_type::EVHTTP_REQ_GET |
         evhttp_cmd_type::EVHTTP_REQ_POST |
         evhttp_cmd_type::EVHTTP_REQ_HEAD |
@@ -564,20 +621,11 @@ HTTPSocket::HTTPSocket(struct event_base *base, int timeout, int queueDepth, boo
         evhttp_cmd_type::EVHTTP_REQ_OPTIONS
     );
 
-    m_workQueue = std::make_shared<QueueLimited<std::unique_ptr<HTTPClosure>>>(queueDepth);
-    LogPrintf("HTTP: creating work queue of depth %d\n", queueDepth);
-
-    // transfer ownership to eventBase/HTTP via .release()
-    m_eventHTTP = http_ctr.release(); 
-}
-
-HTTPSocket::~HTTPSocket()
-{
-    if (m_eventHTTP)
-    {
-        evhttp_free(m_eventHTTP);
-        m_eventHTTP = nullptr;
-    }
+    // transfer ownership to socket via .release()
+    http_ctr.release();
+    base_ctr.release();
+    m_loops.push_back(std::move(loop));
+    return true;
 }
 
 void HTTPSocket::StartThreads(const std::string name, std::shared_ptr<Queue<std::unique_ptr<HTTPClosure>>> queue, int threadCount, bool selfDbConnection)
@@ -592,8 +640,46 @@ void HTTPSocket::StartThreads(const std::string name, std::shared_ptr<Queue<std:
     }
 }
 
+void HTTPSocket::StartEventLoops()
+{
+    for (auto& loop : m_loops)
+    {
+        if (!loop.ownBase || loop.thread.joinable())
+            continue;
+
+        std::packaged_task<bool(event_base *)> task(ThreadHTTP);
+        loop.result = task.get_future();
+        loop.thread = std::thread(std::move(task), loop.base);
+    }
+}
+
+void HTTPSocket::StopEventLoops()
+{
+    // Exit the event loops as soon as there are no active events
+    for (auto& loop : m_loops)
+        if (loop.thread.joinable())
+            event_base_loopexit(loop.base, nullptr);
+
+    // Give event loops a few seconds to send back last responses, then break them
+    for (auto& loop : m_loops)
+    {
+        if (!loop.thread.joinable())
+            continue;
+
+        if (loop.result.valid() &&
+            loop.result.wait_for(std::chrono::milliseconds(2000)) == std::future_status::timeout)
+        {
+            LogPrintf("HTTP event loop did not exit within allotted time, sending loopbreak\n");
+            event_base_loopbreak(loop.base);
+        }
+
+        loop.thread.join();
+    }
+}
+
 void HTTPSocket::StartHTTPSocket(int threadCount, bool selfDbConnection)
 {
+    StartEventLoops();
     StartThreads("HTTPSocket::StartHTTPSocket", m_workQueue, threadCount, selfDbConnection);
 }
 
@@ -614,15 +700,17 @@ void HTTPSocket::InterruptHTTPSocket()
     if (m_thread_http_workers.empty())
         return;
         
-    if (m_eventHTTP)
+    for (auto& loop : m_loops)
     {
         // Unlisten sockets
-        for (evhttp_bound_socket *socket : m_boundSockets)
+        for (evhttp_bound_socket *socket : loop.boundSockets)
         {
-            evhttp_del_accept_socket(m_eventHTTP, socket);
+            evhttp_del_accept_socket(loop.http, socket);
         }
+        loop.boundSockets.clear();
+
         // Reject requests on current connections
-        evhttp_set_gencb(m_eventHTTP, http_reject_request_cb, nullptr);
+        evhttp_set_gencb(loop.http, http_reject_request_cb, nullptr);
     }
 
     // Do not clear queue so if we want to start again call StartHTTPSocket
@@ -634,23 +722,52 @@ void HTTPSocket::InterruptHTTPSocket()
     m_thread_http_workers.clear();
 }
 
+/** Bind own listener with SO_REUSEPORT so every loop of the socket accepts on the same address */
+static evhttp_bound_socket* BindReusePort(struct evhttp* http, struct event_base* base, const std::string& ipAddr, int port)
+{
+#if defined(LEV_OPT_REUSEABLE_PORT) && !defined(WIN32)
+    std::string endpoint = (ipAddr.find(':') != std::string::npos ? "[" + ipAddr + "]" : ipAddr) + ":" + std::to_string(port);
+
+    struct sockaddr_storage addr{};
+    int addrLen = sizeof(addr);
+    if (evutil_parse_sockaddr_port(endpoint.c_str(), (struct sockaddr*) &addr, &addrLen) != 0)
+        return nullptr;
+
+    evconnlistener *listener = evconnlistener_new_bind(base, nullptr, nullptr,
+        LEV_OPT_REUSEABLE | LEV_OPT_REUSEABLE_PORT | LEV_OPT_CLOSE_ON_FREE | LEV_OPT_CLOSE_ON_EXEC,
+        -1, (struct sockaddr*) &addr, addrLen);
+    if (!listener)
+        return nullptr;
+
+    return evhttp_bind_listener(http, listener);
+#else
+    return nullptr;
+#endif
+}
+
 void HTTPSocket::BindAddress(std::string ipAddr, int port)
 { 
     LogPrint(BCLog::HTTP, "Binding RPC on address %s port %i\n", ipAddr, port);
-    evhttp_bound_socket *bind_handle = evhttp_bind_socket_with_handle(m_eventHTTP, ipAddr.empty() ? nullptr : ipAddr.c_str(), port);
-    if (bind_handle)
-    {
-        m_boundSockets.push_back(bind_handle);
-    }
-    else
+    for (auto& loop : m_loops)
     {
-        LogPrint(BCLog::HTTP,"Binding RPC on address %s port %i failed.\n", ipAddr, port);
+        evhttp_bound_socket *bind_handle = m_loops.size() > 1 ?
+            BindReusePort(loop.http, loop.base, ipAddr, port) :
+            evhttp_bind_socket_with_handle(loop.http, ipAddr.empty() ? nullptr : ipAddr.c_str(), port);
+
+        if (bind_handle)
+        {
+            loop.boundSockets.push_back(bind_handle);
+        }
+        else
+        {
+            LogPrint(BCLog::HTTP,"Binding RPC on address %s port %i failed.\n", ipAddr, port);
+        }
     }
 }
 
 int HTTPSocket::GetAddressCount()
 {
-    return (int)m_boundSockets.size();
+    return m_loops.empty() ? 0 : (int)m_loops.front().boundSockets.size();
 }
 
 void HTTPSocket::RegisterHTTPHandler(const std::string &prefix, bool exactMatch,
@@ -736,7 +853,13 @@ bool HTTPSocket::HTTPReq(HTTPRequest* req, CRPCTable& table)
             LogPrint(BCLog::RPC, "RPC started method %s%s (%s) with params: %s\n",
                 uri, method, rpcKey, prms);
 
-            UniValue result = table.execute(jreq);
+            // Methods with raw handlers write result JSON directly
+            std::string rawResult;
+            bool raw = table.executeRaw(jreq, rawResult);
+
+            UniValue result;
+            if (!raw)
+                result = table.execute(jreq);
 
             auto execute = gStatEngineInstance.GetCurrentSystemTime();
 
@@ -744,13 +867,24 @@ bool HTTPSocket::HTTPReq(HTTPRequest* req, CRPCTable& table)
                 uri, method, rpcKey, (execute.count() - start.count()));
 
             // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            strReply = raw ? JSONRPCReplyRaw(rawResult, jreq.id) : JSONRPCReply(result, NullUniValue, jreq.id);
         }
         else
         {
             if (valRequest.isArray())
             {
-                strReply = JSONRPCExecBatch(jreq, valRequest.get_array(), table);
+                jreq.SetDbConnection(req->DbConnection());
+
+                RPCBatchSpawn spawn;
+                if (auto batchQueue = m_workBatchQueue)
+                {
+                    spawn = [batchQueue](std::function<void(const DbConnectionRef&)> func)
+                    {
+                        return batchQueue->Add(std::make_unique<HTTPTaskItem>(std::move(func)));
+                    };
+                }
+
+                strReply = JSONRPCExecBatch(jreq, valRequest.get_array(), table, spawn, m_batchParallel);
             }
             else
             {
@@ -797,19 +931,28 @@ bool HTTPSocket::HTTPReq(HTTPRequest* req, CRPCTable& table)
 }
 
 /** WebSocket for public API */
-HTTPWebSocket::HTTPWebSocket(struct event_base* base, int timeout, int queueDepth, int queuePostDepth, bool publicAccess)
-    : HTTPSocket(base, timeout, queueDepth, publicAccess)
+HTTPWebSocket::HTTPWebSocket(struct event_base* base, int timeout, int queueDepth, int queuePostDepth, bool publicAccess, int loops)
+    : HTTPSocket(base, timeout, queueDepth, publicAccess, loops)
 {
-    m_workPostQueue = std::make_shared<QueueLimited<std::unique_ptr<HTTPClosure>>>(queuePostDepth);
+    // Public requests are scheduled by cost of method and fairly between clients
+    m_workQueue = std::make_shared<HTTPWorkQueue>(queueDepth, (int64_t) timeout * 1000);
+    m_workPostQueue = std::make_shared<HTTPWorkQueue>(queuePostDepth, (int64_t) timeout * 1000);
+
+    m_batchParallel = std::max((int) gArgs.GetArg("-rpcbatchparallel", DEFAULT_HTTP_BATCH_PARALLEL), 1);
+    if (m_batchParallel > 1)
+        m_workBatchQueue = std::make_shared<QueueLimited<std::unique_ptr<HTTPClosure>>>(queueDepth);
     LogPrintf("HTTP: creating work post queue of depth %d\n", queuePostDepth);
 }
 
 HTTPWebSocket::~HTTPWebSocket() = default;
 
-void HTTPWebSocket::StartHTTPSocket(int threadCount, int threadPostCount, bool selfDbConnection)
+void HTTPWebSocket::StartHTTPSocket(int threadCount, int threadPostCount, int threadBatchCount, bool selfDbConnection)
 {
+    StartEventLoops();
     StartThreads("HTTPWebSocket::StartHTTPSocket (GET)", m_workQueue, threadCount, selfDbConnection);
     StartThreads("HTTPWebSocket::StartHTTPSocket (POST)", m_workPostQueue, threadPostCount, selfDbConnection);
+    if (m_workBatchQueue)
+        StartThreads("HTTPWebSocket::StartHTTPSocket (BATCH)", m_workBatchQueue, threadBatchCount, selfDbConnection);
 }
 
 void HTTPWebSocket::StopHTTPSocket()
@@ -822,6 +965,7 @@ void HTTPWebSocket::StopHTTPSocket()
     // is UB after this call.
     m_workQueue.reset();
     m_workPostQueue.reset();
+    m_workBatchQueue.reset();
 }
 
 void HTTPWebSocket::InterruptHTTPSocket()
@@ -829,6 +973,22 @@ void HTTPWebSocket::InterruptHTTPSocket()
     HTTPSocket::InterruptHTTPSocket();
 }
 
+std::string HTTPWorkItem::Peer() const
+{
+    return req->GetPeer().ToStringIP();
+}
+
+std::string HTTPWorkItem::Method() const
+{
+    auto body = req->PeekBody();
+    return RPCMethodCosts::ParseMethod(body.first, body.second);
+}
+
+void HTTPWorkItem::Reject(int nStatus, const std::string& strReply)
+{
+    req->WriteReply(nStatus, strReply);
+}
+
 HTTPEvent::HTTPEvent(struct event_base *base, bool _deleteWhenTriggered, std::function<void()> _handler) :
     deleteWhenTriggered(_deleteWhenTriggered), handler(std::move(_handler))
 {
@@ -876,6 +1036,18 @@ std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string &hdr) cons
         return std::make_pair(false, "");
 }
 
+std::pair<const char*, size_t> HTTPRequest::PeekBody()
+{
+    struct evbuffer *buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return {nullptr, 0};
+    size_t size = evbuffer_get_length(buf);
+    const char *data = (const char *) evbuffer_pullup(buf, size);
+    if (!data)
+        return {nullptr, 0};
+    return {data, size};
+}
+
 std::string HTTPRequest::ReadBody()
 {
     struct evbuffer *buf = evhttp_request_get_input_buffer(req);
@@ -912,12 +1084,14 @@ void HTTPRequest::WriteReply(int nStatus, const std::string &strReply)
 {
     assert(!replySent && req);
 
-    // Send event to main http thread to send reply message
+    // Send event to the http thread of the loop that accepted the connection to send reply message
     struct evbuffer *evb = evhttp_request_get_output_buffer(req);
     assert(evb);
     evbuffer_add(evb, strReply.data(), strReply.size());
+    evhttp_connection *reqConn = evhttp_request_get_connection(req);
+    struct event_base *base = reqConn ? evhttp_connection_get_base(reqConn) : eventBase;
     auto req_copy = req;
-    auto *ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]
+    auto *ev = new HTTPEvent(base, true, [req_copy, nStatus]
     {
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
         // Re-enable reading from the socket. This is the second part of the libevent
@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <functional>
 #include <future>
+#include <thread>
 #include <rpc/protocol.h> // For HTTP status codes
 #include <event2/thread.h>
 #include <event2/buffer.h>
@@ -32,6 +33,9 @@ static const int DEFAULT_HTTP_PUBLIC_WORKQUEUE = 16;
 static const int DEFAULT_HTTP_STATIC_WORKQUEUE = 16;
 static const int DEFAULT_HTTP_REST_WORKQUEUE = 16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT = 30;
+static const int DEFAULT_HTTP_PUBLIC_LOOPS = 1;
+static const int DEFAULT_HTTP_BATCH_THREADS = 4;
+static const int DEFAULT_HTTP_BATCH_PARALLEL = 4;
 
 static const bool DEFAULT_API_ENABLE = true;
 static const bool DEFAULT_REST_ENABLE = false;
@@ -127,6 +131,12 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Read request body without consuming it.
+     * The returned pointer is valid until the body is read.
+     */
+    std::pair<const char*, size_t> PeekBody();
+
     /**
      * Write output header.
      *
@@ -156,6 +166,12 @@ class HTTPClosure
 public:
     virtual void operator()(DbConnectionRef& sqliteConnection) = 0;
     virtual ~HTTPClosure() {}
+
+    /** Client address and RPC method used by scheduling work queues */
+    virtual std::string Peer() const { return ""; }
+    virtual std::string Method() const { return ""; }
+    /** Reply without executing when the request is dropped from a work queue */
+    virtual void Reject(int nStatus, const std::string& strReply) {}
 };
 
 /** Event class. This can be used either as a cross-thread trigger or as a timer.
@@ -218,6 +234,23 @@ private:
     struct event_base* base;
 };
 
+/** Task executed on worker thread with its database connection */
+class HTTPTaskItem final : public HTTPClosure
+{
+public:
+    explicit HTTPTaskItem(std::function<void(const DbConnectionRef&)> _func) : func(std::move(_func))
+    {
+    }
+
+    void operator()(DbConnectionRef& dbConnection) override
+    {
+        func(dbConnection);
+    }
+
+private:
+    std::function<void(const DbConnectionRef&)> func;
+};
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
@@ -229,6 +262,10 @@ public:
         // created = gStatEngineInstance.GetCurrentSystemTime();
     }
 
+    std::string Peer() const override;
+    std::string Method() const override;
+    void Reject(int nStatus, const std::string& strReply) override;
+
     void operator()(DbConnectionRef& dbConnection) override
     {
         auto jreq = req.get();
@@ -271,16 +308,32 @@ private:
 class HTTPSocket
 {
 private:
-    struct evhttp* m_http;
-    struct evhttp* m_eventHTTP;
-    std::vector<evhttp_bound_socket*> m_boundSockets;
+    /** Accepting event loop of the socket. Requests are read and replies are sent
+      * on the loop that accepted the connection. */
+    struct EventLoop
+    {
+        struct event_base* base = nullptr;
+        struct evhttp* http = nullptr;
+        /** Base is created by this socket and dispatched by its own thread */
+        bool ownBase = false;
+        std::vector<evhttp_bound_socket*> boundSockets;
+        std::thread thread;
+        std::future<bool> result;
+    };
+
+    std::vector<EventLoop> m_loops;
     std::vector<std::shared_ptr<QueueEventLoopThread<std::unique_ptr<HTTPClosure>>>> m_thread_http_workers;
 
+    bool AddEventLoop(struct event_base* base, int timeout);
+
 protected:
     void StartThreads(const std::string name, std::shared_ptr<Queue<std::unique_ptr<HTTPClosure>>> queue, int threadCount, bool selfDbConnection);
+    void StartEventLoops();
 
 public:
-    HTTPSocket(struct event_base* base, int timeout, int queueDepth, bool publicAccess);
+    /** Socket served by the shared event base, or by its own loops if base is null.
+      * More than one own loop listen on the same addresses with SO_REUSEPORT. */
+    HTTPSocket(struct event_base* base, int timeout, int queueDepth, bool publicAccess, int loops = 1);
     ~HTTPSocket();
 
     /** Sets the need to check the request source. For public APIs,
@@ -292,10 +345,16 @@ public:
     std::shared_ptr<Queue<std::unique_ptr<HTTPClosure>>> m_workQueue;
     std::vector<HTTPPathHandler> m_pathHandlers;
 
+    /** Elements of batch requests are executed concurrently by these threads if queue exists */
+    std::shared_ptr<Queue<std::unique_ptr<HTTPClosure>>> m_workBatchQueue;
+    int m_batchParallel = 1;
+
     /** Start worker threads to listen on bound http sockets */
     void StartHTTPSocket(int threadCount, bool selfDbConnection);
     /** Stop worker threads on all bound http sockets */
     void StopHTTPSocket();
+    /** Stop own event loops, call after worker threads are stopped */
+    void StopEventLoops();
 
     /** Acquire a http socket handle for a provided IP address and port number */
     void BindAddress(std::string ipAddr, int port);
@@ -322,9 +381,9 @@ public:
     CRPCTable m_table_post_rpc;
     std::shared_ptr<Queue<std::unique_ptr<HTTPClosure>>> m_workPostQueue;
 
-    HTTPWebSocket(struct event_base* base, int timeout, int queueDepth, int queuePostDepth, bool publicAccess);
+    HTTPWebSocket(struct event_base* base, int timeout, int queueDepth, int queuePostDepth, bool publicAccess, int loops = 1);
     ~HTTPWebSocket();
-    void StartHTTPSocket(int threadCount, int threadPostCount, bool selfDbConnection);
+    void StartHTTPSocket(int threadCount, int threadPostCount, int threadBatchCount, bool selfDbConnection);
     void StopHTTPSocket();
     void InterruptHTTPSocket();
 };
@@ -0,0 +1,344 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <httpworkqueue.h>
+
+#include <logging.h>
+#include <utiltime.h>
+
+#include <cstring>
+
+RPCMethodCosts g_rpcMethodCosts;
+
+/** Latency is not learned for more methods - protects from random method names of clients */
+static const size_t RPC_COST_MAX_METHODS = 1024;
+
+/** Lane order of weighted round robin: cheap 4, normal 2, heavy 1 */
+static const RPCCostClass RPC_COST_SCHEDULE[] = {
+    RPCCostClass::Cheap, RPCCostClass::Normal, RPCCostClass::Cheap, RPCCostClass::Heavy,
+    RPCCostClass::Cheap, RPCCostClass::Normal, RPCCostClass::Cheap,
+};
+
+static const size_t RPC_COST_SCHEDULE_SIZE = sizeof(RPC_COST_SCHEDULE) / sizeof(RPC_COST_SCHEDULE[0]);
+
+bool RPCMethodCosts::Configure(const std::vector<std::string>& entries)
+{
+    LOCK(m_mutex);
+
+    for (const auto& entry : entries)
+    {
+        auto pos = entry.rfind(':');
+        if (pos == std::string::npos || pos == 0)
+            return false;
+
+        std::string name = entry.substr(pos + 1);
+        if (name == "cheap")
+            m_configured[entry.substr(0, pos)] = RPCCostClass::Cheap;
+        else if (name == "normal")
+            m_configured[entry.substr(0, pos)] = RPCCostClass::Normal;
+        else if (name == "heavy")
+            m_configured[entry.substr(0, pos)] = RPCCostClass::Heavy;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+RPCCostClass RPCMethodCosts::Class(const std::string& method)
+{
+    LOCK(m_mutex);
+
+    if (auto it = m_configured.find(method); it != m_configured.end())
+        return it->second;
+
+    auto it = m_latency.find(method);
+    if (it == m_latency.end())
+        return RPCCostClass::Normal;
+
+    if (it->second < RPC_COST_CHEAP_MS)
+        return RPCCostClass::Cheap;
+    if (it->second > RPC_COST_HEAVY_MS)
+        return RPCCostClass::Heavy;
+
+    return RPCCostClass::Normal;
+}
+
+int64_t RPCMethodCosts::Expected(const std::string& method)
+{
+    LOCK(m_mutex);
+
+    auto it = m_latency.find(method);
+    return it == m_latency.end() ? 0 : (int64_t) it->second;
+}
+
+void RPCMethodCosts::Observe(const std::string& method, int64_t ms)
+{
+    LOCK(m_mutex);
+
+    auto it = m_latency.find(method);
+    if (it == m_latency.end())
+    {
+        if (m_latency.size() < RPC_COST_MAX_METHODS)
+            m_latency.emplace(method, (double) ms);
+        return;
+    }
+
+    // Moving average follows changes of load without jumping on single slow call
+    it->second += ((double) ms - it->second) * 0.1;
+}
+
+void RPCMethodCosts::Shed(const std::string& method)
+{
+    LOCK(m_mutex);
+
+    // Shed requests are never measured - without decay one slow call would reject the method forever
+    auto it = m_latency.find(method);
+    if (it != m_latency.end())
+        it->second *= RPC_COST_SHED_DECAY;
+}
+
+/** Skip JSON string starting at pos, returns position after closing quote or end */
+static const char* SkipString(const char* pos, const char* end)
+{
+    for (pos++; pos < end; pos++)
+    {
+        if (*pos == '\\')
+            pos++;
+        else if (*pos == '"')
+            return pos + 1;
+    }
+
+    return end;
+}
+
+std::string RPCMethodCosts::ParseMethod(const char* body, size_t size)
+{
+    if (!body)
+        return "";
+
+    const char* end = body + size;
+    const char* pos = body;
+    while (pos < end && isspace((unsigned char) *pos))
+        pos++;
+
+    if (pos < end && *pos == '[')
+        return "batch";
+
+    if (pos >= end || *pos != '{')
+        return "";
+
+    // Only key of the request object counts - "method" inside params is not the called method
+    int depth = 0;
+    while (pos < end)
+    {
+        if (*pos == '{' || *pos == '[')
+        {
+            depth++;
+            pos++;
+            continue;
+        }
+
+        if (*pos == '}' || *pos == ']')
+        {
+            if (--depth <= 0)
+                return "";
+            pos++;
+            continue;
+        }
+
+        if (*pos != '"')
+        {
+            pos++;
+            continue;
+        }
+
+        const char* start = pos + 1;
+        pos = SkipString(pos, end);
+        if (depth != 1 || pos - start != 7 || memcmp(start, "method\"", 7) != 0)
+            continue;
+
+        const char* value = pos;
+        while (value < end && isspace((unsigned char) *value))
+            value++;
+
+        // String value is not a key
+        if (value >= end || *value != ':')
+            continue;
+
+        for (value++; value < end && isspace((unsigned char) *value); value++) {}
+
+        if (value >= end || *value != '"')
+            return "";
+
+        start = ++value;
+        while (value < end && *value != '"' && *value != '\\' && value - start < 64)
+            value++;
+
+        if (value >= end || *value != '"')
+            return "";
+
+        return std::string(start, value - start);
+    }
+
+    return "";
+}
+
+/** Work item measuring execution time of its method */
+class HTTPMeasuredClosure final : public HTTPClosure
+{
+public:
+    HTTPMeasuredClosure(std::unique_ptr<HTTPClosure> item, std::string method, RPCMethodCosts& costs) :
+        m_item(std::move(item)), m_method(std::move(method)), m_costs(costs)
+    {
+    }
+
+    void operator()(DbConnectionRef& dbConnection) override
+    {
+        int64_t start = GetTimeMillis();
+        (*m_item)(dbConnection);
+        m_costs.Observe(m_method, GetTimeMillis() - start);
+    }
+
+    std::string Peer() const override { return m_item->Peer(); }
+    std::string Method() const override { return m_method; }
+    void Reject(int nStatus, const std::string& strReply) override { m_item->Reject(nStatus, strReply); }
+
+private:
+    std::unique_ptr<HTTPClosure> m_item;
+    std::string m_method;
+    RPCMethodCosts& m_costs;
+};
+
+HTTPWorkQueue::HTTPWorkQueue(size_t maxDepth, int64_t timeoutMs, RPCMethodCosts& costs) :
+    m_maxDepth(maxDepth), m_timeoutMs(timeoutMs), m_costs(costs)
+{
+}
+
+bool HTTPWorkQueue::Add(Item entry)
+{
+    std::string method = entry->Method();
+    std::string peer = entry->Peer();
+    auto& lane = m_lanes[(int) m_costs.Class(method)];
+
+    LOCK(m_mutex);
+
+    if (lane.size >= m_maxDepth)
+        return false;
+
+    auto& queue = lane.peers[peer];
+    if (queue.empty())
+        lane.order.push_back(peer);
+
+    queue.push_back(Entry{ std::move(entry), std::move(method), GetTimeMillis() });
+    lane.size += 1;
+
+    m_cv.notify_one();
+    return true;
+}
+
+bool HTTPWorkQueue::Pop(Entry& out)
+{
+    for (size_t i = 0; i < RPC_COST_SCHEDULE_SIZE; i++)
+    {
+        auto& lane = m_lanes[(int) RPC_COST_SCHEDULE[(m_turn + i) % RPC_COST_SCHEDULE_SIZE]];
+        if (lane.size == 0)
+            continue;
+
+        m_turn = (m_turn + i + 1) % RPC_COST_SCHEDULE_SIZE;
+
+        // Next peer in turn - it goes to the end of line if has more requests
+        std::string peer = std::move(lane.order.front());
+        lane.order.pop_front();
+
+        auto it = lane.peers.find(peer);
+        out = std::move(it->second.front());
+        it->second.pop_front();
+
+        if (it->second.empty())
+            lane.peers.erase(it);
+        else
+            lane.order.push_back(std::move(peer));
+
+        lane.size -= 1;
+        return true;
+    }
+
+    return false;
+}
+
+bool HTTPWorkQueue::GetNext(Item& out, const condCheck& pre, const condCheck& post)
+{
+    Entry entry;
+    bool found = false;
+    std::vector<Entry> shed;
+
+    {
+        WAIT_LOCK(m_mutex, lock);
+
+        if (pre && !pre())
+            return false;
+
+        if (Count() == 0)
+            m_cv.wait(lock);
+
+        if (post && !post())
+            return false;
+
+        // Drop requests that would exceed their timeout - client gives up on them anyway
+        int64_t now = GetTimeMillis();
+        while (Pop(entry))
+        {
+            if (m_timeoutMs > 0 && now - entry.enqueued + m_costs.Expected(entry.method) > m_timeoutMs)
+            {
+                m_costs.Shed(entry.method);
+                shed.push_back(std::move(entry));
+                continue;
+            }
+
+            found = true;
+            break;
+        }
+
+        m_shed += (int64_t) shed.size();
+    }
+
+    for (auto& dropped : shed)
+    {
+        LogPrint(BCLog::RPCERROR, "WARNING: request %s rejected because it would exceed timeout in http work queue.\n", dropped.method);
+        dropped.item->Reject(HTTP_SERVICE_UNAVAILABLE, "Request timeout exceeded in work queue");
+    }
+
+    if (!found)
+        return false;
+
+    out = std::make_unique<HTTPMeasuredClosure>(std::move(entry.item), std::move(entry.method), m_costs);
+    return true;
+}
+
+void HTTPWorkQueue::Interrupt()
+{
+    LOCK(m_mutex);
+    m_cv.notify_all();
+}
+
+size_t HTTPWorkQueue::Size()
+{
+    LOCK(m_mutex);
+    return Count();
+}
+
+int64_t HTTPWorkQueue::Shed()
+{
+    LOCK(m_mutex);
+    return m_shed;
+}
+
+size_t HTTPWorkQueue::Count() const
+{
+    size_t size = 0;
+    for (const auto& lane : m_lanes)
+        size += lane.size;
+    return size;
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETCOIN_HTTPWORKQUEUE_H
+#define POCKETCOIN_HTTPWORKQUEUE_H
+
+#include <httpserver.h>
+#include <sync.h>
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** Execution cost class of RPC method - every class has own lane in work queues */
+enum class RPCCostClass
+{
+    Cheap = 0,
+    Normal = 1,
+    Heavy = 2,
+};
+
+static const int RPC_COST_CLASS_COUNT = 3;
+
+/** Methods faster than this are cheap and slower than heavy limit are heavy */
+static const int64_t RPC_COST_CHEAP_MS = 20;
+static const int64_t RPC_COST_HEAVY_MS = 250;
+/** Expected latency of method is lowered by this factor on every shed request */
+static const double RPC_COST_SHED_DECAY = 0.8;
+
+/**
+ * Execution cost of RPC methods.
+ * Cost class is configured with -rpcmethodcost=<method>:<cheap|normal|heavy> or
+ * learned from average observed latency. Unknown methods are normal.
+ */
+class RPCMethodCosts
+{
+public:
+    /** Set classes from "<method>:<class>" entries, returns false for invalid entry */
+    bool Configure(const std::vector<std::string>& entries);
+
+    RPCCostClass Class(const std::string& method);
+    /** Average observed execution time in ms, 0 if never executed */
+    int64_t Expected(const std::string& method);
+    void Observe(const std::string& method, int64_t ms);
+    /** Request of method was rejected without execution - decay its expected latency */
+    void Shed(const std::string& method);
+
+    /** Method name of JSON-RPC request body without parsing whole request.
+     * Only the "method" key of the top-level object is taken.
+     * Batch requests are accounted as one "batch" method. */
+    static std::string ParseMethod(const char* body, size_t size);
+
+private:
+    Mutex m_mutex;
+    std::unordered_map<std::string, double> m_latency;
+    std::unordered_map<std::string, RPCCostClass> m_configured;
+};
+
+extern RPCMethodCosts g_rpcMethodCosts;
+
+/**
+ * Work queue of public RPC requests with separate lanes for cost classes.
+ * Lanes are served by weighted round robin (cheap 4 : normal 2 : heavy 1) so
+ * cheap calls do not wait behind heavy ones. Inside lane requests of different
+ * peers are taken in turns. Requests that can not complete within timeout
+ * anymore are rejected before execution. Every rejection lowers expected latency
+ * of the method, so a method is tried again after its estimate went stale.
+ */
+class HTTPWorkQueue : public Queue<std::unique_ptr<HTTPClosure>>
+{
+public:
+    using Item = std::unique_ptr<HTTPClosure>;
+
+    /** Every lane holds up to maxDepth requests */
+    HTTPWorkQueue(size_t maxDepth, int64_t timeoutMs, RPCMethodCosts& costs = g_rpcMethodCosts);
+
+    bool GetNext(Item& out, const condCheck& pre, const condCheck& post) override;
+    bool Add(Item entry) override;
+    void Interrupt() override;
+    size_t Size() override;
+
+    /** Number of requests dropped after waiting too long */
+    int64_t Shed();
+
+private:
+    struct Entry
+    {
+        Item item;
+        std::string method;
+        int64_t enqueued = 0;
+    };
+
+    struct Lane
+    {
+        std::map<std::string, std::deque<Entry>> peers;
+        // Peers with queued requests in order of service
+        std::deque<std::string> order;
+        size_t size = 0;
+    };
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::array<Lane, RPC_COST_CLASS_COUNT> m_lanes;
+    size_t m_maxDepth;
+    int64_t m_timeoutMs;
+    RPCMethodCosts& m_costs;
+    size_t m_turn = 0;
+    int64_t m_shed = 0;
+
+    size_t Count() const;
+    bool Pop(Entry& out) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+#endif // POCKETCOIN_HTTPWORKQUEUE_H
@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <index/txindex.h>
+#include <blockreader.h>
 #include <shutdown.h>
 #include <ui_interface.h>
 #include <util.h>
@@ -261,6 +262,11 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
         return false;
     }
 
+    // Recently read block or only the transaction from mapped block file
+    if (g_block_reader.ReadTransaction(postx, postx.nTxOffset, tx_hash, block_hash, tx)) {
+        return true;
+    }
+
     CAutoFile file(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
     if (file.IsNull()) {
         return error("%s: OpenBlockFile failed", __func__);
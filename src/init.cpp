@@ -11,6 +11,7 @@
 
 #include <init.h>
 #include <amount.h>
+#include <blockreader.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -58,6 +59,8 @@
 #include "pocketdb/SQLiteDatabase.h"
 #include "pocketdb/pocketnet.h"
 #include "pocketdb/services/ChainPostProcessing.h"
+#include "pocketdb/services/PocketCheckQueue.h"
+#include "pocketdb/services/Snapshot.h"
 #include "pocketdb/migrations/base.h"
 #include "pocketdb/migrations/main.h"
 #include "pocketdb/migrations/web.h"
@@ -89,6 +92,7 @@ std::unique_ptr<PeerLogicValidation> peerLogic;
 Statistic::RequestStatEngine gStatEngineInstance;
 
 std::shared_ptr<ProtectedMap<std::string, WSUser>> WSConnections;
+std::shared_ptr<WSAddressIndex> WSAddresses;
 std::shared_ptr<QueueEventLoopThread<std::pair<CBlock, CBlockIndex*>>> notifyClientsThread;
 std::shared_ptr<Queue<std::pair<CBlock, CBlockIndex*>>> notifyClientsQueue;
 
@@ -166,6 +170,9 @@ static CScheduler scheduler;
 
 void ShutdownPocketServices()
 {
+    // Commit pending mempool changes before close
+    PocketDb::SQLiteDbInst.CommitGroup();
+
     PocketDb::SQLiteDbInst.m_connection_mutex.lock();
 
     PocketDb::TransRepoInst.Destroy();
@@ -203,6 +210,8 @@ void Shutdown()
         return;
 
     PocketServices::WebPostProcessorInst.Stop();
+    PocketServices::WalCheckpointerInst.Stop();
+    PocketServices::MempoolWriterInst.Stop();
     gStatEngineInstance.Stop();
 
     if (notifyClientsThread)
@@ -401,12 +410,18 @@ void SetupServerArgs()
         testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksdir=<dir>", "Specify blocks directory (default: <datadir>/blocks)", false,
         OptionsCategory::OPTIONS);
+#ifndef WIN32
+    gArgs.AddArg("-blockmmap", strprintf("Read stored blocks and transactions from memory mapped block files (default: %u)",
+        DEFAULT_BLOCK_MMAP), true, OptionsCategory::OPTIONS);
+#endif
     gArgs.AddArg("-blocknotify=<cmd>",
         "Execute command when the best block changes (%s in cmd is replaced by block hash)", false,
         OptionsCategory::OPTIONS);
     gArgs.AddArg("-blockreconstructionextratxn=<n>",
         strprintf("Extra transactions to keep in memory for compact block reconstructions (default: %u)",
             DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockreadcache=<n>", strprintf("Keep <n> recently read blocks in memory, 0 to disable (default: %u)",
+        DEFAULT_BLOCK_READ_CACHE), true, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksonly", strprintf("Whether to operate in a blocks only mode (default: %u)", DEFAULT_BLOCKSONLY),
         true, OptionsCategory::OPTIONS);
     gArgs.AddArg("-conf=<file>",
@@ -622,13 +637,18 @@ void SetupServerArgs()
     gArgs.AddArg("-rpcstaticthreads=<n>", strprintf("Set the number of threads to service RPC (STATIC) calls (default: %d)", DEFAULT_HTTP_STATIC_THREADS), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpostthreads=<n>", strprintf("Set the number of threads to service RPC (POST) calls (default: %d)", DEFAULT_HTTP_POST_THREADS), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcrestthreads=<n>", strprintf("Set the number of threads to service RPC (REST) calls (default: %d)", DEFAULT_HTTP_REST_THREADS), false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcbatchthreads=<n>", strprintf("Set the number of threads to execute elements of RPC (PUBLIC) batch requests concurrently (default: %d)", DEFAULT_HTTP_BATCH_THREADS), false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcbatchparallel=<n>", strprintf("Set the maximum number of concurrently executed elements of one RPC (PUBLIC) batch request, 1 executes them one by one (default: %d)", DEFAULT_HTTP_BATCH_PARALLEL), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcuser=<user>", "Username for JSON-RPC connections", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpublicworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC (PUBLIC) calls (default: %d)", DEFAULT_HTTP_PUBLIC_WORKQUEUE), false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcpublicloops=<n>", strprintf("Set the number of event loops accepting RPC (PUBLIC) connections, more than one shares the port with SO_REUSEPORT (default: %d)", DEFAULT_HTTP_PUBLIC_LOOPS), false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcmethodcost=<method>:<class>", "Set cost class (cheap, normal, heavy) of public RPC method instead of learning it from observed latency. Every class has own lane in public work queues. This option can be specified multiple times", false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcstaticworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC (STATIC) calls (default: %d)", DEFAULT_HTTP_STATIC_WORKQUEUE), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcpostworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC (POST) calls (default: %d)", DEFAULT_HTTP_POST_WORKQUEUE), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpcrestworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC (REST) calls (default: %d)", DEFAULT_HTTP_REST_WORKQUEUE), false, OptionsCategory::RPC);
     gArgs.AddArg("-rpccachesize=<n>", strprintf("Maximum amount of memory in megabytes allowed for RPCcache usage (default: %d MB)", 64), false, OptionsCategory::RPC);
+    gArgs.AddArg("-rpcprofilecachesize=<n>", strprintf("Maximum number of short account profiles cached for web RPC (default: %d)", 20000), false, OptionsCategory::RPC);
 
     gArgs.AddArg("-statdepth=<n>", strprintf("Set the depth of the work queue for statistic in seconds (default: %ds)", 60), false, OptionsCategory::RPC);
     gArgs.AddArg("-server", "Accept command line and JSON-RPC commands", false, OptionsCategory::RPC);
@@ -638,6 +658,18 @@ void SetupServerArgs()
     gArgs.AddArg("-sqlsharedcache", strprintf("Experimental: enable shared cache for sqlite connections (default: disabled)"), false, OptionsCategory::SQLITE);
     gArgs.AddArg("-sqlcachesize", strprintf("Experimental: Cache size for SQLite connection in megabytes (default: %d mb)", 5), false, OptionsCategory::SQLITE);
     gArgs.AddArg("-withoutweb", strprintf("Disable WEB part of database (default: %u)", false), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlwalcheckpoint", strprintf("Run WAL checkpoints in background thread between blocks instead of SQLite auto-checkpoint (default: %u)", true), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-loadpocketdbsnapshot=<dir>", "Restore Pocket DB from snapshot exported by exportpocketdbsnapshot if the node has no Pocket DB yet. Snapshot must be known to chainparams or match -pocketdbsnapshothash", false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-pocketdbsnapshothash=<hash>", "Trust Pocket DB snapshot with this hash instead of snapshots known to chainparams", false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlwalsizelimit=<n>", strprintf("WAL files size in megabytes that forces TRUNCATE checkpoint (default: %d mb)", 256), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlwalreaderpause=<n>", strprintf("Maximum pause for new read transactions while TRUNCATE checkpoint waits for long readers (default: %dms)", 250), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-searchranked", strprintf("Use full-text search index with relevance ranking for content search (default: %u)", 0), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-searchrankwindow=<n>", strprintf("Number of the most recent matches scored by ranked search (default: %u)", 5000), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlprofile", strprintf("Collect per-method SQL execution statistics, see getsqlstats (default: %u)", true), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlundodepth=<n>", strprintf("Number of last blocks with undo records for fast pocket database rollback (default: %d)", 1440), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlmempoolbatchms=<n>", strprintf("Commit mempool pocket transactions in groups collected during this time, 0 - commit every transaction (default: %dms)", 50), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlmempoolbatchsize=<n>", strprintf("Maximum number of mempool changes in one group commit (default: %d)", 500), false, OptionsCategory::SQLITE);
+    gArgs.AddArg("-sqlwalidletimeout=<n>", strprintf("Run PASSIVE WAL checkpoint if no blocks connected during this time (default: %ds)", 10), false, OptionsCategory::SQLITE);
     
 #if HAVE_DECL_DAEMON
     gArgs.AddArg("-daemon", "Run in the background as a daemon and accept commands", false, OptionsCategory::OPTIONS);
@@ -1584,12 +1616,14 @@ static void StartWS()
                     {
                         WSUser wsUser = {connection, _addr, block, ip, service, mainPort, wssPort};
                         WSConnections->insert_or_assign(connection->ID(), wsUser);
+                        WSAddresses->Add(connection->ID(), _addr);
                     }
                     else if (std::find(keys.begin(), keys.end(), "msg") != keys.end())
                     {
                         if (val["msg"].get_str() == "unsubscribe")
                         {
                             WSConnections->erase(connection->ID());
+                            WSAddresses->Remove(connection->ID());
                         }
                     }
                 }
@@ -1615,11 +1649,13 @@ static void StartWS()
     ws.on_close = [](std::shared_ptr<WsServer::Connection> connection, int status, const std::string& /*reason*/)
     {
         WSConnections->erase(connection->ID());
+        WSAddresses->Remove(connection->ID());
     };
 
     ws.on_error = [](std::shared_ptr<WsServer::Connection> connection, const SimpleWeb::error_code& ec)
     {
         WSConnections->erase(connection->ID());
+        WSAddresses->Remove(connection->ID());
     };
 
     server.start();
@@ -1628,7 +1664,8 @@ static void StartWS()
 static void InitWS()
 {
     WSConnections = std::make_shared<ProtectedMap<std::string, WSUser>>();
-    auto notifyProcessor = std::make_shared<NotifyBlockProcessor>(WSConnections);
+    WSAddresses = std::make_shared<WSAddressIndex>();
+    auto notifyProcessor = std::make_shared<NotifyBlockProcessor>(WSConnections, WSAddresses);
     notifyClientsQueue = std::make_shared<Queue<std::pair<CBlock, CBlockIndex*>>>();
     notifyClientsThread = std::make_shared<QueueEventLoopThread<std::pair<CBlock, CBlockIndex*>>>(notifyClientsQueue, notifyProcessor);
     notifyClientsThread->Start("notifyClientsThread");
@@ -1700,7 +1737,10 @@ bool AppInitMain()
     if (nScriptCheckThreads)
     {
         for (int i = 0; i < nScriptCheckThreads - 1; i++)
+        {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&PocketServices::ThreadPocketCheck);
+        }
     }
 
     // Start the lightweight task scheduler thread
@@ -1709,6 +1749,14 @@ bool AppInitMain()
 
     // ********************************************************* Step 4b: Start PocketDB
     uiInterface.InitMessage(_("Loading Pocket DB..."));
+    if (gArgs.IsArgSet("-loadpocketdbsnapshot") && gArgs.GetArg("-reindex", 0) == 0)
+    {
+        std::string snapshotError;
+        fs::path snapshotDir = fs::absolute(gArgs.GetArg("-loadpocketdbsnapshot", ""));
+        if (!PocketServices::Snapshot::Import(snapshotDir, GetDataDir() / "pocketdb", snapshotError))
+            return InitError(snapshotError);
+    }
+
     PocketDb::InitSQLite(GetDataDir() / "pocketdb");
     PocketWeb::PocketFrontendInst.Init();
 
@@ -1716,6 +1764,13 @@ bool AppInitMain()
     if (!gArgs.GetBoolArg("-withoutweb", false))
         PocketServices::WebPostProcessorInst.Start(threadGroup);
 
+    // Start WAL checkpoints thread
+    if (gArgs.GetBoolArg("-sqlwalcheckpoint", true))
+        PocketServices::WalCheckpointerInst.Start(threadGroup);
+
+    // Start group commit thread for mempool pocket transactions
+    PocketServices::MempoolWriterInst.Start(threadGroup);
+
     if (ShutdownRequested())
     {
         LogPrintf("Shutdown requested. Exiting.\n");
@@ -1021,6 +1021,7 @@ static std::shared_ptr<const CBlock> most_recent_block GUARDED_BY(cs_most_recent
 static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_block GUARDED_BY(cs_most_recent_block);
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
 static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
+static std::string most_recent_compact_pocket_data GUARDED_BY(cs_most_recent_block);
 
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
@@ -1053,16 +1054,24 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex* pindex, const std:
         return;
     }
 
+    std::string pocketCompactData;
+    if (!GetCompactPocketData(*pblock, pocketBlock, mempool, pocketCompactData))
+    {
+        LogPrintf("Error: Failed get block payload from sqlite db %s\n", pblock->GetHash().GetHex());
+        return;
+    }
+
     {
         LOCK(cs_most_recent_block);
         most_recent_block_hash = hashBlock;
         most_recent_block = pblock;
         most_recent_compact_block = pcmpctblock;
+        most_recent_compact_pocket_data = pocketCompactData;
         fWitnessesPresentInMostRecentCompactBlock = fWitnessEnabled;
     }
 
     connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock,
-                          pocketBlockData](CNode* pnode)
+                          &pocketBlockData, &pocketCompactData](CNode* pnode)
     {
         AssertLockHeld(cs_main);
 
@@ -1077,7 +1086,8 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex* pindex, const std:
         if (state.fPreferHeaderAndIDs && (!fWitnessEnabled || state.fWantsCmpctWitness) &&
             !PeerHasHeader(&state, pindex) && PeerHasHeader(&state, pindex->pprev))
         {
-            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock, pocketBlockData));
+            bool fCompactPocket = pnode->nVersion >= COMPACT_POCKET_VERSION;
+            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock, fCompactPocket ? pocketCompactData : pocketBlockData));
             state.pindexBestHeaderSent = pindex;
 
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerLogicValidation::NewPoWValidBlock",
@@ -1249,12 +1259,14 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
     bool send = false;
     std::shared_ptr<const CBlock> a_recent_block;
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> a_recent_compact_block;
+    std::string a_recent_compact_pocket_data;
     bool fWitnessesPresentInARecentCompactBlock;
     const Consensus::Params& consensusParams = chainparams.GetConsensus();
     {
         LOCK(cs_most_recent_block);
         a_recent_block = most_recent_block;
         a_recent_compact_block = most_recent_compact_block;
+        a_recent_compact_pocket_data = most_recent_compact_pocket_data;
         fWitnessesPresentInARecentCompactBlock = fWitnessesPresentInMostRecentCompactBlock;
     }
 
@@ -1391,7 +1403,8 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
                     int nSendFlags = fPeerWantsWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
                     if (CanDirectFetch(consensusParams) && pindex->nHeight >= chainActive.Height() - MAX_CMPCTBLOCK_DEPTH) {
                         if ((fPeerWantsWitness || !fWitnessesPresentInARecentCompactBlock) && a_recent_compact_block && a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
-                            connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block, pocketBlockData));
+                            bool fCompactPocket = pfrom->nVersion >= COMPACT_POCKET_VERSION;
+                            connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block, fCompactPocket ? a_recent_compact_pocket_data : pocketBlockData));
                         } else {
                             CBlockHeaderAndShortTxIDs cmpctblock(*pblock, fPeerWantsWitness);
                             connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock, pocketBlockData));
@@ -1510,8 +1523,14 @@ inline void static SendBlockTransactions(const CBlock& block, const BlockTransac
         resp.txn[i] = block.vtx[req.indexes[i]];
     }
 
+    // Peers with compact pocket relay have payloads of not requested transactions
+    CBlock requested;
+    bool fCompactPocket = pfrom->nVersion >= COMPACT_POCKET_VERSION;
+    if (fCompactPocket)
+        requested.vtx = resp.txn;
+
     std::string pocketBlockData;
-    if (!PocketServices::Accessor::GetBlock(block, pocketBlockData))
+    if (!PocketServices::Accessor::GetBlock(fCompactPocket ? requested : block, pocketBlockData))
     {
         LogPrintf("Error get block data for %s from sqlite db\n", block.GetHash().GetHex());
         return;
@@ -2569,6 +2588,9 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         vRecv >> cmpctblock;
         bool received_new_header = false;
 
+        // Pocket payloads sent with the block - the rest is taken from mempool pocket store
+        UniValue pocketData = PocketServices::Serializer::DeserializeData(vRecv);
+
         {
             LOCK(cs_main);
 
@@ -2627,6 +2649,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         // Keep a CBlock for "optimistic" compactblock reconstructions (see
         // below)
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        PocketBlockRef pocketBlockRef;
         bool fBlockReconstructed = false;
 
         {
@@ -2701,6 +2724,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                         return true;
                     }
 
+                    partialBlock.AddPocketData(pocketData);
+
                     BlockTransactionsRequest req;
                     for (size_t i = 0; i < cmpctblock.BlockTxCount(); i++) {
                         if (!partialBlock.IsTxAvailable(i))
@@ -2728,8 +2753,9 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                         // TODO: don't ignore failures
                         return true;
                     }
+                    tempBlock.AddPocketData(pocketData);
                     std::vector<CTransactionRef> dummy;
-                    status = tempBlock.FillBlock(*pblock, dummy);
+                    status = tempBlock.FillBlock(*pblock, dummy, pocketBlockRef);
                     if (status == READ_STATUS_OK) {
                         fBlockReconstructed = true;
                     }
@@ -2769,10 +2795,6 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 mapBlockSource.emplace(pblock->GetHash(), std::make_pair(pfrom->GetId(), false));
             }
 
-            // Deserialize pocket part if exists
-            auto[deserializeOk, pocketBlock] = PocketServices::Serializer::DeserializeBlock(*pblock, vRecv);
-            auto pocketBlockRef = std::make_shared<PocketBlock>(pocketBlock);
-
             // Setting fForceProcessing to true means that we bypass some of
             // our anti-DoS protections in AcceptBlock, which filters
             // unrequested blocks that might be trying to waste our resources
@@ -2808,8 +2830,12 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         BlockTransactions resp;
         vRecv >> resp;
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+        PocketBlockRef pocketBlockRef;
         bool fBlockRead = false;
 
+        // Payloads of requested transactions (or of all for peers without compact pocket relay)
+        UniValue pocketData = PocketServices::Serializer::DeserializeData(vRecv);
+
         {
             LOCK(cs_main);
 
@@ -2821,7 +2847,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             }
 
             PartiallyDownloadedBlock& partialBlock = *it->second.second->partialBlock;
-            ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn);
+            partialBlock.AddPocketData(pocketData);
+            ReadStatus status = partialBlock.FillBlock(*pblock, resp.txn, pocketBlockRef);
             if (status == READ_STATUS_INVALID) {
                 MarkBlockAsReceived(resp.blockhash); // Reset in-flight state in case of whitelist
                 Misbehaving(pfrom->GetId(), 100, strprintf("Peer %d sent us invalid compact block/non-matching block transactions\n", pfrom->GetId()));
@@ -2861,9 +2888,6 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         } // Don't hold cs_main when we call into ProcessNewBlock
 
         if (fBlockRead) {
-            auto[deserializeOk, pocketBlock] = PocketServices::Serializer::DeserializeBlock(*pblock, vRecv);
-            auto pocketBlockRef = std::make_shared<PocketBlock>(pocketBlock);
-
             bool fNewBlock = false;
             // Since we requested this block (it was in mapBlocksInFlight), force it to be processed,
             // even if it would not be a candidate for new tip (missing previous block, chain not long enough, etc)
@@ -3621,15 +3645,22 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
 
                     int nSendFlags = state.fWantsCmpctWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
 
+                    bool fCompactPocket = pto->nVersion >= COMPACT_POCKET_VERSION;
                     bool fGotBlockFromCache = false;
                     {
                         LOCK(cs_most_recent_block);
                         if (most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                            if (state.fWantsCmpctWitness || !fWitnessesPresentInMostRecentCompactBlock)
-                                connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *most_recent_compact_block));
-                            else {
+                            if (state.fWantsCmpctWitness || !fWitnessesPresentInMostRecentCompactBlock) {
+                                if (fCompactPocket)
+                                    connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *most_recent_compact_block, most_recent_compact_pocket_data));
+                                else
+                                    connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *most_recent_compact_block));
+                            } else {
                                 CBlockHeaderAndShortTxIDs cmpctblock(*most_recent_block, state.fWantsCmpctWitness);
-                                connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
+                                if (fCompactPocket)
+                                    connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock, most_recent_compact_pocket_data));
+                                else
+                                    connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
                             }
                             fGotBlockFromCache = true;
                         }
@@ -3639,7 +3670,12 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
                         bool ret = ReadBlockFromDisk(block, pBestIndex, consensusParams);
                         assert(ret);
                         CBlockHeaderAndShortTxIDs cmpctblock(block, state.fWantsCmpctWitness);
-                        connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
+
+                        std::string pocketBlockData;
+                        if (fCompactPocket && PocketServices::Accessor::GetBlock(block, pocketBlockData))
+                            connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock, pocketBlockData));
+                        else
+                            connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
                     }
                     state.pindexBestHeaderSent = pBestIndex;
                 } else if (state.fPreferHeaders) {
@@ -21,6 +21,21 @@ namespace PocketDb
         LogPrintf("%s: %d; Message: %s\n", __func__, code, msg);
     }
 
+    static int ProfileTraceCallback(unsigned int type, void* ctx, void* p, void* x)
+    {
+        // SQLITE_TRACE_PROFILE: P is statement, X is estimated execution time in nanoseconds
+        if (type == SQLITE_TRACE_PROFILE)
+        {
+            auto db = static_cast<SQLiteDatabase*>(ctx);
+            auto stmt = static_cast<sqlite3_stmt*>(p);
+            auto duration = *static_cast<sqlite3_int64*>(x) / 1000;
+
+            SQLiteProfilerInst.AddStatement(db->m_profile_func, stmt, duration);
+        }
+
+        return 0;
+    }
+
     static void InitializeSqlite()
     {
         LogPrintf("SQLite usage version: %d\n", (int)sqlite3_libversion_number());
@@ -202,6 +217,9 @@ namespace PocketDb
                         __func__, ret, sqlite3_errstr(ret)));
             }
 
+            if (gArgs.GetBoolArg("-sqlprofile", true))
+                sqlite3_trace_v2(m_db, SQLITE_TRACE_PROFILE, ProfileTraceCallback, this);
+
             if (!isReadOnlyConnect && sqlite3_db_readonly(m_db, dbName.c_str()) == 1)
                 throw std::runtime_error("Database opened in readonly");
 
@@ -210,6 +228,10 @@ namespace PocketDb
                 if (sqlite3_exec(m_db, "PRAGMA journal_mode = wal;", nullptr, nullptr, nullptr) != 0)
                     throw std::runtime_error("Failed apply journal_mode = wal");
 
+                // Checkpoints are executed by WalCheckpointer between blocks
+                if (gArgs.GetBoolArg("-sqlwalcheckpoint", true))
+                    sqlite3_wal_autocheckpoint(m_db, 0);
+
                 // if (sqlite3_exec(m_db, "PRAGMA temp_store = memory;", nullptr, nullptr, nullptr) != 0)
                 //     throw std::runtime_error("Failed apply temp_store = memory");
             }
@@ -313,25 +335,91 @@ namespace PocketDb
         m_db = nullptr;
     }
 
+    static thread_local bool g_group_scope = false;
+    static thread_local int64_t g_group_last = 0;
+
+    SQLiteGroupScope::SQLiteGroupScope() : m_prev(g_group_scope) { g_group_scope = true; }
+    SQLiteGroupScope::~SQLiteGroupScope() { g_group_scope = m_prev; }
+    int64_t SQLiteGroupScope::LastGroup() { return g_group_last; }
+
     bool SQLiteDatabase::BeginTransaction()
     {
         m_connection_mutex.lock();
 
-        if (!m_db || sqlite3_get_autocommit(m_db) == 0) return false;
+        if (!m_db) return false;
+
+        if (!isReadOnlyConnect)
+        {
+            if (g_group_scope)
+                return BeginGroupStep();
+
+            if (m_group_open)
+                return BeginForeignStep();
+        }
+
+        if (sqlite3_get_autocommit(m_db) == 0) return false;
+
+        // Register reader for WAL checkpoint scheduler
+        if (isReadOnlyConnect)
+            PocketServices::WalCheckpointerInst.ReaderBegin(this);
+
         int res = sqlite3_exec(m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
         if (res != SQLITE_OK)
+        {
             LogPrintf("%s: %d; Failed to begin the transaction: %s\n", __func__, res, sqlite3_errstr(res));
 
+            if (isReadOnlyConnect)
+                PocketServices::WalCheckpointerInst.ReaderEnd(this);
+        }
+
         return res == SQLITE_OK;
     }
 
     bool SQLiteDatabase::CommitTransaction()
     {
+        if (m_foreign_step)
+        {
+            m_foreign_step = false;
+
+            int res = sqlite3_exec(m_db, "RELEASE foreign_step", nullptr, nullptr, nullptr);
+            if (res != SQLITE_OK)
+                LogPrintf("%s: %d; Failed to release the transaction: %s\n", __func__, res, sqlite3_errstr(res));
+
+            // Changes are committed at once together with the pending group changes
+            bool ok = (res == SQLITE_OK);
+            if (ok && sqlite3_total_changes(m_db) != m_foreign_changes)
+                ok = FinishGroup();
+
+            m_profile_func.clear();
+            m_connection_mutex.unlock();
+
+            return ok;
+        }
+
+        if (m_group_step)
+        {
+            m_group_step = false;
+            m_group_steps += 1;
+
+            int res = sqlite3_exec(m_db, "RELEASE group_step", nullptr, nullptr, nullptr);
+            if (res != SQLITE_OK)
+                LogPrintf("%s: %d; Failed to release the group step: %s\n", __func__, res, sqlite3_errstr(res));
+
+            m_profile_func.clear();
+            m_connection_mutex.unlock();
+
+            return res == SQLITE_OK;
+        }
+
         if (!m_db || sqlite3_get_autocommit(m_db) != 0) return false;
         int res = sqlite3_exec(m_db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
         if (res != SQLITE_OK)
             LogPrintf("%s: %d; Failed to commit the transaction: %s\n", __func__, res, sqlite3_errstr(res));
 
+        if (isReadOnlyConnect)
+            PocketServices::WalCheckpointerInst.ReaderEnd(this);
+
+        m_profile_func.clear();
         m_connection_mutex.unlock();
 
         return res == SQLITE_OK;
@@ -339,16 +427,147 @@ namespace PocketDb
 
     bool SQLiteDatabase::AbortTransaction()
     {
+        if (m_foreign_step)
+        {
+            m_foreign_step = false;
+
+            int res = sqlite3_exec(m_db, "ROLLBACK TO foreign_step; RELEASE foreign_step", nullptr, nullptr, nullptr);
+            if (res != SQLITE_OK)
+                LogPrintf("%s: %d; Failed to abort the transaction: %s\n", __func__, res, sqlite3_errstr(res));
+
+            m_profile_func.clear();
+            m_connection_mutex.unlock();
+
+            return res == SQLITE_OK;
+        }
+
+        if (m_group_step)
+        {
+            m_group_step = false;
+
+            // Only changes of the failed step are rolled back
+            int res = sqlite3_exec(m_db, "ROLLBACK TO group_step; RELEASE group_step", nullptr, nullptr, nullptr);
+            if (res != SQLITE_OK)
+                LogPrintf("%s: %d; Failed to rollback the group step: %s\n", __func__, res, sqlite3_errstr(res));
+
+            m_profile_func.clear();
+            m_connection_mutex.unlock();
+
+            return res == SQLITE_OK;
+        }
+
         if (!m_db || sqlite3_get_autocommit(m_db) != 0) return false;
         int res = sqlite3_exec(m_db, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
         if (res != SQLITE_OK)
             LogPrintf("%s: %d; Failed to abort the transaction: %s\n", __func__, res, sqlite3_errstr(res));
 
+        if (isReadOnlyConnect)
+            PocketServices::WalCheckpointerInst.ReaderEnd(this);
+
+        m_profile_func.clear();
         m_connection_mutex.unlock();
 
         return res == SQLITE_OK;
     }
 
+    bool SQLiteDatabase::BeginGroupStep()
+    {
+        // Set before begin so that AbortTransaction never rolls back the whole group
+        m_group_step = true;
+
+        if (!m_group_open)
+        {
+            if (sqlite3_get_autocommit(m_db) == 0) return false;
+
+            int res = sqlite3_exec(m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+            if (res != SQLITE_OK)
+            {
+                LogPrintf("%s: %d; Failed to begin the group transaction: %s\n", __func__, res, sqlite3_errstr(res));
+                return false;
+            }
+
+            m_group_open = true;
+            m_group_steps = 0;
+            m_group_begin = GetTimeMillis();
+            m_group_id += 1;
+        }
+
+        g_group_last = m_group_id;
+
+        int res = sqlite3_exec(m_db, "SAVEPOINT group_step", nullptr, nullptr, nullptr);
+        if (res != SQLITE_OK)
+        {
+            LogPrintf("%s: %d; Failed to begin the group step: %s\n", __func__, res, sqlite3_errstr(res));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SQLiteDatabase::BeginForeignStep()
+    {
+        // Set before begin so that AbortTransaction never rolls back the whole group
+        m_foreign_step = true;
+        m_foreign_changes = sqlite3_total_changes(m_db);
+
+        int res = sqlite3_exec(m_db, "SAVEPOINT foreign_step", nullptr, nullptr, nullptr);
+        if (res != SQLITE_OK)
+        {
+            LogPrintf("%s: %d; Failed to begin the transaction: %s\n", __func__, res, sqlite3_errstr(res));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SQLiteDatabase::FinishGroup()
+    {
+        m_group_open = false;
+
+        if (!m_db || sqlite3_get_autocommit(m_db) != 0) return true;
+
+        int64_t nTime1 = GetTimeMicros();
+
+        int res = sqlite3_exec(m_db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+        if (res != SQLITE_OK)
+        {
+            // Group owner is notified below and executes the lost steps again
+            LogPrintf("%s: %d; Failed to commit the group transaction: %s\n", __func__, res, sqlite3_errstr(res));
+            if (sqlite3_get_autocommit(m_db) == 0)
+                sqlite3_exec(m_db, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
+        }
+
+        LogPrint(BCLog::SQLBENCH, "SQL Bench `%s` (%d steps): %.2fms\n", __func__, m_group_steps,
+            0.001 * (double)(GetTimeMicros() - nTime1));
+
+        if (m_group_finished)
+            m_group_finished(m_group_id, res == SQLITE_OK);
+
+        return res == SQLITE_OK;
+    }
+
+    void SQLiteDatabase::SetGroupFinished(std::function<void(int64_t, bool)> func)
+    {
+        lock_guard<mutex> lock(m_connection_mutex);
+        m_group_finished = std::move(func);
+    }
+
+    bool SQLiteDatabase::CommitGroup()
+    {
+        lock_guard<mutex> lock(m_connection_mutex);
+        return !m_group_open || FinishGroup();
+    }
+
+    tuple<int, int64_t> SQLiteDatabase::GroupState()
+    {
+        lock_guard<mutex> lock(m_connection_mutex);
+
+        if (!m_group_open)
+            return { 0, 0 };
+
+        return { m_group_steps, GetTimeMillis() - m_group_begin };
+    }
+
     void SQLiteDatabase::InterruptQuery()
     {
         if (m_db)
@@ -11,11 +11,13 @@
 #include "fs.h"
 
 #include <sqlite3.h>
+#include <functional>
 #include <iostream>
 
 #include "pocketdb/migrations/base.h"
 #include "pocketdb/migrations/main.h"
 #include "pocketdb/migrations/web.h"
+#include "pocketdb/SQLiteProfiler.h"
 
 namespace PocketDb
 {
@@ -33,10 +35,29 @@ namespace PocketDb
 
         bool BulkExecute(string sql);
 
+        // Group transaction state - guarded by m_connection_mutex
+        bool m_group_open = false;
+        bool m_group_step = false;
+        int m_group_steps = 0;
+        int64_t m_group_begin = 0;
+        int64_t m_group_id = 0;
+        std::function<void(int64_t, bool)> m_group_finished;
+
+        // Transaction of other thread executed inside the open group
+        bool m_foreign_step = false;
+        int m_foreign_changes = 0;
+
+        bool BeginGroupStep();
+        bool BeginForeignStep();
+        bool FinishGroup();
+
     public:
         sqlite3* m_db{nullptr};
         mutex m_connection_mutex;
 
+        // Repository method executed in the current transaction - used by SQL profiler
+        string m_profile_func;
+
         explicit SQLiteDatabase(bool readOnly);
 
         bool IsReadOnly() const;
@@ -57,6 +78,17 @@ namespace PocketDb
 
         bool AbortTransaction();
 
+        // Group commit for the write connection. Transactions begun by a thread inside
+        // SQLiteGroupScope are executed as savepoints of one shared transaction - its
+        // changes are visible for this connection at once and are committed by CommitGroup.
+        // Other transactions run as savepoints of the open group too: reads keep the group open,
+        // a transaction with changes commits the group together with its own changes.
+        bool CommitGroup();
+        tuple<int, int64_t> GroupState();
+
+        // Called under connection lock with the group id when the group is committed or rolled back
+        void SetGroupFinished(std::function<void(int64_t, bool)> func);
+
         void InterruptQuery();
 
         void DetachDatabase(const string& dbName);
@@ -67,6 +99,19 @@ namespace PocketDb
 
     typedef shared_ptr<SQLiteDatabase> SQLiteDatabaseRef;
 
+    // Marks transactions of the current thread as steps of the group transaction
+    class SQLiteGroupScope
+    {
+    public:
+        SQLiteGroupScope();
+        ~SQLiteGroupScope();
+
+        // Group of the last step begun by the current thread
+        static int64_t LastGroup();
+    private:
+        bool m_prev;
+    };
+
 } // namespace PocketDb
 
 #endif // POCKETDB_SQLITEDATABASE_H
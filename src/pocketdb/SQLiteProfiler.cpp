@@ -0,0 +1,201 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/SQLiteProfiler.h"
+#include "utiltime.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace PocketDb
+{
+    // Shard of current thread, merged into retired statistics when thread finishes
+    struct SQLiteProfilerThread
+    {
+        SQLiteProfiler* Owner = nullptr;
+        shared_ptr<SQLiteProfiler::Shard> Shard;
+
+        ~SQLiteProfilerThread()
+        {
+            if (Owner)
+                Owner->Retire(Shard);
+        }
+    };
+
+    static thread_local SQLiteProfilerThread g_profiler_thread;
+
+    SQLiteProfileStat& SQLiteProfiler::Shard::GetStat(const string& func)
+    {
+        if (m_lastStat && m_last == func)
+            return *m_lastStat;
+
+        m_last = func;
+        m_lastStat = &m_stats[func.empty() ? "<other>" : func];
+        return *m_lastStat;
+    }
+
+    SQLiteProfiler::Shard& SQLiteProfiler::LocalShard()
+    {
+        int64_t since = 0;
+        m_since.compare_exchange_strong(since, GetTime());
+
+        auto& local = g_profiler_thread;
+        if (local.Owner != this)
+        {
+            if (local.Owner)
+                local.Owner->Retire(local.Shard);
+
+            local.Owner = this;
+            local.Shard = make_shared<Shard>();
+
+            LOCK(m_mutex);
+            m_shards.push_back(local.Shard);
+        }
+
+        return *local.Shard;
+    }
+
+    void SQLiteProfiler::Retire(const shared_ptr<Shard>& shard)
+    {
+        LOCK(m_mutex);
+
+        {
+            LOCK(shard->m_mutex);
+            for (const auto& [func, stat] : shard->m_stats)
+                Merge(m_retired[func], stat);
+        }
+
+        m_shards.erase(remove(m_shards.begin(), m_shards.end(), shard), m_shards.end());
+    }
+
+    void SQLiteProfiler::Merge(SQLiteProfileStat& to, const SQLiteProfileStat& from)
+    {
+        to.Calls += from.Calls;
+        to.Failed += from.Failed;
+        to.TotalTime += from.TotalTime;
+        to.MaxTime = max(to.MaxTime, from.MaxTime);
+        for (size_t i = 0; i < SQL_PROFILE_BUCKETS_COUNT; i++)
+            to.Histogram[i] += from.Histogram[i];
+
+        to.Statements += from.Statements;
+        to.StatementsTime += from.StatementsTime;
+        to.FullscanSteps += from.FullscanSteps;
+        to.VmSteps += from.VmSteps;
+        to.Sorts += from.Sorts;
+        to.AutoIndexes += from.AutoIndexes;
+    }
+
+    void SQLiteProfiler::AddCall(const string& func, int64_t duration, bool success)
+    {
+        size_t bucket = 0;
+        while (bucket < SQL_PROFILE_BUCKETS_COUNT - 1 && duration >= SQL_PROFILE_BUCKETS[bucket])
+            bucket++;
+
+        auto& shard = LocalShard();
+        LOCK(shard.m_mutex);
+
+        auto& stat = shard.GetStat(func);
+        stat.Calls += 1;
+        stat.Failed += success ? 0 : 1;
+        stat.TotalTime += duration;
+        stat.MaxTime = max(stat.MaxTime, duration);
+        stat.Histogram[bucket] += 1;
+    }
+
+    void SQLiteProfiler::AddStatement(const string& func, sqlite3_stmt* stmt, int64_t duration)
+    {
+        // Counters are reset so that the next run of the same statement is counted separately
+        int fullscanSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+        int vmSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1);
+        int sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+        int autoIndexes = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+
+        // Lock of own shard is taken by other threads only while statistics are merged
+        auto& shard = LocalShard();
+        LOCK(shard.m_mutex);
+
+        auto& stat = shard.GetStat(func);
+        stat.Statements += 1;
+        stat.StatementsTime += duration;
+        stat.FullscanSteps += fullscanSteps;
+        stat.VmSteps += vmSteps;
+        stat.Sorts += sorts;
+        stat.AutoIndexes += autoIndexes;
+    }
+
+    UniValue SQLiteProfiler::Stats()
+    {
+        vector<pair<string, SQLiteProfileStat>> stats;
+        int64_t since = m_since;
+
+        {
+            LOCK(m_mutex);
+
+            map<string, SQLiteProfileStat> merged = m_retired;
+            for (const auto& shard : m_shards)
+            {
+                LOCK(shard->m_mutex);
+                for (const auto& [func, stat] : shard->m_stats)
+                    Merge(merged[func], stat);
+            }
+
+            stats.assign(merged.begin(), merged.end());
+        }
+
+        // Most expensive methods first
+        sort(stats.begin(), stats.end(), [](const auto& a, const auto& b) {
+            return a.second.StatementsTime > b.second.StatementsTime;
+        });
+
+        UniValue methods(UniValue::VARR);
+        for (const auto& [func, stat] : stats)
+        {
+            UniValue histogram(UniValue::VARR);
+            for (size_t i = 0; i < SQL_PROFILE_BUCKETS_COUNT; i++)
+            {
+                UniValue bucket(UniValue::VOBJ);
+                bucket.pushKV("le", i < SQL_PROFILE_BUCKETS_COUNT - 1 ? UniValue(SQL_PROFILE_BUCKETS[i]) : UniValue("inf"));
+                bucket.pushKV("count", stat.Histogram[i]);
+                histogram.push_back(bucket);
+            }
+
+            UniValue method(UniValue::VOBJ);
+            method.pushKV("method", func);
+            method.pushKV("calls", stat.Calls);
+            method.pushKV("failed", stat.Failed);
+            method.pushKV("totaltime", stat.TotalTime);
+            method.pushKV("avgtime", stat.Calls > 0 ? stat.TotalTime / stat.Calls : 0);
+            method.pushKV("maxtime", stat.MaxTime);
+            method.pushKV("histogram", histogram);
+            method.pushKV("statements", stat.Statements);
+            method.pushKV("statementstime", stat.StatementsTime);
+            method.pushKV("fullscansteps", stat.FullscanSteps);
+            method.pushKV("vmsteps", stat.VmSteps);
+            method.pushKV("sorts", stat.Sorts);
+            method.pushKV("autoindexes", stat.AutoIndexes);
+            methods.push_back(method);
+        }
+
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("since", since);
+        result.pushKV("methods", methods);
+        return result;
+    }
+
+    void SQLiteProfiler::Reset()
+    {
+        LOCK(m_mutex);
+        m_retired.clear();
+
+        for (const auto& shard : m_shards)
+        {
+            LOCK(shard->m_mutex);
+            shard->m_stats.clear();
+            shard->m_lastStat = nullptr;
+        }
+
+        m_since = GetTime();
+    }
+
+} // namespace PocketDb
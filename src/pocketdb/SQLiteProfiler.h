@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_SQLITEPROFILER_H
+#define POCKETDB_SQLITEPROFILER_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sqlite3.h>
+#include <univalue.h>
+#include "sync.h"
+
+namespace PocketDb
+{
+    using namespace std;
+
+    // Upper bounds of latency histogram buckets in microseconds, last bucket is unbounded
+    static const int64_t SQL_PROFILE_BUCKETS[] = { 100, 1000, 10000, 100000, 1000000 };
+    static const size_t SQL_PROFILE_BUCKETS_COUNT = sizeof(SQL_PROFILE_BUCKETS) / sizeof(SQL_PROFILE_BUCKETS[0]) + 1;
+
+    struct SQLiteProfileStat
+    {
+        // Repository method calls (one SQL transaction per call)
+        int64_t Calls = 0;
+        int64_t Failed = 0;
+        int64_t TotalTime = 0;
+        int64_t MaxTime = 0;
+        int64_t Histogram[SQL_PROFILE_BUCKETS_COUNT] = {};
+
+        // Statements executed inside method - collected from sqlite3_trace_v2 & sqlite3_stmt_status
+        int64_t Statements = 0;
+        int64_t StatementsTime = 0;
+        int64_t FullscanSteps = 0;
+        int64_t VmSteps = 0;
+        int64_t Sorts = 0;
+        int64_t AutoIndexes = 0;
+    };
+
+    // Always-on aggregation of SQL execution statistics by repository method.
+    // Method name is taken from TryTransactionStep and statements executed
+    // outside of repository methods are collected under "<other>".
+    // Every thread collects into own shard without contention with other threads,
+    // shards are merged only when statistics are requested.
+    class SQLiteProfiler
+    {
+    public:
+        void AddCall(const string& func, int64_t duration, bool success);
+        void AddStatement(const string& func, sqlite3_stmt* stmt, int64_t duration);
+
+        UniValue Stats();
+        void Reset();
+
+    private:
+        friend struct SQLiteProfilerThread;
+
+        struct Shard
+        {
+            Mutex m_mutex;
+            unordered_map<string, SQLiteProfileStat> m_stats;
+
+            // Consecutive statements mostly belong to the same method
+            string m_last;
+            SQLiteProfileStat* m_lastStat = nullptr;
+
+            SQLiteProfileStat& GetStat(const string& func);
+        };
+
+        Mutex m_mutex;
+        vector<shared_ptr<Shard>> m_shards;
+        // Statistics of finished threads
+        map<string, SQLiteProfileStat> m_retired;
+        atomic<int64_t> m_since{0};
+
+        Shard& LocalShard();
+        void Retire(const shared_ptr<Shard>& shard);
+        static void Merge(SQLiteProfileStat& to, const SQLiteProfileStat& from);
+    };
+
+    extern SQLiteProfiler SQLiteProfilerInst;
+
+} // namespace PocketDb
+
+#endif // POCKETDB_SQLITEPROFILER_H
@@ -6,15 +6,69 @@
 
 namespace PocketConsensus
 {
-    BaseConsensus::BaseConsensus() = default;
+    // Networks without own values use main network limits
+    static const map<int, int64_t>* GetNetworkLimits(const map<NetworkId, map<int, int64_t>>& limits, NetworkId network)
+    {
+        auto it = limits.find(network);
+        if (it == limits.end())
+            it = limits.find(NetworkMain);
+
+        return it != limits.end() ? &it->second : nullptr;
+    }
+
+    static vector<ConsensusLimitsEpoch> BuildConsensusLimitsEpochs(NetworkId network)
+    {
+        set<int> heights = { 0 };
+        for (const auto&[type, limits] : m_consensus_limits)
+            if (auto values = GetNetworkLimits(limits, network))
+                for (const auto&[height, value] : *values)
+                    heights.insert(height);
+
+        vector<ConsensusLimitsEpoch> epochs;
+        for (int height : heights)
+        {
+            ConsensusLimitsEpoch epoch{ height, {} };
+            for (const auto&[type, limits] : m_consensus_limits)
+            {
+                // Limit is zero before its first value
+                auto values = GetNetworkLimits(limits, network);
+                if (!values)
+                    continue;
+
+                auto it = values->upper_bound(height);
+                if (it != values->begin())
+                    epoch.Values[type] = prev(it)->second;
+            }
+
+            epochs.push_back(epoch);
+        }
+
+        return epochs;
+    }
+
+    const ConsensusLimitsEpoch& GetConsensusLimitsEpoch(int height)
+    {
+        static const array<vector<ConsensusLimitsEpoch>, 3> epochs = {
+            BuildConsensusLimitsEpochs(NetworkMain),
+            BuildConsensusLimitsEpochs(NetworkTest),
+            BuildConsensusLimitsEpochs(NetworkRegTest)
+        };
+
+        const auto& networkEpochs = epochs[Params().NetworkID()];
+        return *prev(upper_bound(networkEpochs.begin(), networkEpochs.end(), max(height, 0),
+            [](int target, const ConsensusLimitsEpoch& epoch) { return target < epoch.Height; }));
+    }
+
+    BaseConsensus::BaseConsensus() : m_limits(&GetConsensusLimitsEpoch(0))
+    {
+    }
 
-    BaseConsensus::BaseConsensus(int height) : BaseConsensus()
+    BaseConsensus::BaseConsensus(int height) : Height(height), m_limits(&GetConsensusLimitsEpoch(height))
     {
-        Height = height;
     }
 
     int64_t BaseConsensus::GetConsensusLimit(ConsensusLimit type) const
     {
-        return (--m_consensus_limits[type][Params().NetworkID()].upper_bound(Height))->second;
+        return m_limits->Values[type];
     }
-}
\ No newline at end of file
+}
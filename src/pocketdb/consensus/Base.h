@@ -5,6 +5,8 @@
 #ifndef POCKETCONSENSUS_BASE_H
 #define POCKETCONSENSUS_BASE_H
 
+#include <array>
+
 #include "univalue/include/univalue.h"
 
 #include "pocketdb/pocketnet.h"
@@ -242,6 +244,9 @@ namespace PocketConsensus
         ConsensusLimit_bad_reputation,
 
         ConsensusLimit_moderation_flag_count,
+
+        // Count of limits - must be last
+        ConsensusLimit_Count
     };
 
     /*********************************************************************************************/
@@ -508,6 +513,16 @@ namespace PocketConsensus
         
     };
 
+    // Values of all limits between two heights where any limit changes.
+    // Resolved once for network, so rules select limits without map lookups.
+    struct ConsensusLimitsEpoch
+    {
+        int Height;
+        array<int64_t, ConsensusLimit_Count> Values;
+    };
+
+    const ConsensusLimitsEpoch& GetConsensusLimitsEpoch(int height);
+
     /*********************************************************************************************/
     class BaseConsensus
     {
@@ -516,8 +531,10 @@ namespace PocketConsensus
         explicit BaseConsensus(int height);
         virtual ~BaseConsensus() = default;
         int64_t GetConsensusLimit(ConsensusLimit type) const;
+        int GetHeight() const { return Height; }
     protected:
         int Height = 0;
+        const ConsensusLimitsEpoch* m_limits;
     };
 
     /*********************************************************************************************/
@@ -528,12 +545,9 @@ namespace PocketConsensus
         int m_test_height;
         function<shared_ptr<T>(int height)> m_func;
 
-        [[nodiscard]] int Height(const string& networkId) const
+        [[nodiscard]] int Height(NetworkId networkId) const
         {
-            if (networkId == CBaseChainParams::MAIN)
-                return m_main_height;
-
-            if (networkId == CBaseChainParams::TESTNET)
+            if (networkId == NetworkTest)
                 return m_test_height;
 
             return m_main_height;
@@ -3,6 +3,7 @@
 // https://www.apache.org/licenses/LICENSE-2.0
 
 #include "pocketdb/consensus/Helper.h"
+#include "pocketdb/services/PocketCheckQueue.h"
 
 namespace PocketConsensus
 {
@@ -28,8 +29,47 @@ namespace PocketConsensus
     
     ModerationFlagConsensusFactory SocialConsensusHelper::m_moderationFlagFactory;
 
+    Mutex SocialConsensusHelper::m_rulesMutex;
+    SocialConsensusRulesRef SocialConsensusHelper::m_rules;
+
+    SocialConsensusRulesRef SocialConsensusHelper::Rules(int height)
+    {
+        LOCK(m_rulesMutex);
+
+        if (m_rules && m_rules->Height == height)
+            return m_rules;
+
+        auto rules = make_shared<SocialConsensusRules>();
+        rules->Height = height;
+        rules->AccountUser = m_accountUserFactory.Instance(height);
+        rules->AccountSetting = m_accountSettingFactory.Instance(height);
+        rules->AccountDelete = m_accountDeleteFactory.Instance(height);
+        rules->Post = m_postFactory.Instance(height);
+        rules->Video = m_videoFactory.Instance(height);
+        rules->Article = m_articleFactory.Instance(height);
+        rules->Comment = m_commentFactory.Instance(height);
+        rules->CommentEdit = m_commentEditFactory.Instance(height);
+        rules->CommentDelete = m_commentDeleteFactory.Instance(height);
+        rules->ScoreContent = m_scoreContentFactory.Instance(height);
+        rules->ScoreComment = m_scoreCommentFactory.Instance(height);
+        rules->Subscribe = m_subscribeFactory.Instance(height);
+        rules->SubscribePrivate = m_subscribePrivateFactory.Instance(height);
+        rules->SubscribeCancel = m_subscribeCancelFactory.Instance(height);
+        rules->Blocking = m_blockingFactory.Instance(height);
+        rules->BlockingCancel = m_blockingCancelFactory.Instance(height);
+        rules->Complain = m_complainFactory.Instance(height);
+        rules->ContentDelete = m_contentDeleteFactory.Instance(height);
+        rules->BoostContent = m_boostContentFactory.Instance(height);
+        rules->ModerationFlag = m_moderationFlagFactory.Instance(height);
+
+        m_rules = rules;
+        return m_rules;
+    }
+
     tuple<bool, SocialConsensusResult> SocialConsensusHelper::Validate(const CBlock& block, const PocketBlockRef& pBlock, int height)
     {
+        auto rules = Rules(height);
+
         for (const auto& tx : block.vtx)
         {
             // We have to verify all transactions using consensus
@@ -40,7 +80,7 @@ namespace PocketConsensus
             // Validate founded data
             if (it != pBlock->end())
             {
-                if (auto[ok, result] = validate(tx, *it, pBlock, height); !ok)
+                if (auto[ok, result] = validate(tx, *it, pBlock, *rules); !ok)
                 {
                     LogPrint(BCLog::CONSENSUS,
                         "Warning: SocialConsensus type:%d validate tx:%s blk:%s failed with result:%d at height:%d\n",
@@ -57,10 +97,10 @@ namespace PocketConsensus
     tuple<bool, SocialConsensusResult> SocialConsensusHelper::Validate(const CTransactionRef& tx, const PTransactionRef& ptx, int height)
     {
         // Not double validate for already in DB
-        if (TransRepoInst.Exists(*ptx->GetHash()))
+        if (PocketServices::MempoolWriterInst.Exists(*ptx->GetHash()))
             return {true, SocialConsensusResult_Success};
 
-        if (auto[ok, result] = validate(tx, ptx, nullptr, height); !ok)
+        if (auto[ok, result] = validate(tx, ptx, nullptr, *Rules(height)); !ok)
         {
             LogPrint(BCLog::CONSENSUS, "Warning: SocialConsensus type:%d validate failed with result:%d for tx:%s at height:%d\n",
                 (int) *ptx->GetType(), (int)result, *ptx->GetHash(), height);
@@ -73,7 +113,7 @@ namespace PocketConsensus
 
     tuple<bool, SocialConsensusResult> SocialConsensusHelper::Validate(const CTransactionRef& tx, const PTransactionRef& ptx, PocketBlockRef& pBlock, int height)
     {
-        if (auto[ok, result] = validate(tx, ptx, pBlock, height); !ok)
+        if (auto[ok, result] = validate(tx, ptx, pBlock, *Rules(height)); !ok)
         {
             LogPrint(BCLog::CONSENSUS, "Warning: SocialConsensus type:%d validate tx:%s failed with result:%d for block construction at height:%d\n",
                 (int)*ptx->GetType(), *ptx->GetHash(), (int)result, height);
@@ -101,7 +141,12 @@ namespace PocketConsensus
             return tx->IsCoinStake();
         }) != block.vtx.end();
 
-        // Check all transactions in block and payload block
+        unordered_map<string, PTransactionRef> payloads;
+        for (const auto& ptx : *pBlock)
+            payloads.emplace(*ptx->GetHash(), ptx);
+
+        // Find payloads for all transactions in block
+        vector<pair<CTransactionRef, PTransactionRef>> txs;
         for (const auto& tx : block.vtx)
         {
             // NOT_SUPPORTED transactions not checked
@@ -112,9 +157,8 @@ namespace PocketConsensus
                 continue;
 
             // Maybe payload not exists?
-            auto txHash = tx->GetHash().GetHex();
-            auto it = find_if(pBlock->begin(), pBlock->end(), [&](PTransactionRef const& ptx) { return *ptx == txHash; });
-            if (it == pBlock->end())
+            auto it = payloads.find(tx->GetHash().GetHex());
+            if (it == payloads.end())
             {
                 LogPrint(BCLog::CONSENSUS, "Warning: SocialConsensus type:%d check failed with result:%d for tx:%s in blk:%s at height:%d\n",
                     (int)txType, (int)SocialConsensusResult_PocketDataNotFound, tx->GetHash().GetHex(), block.GetHash().GetHex(), height);
@@ -122,11 +166,32 @@ namespace PocketConsensus
                 return {false, SocialConsensusResult_PocketDataNotFound};
             }
 
-            // Check founded payload
-            if (auto[ok, result] = check(tx, *it, height); !ok)
+            txs.emplace_back(tx, it->second);
+        }
+
+        // Check founded payloads - checks are stateless so can be executed in parallel
+        auto rules = Rules(height);
+        vector<PocketServices::PocketCheck> checks;
+        checks.reserve(txs.size());
+        for (const auto&[tx, ptx] : txs)
+        {
+            checks.emplace_back([&tx = tx, &ptx = ptx, &rules]()
+            {
+                auto[ok, result] = check(tx, ptx, *rules);
+                return ok;
+            });
+        }
+
+        if (PocketServices::RunPocketChecks(checks))
+            return {true, SocialConsensusResult_Success};
+
+        // Repeat in order for return result of first failed transaction
+        for (const auto&[tx, ptx] : txs)
+        {
+            if (auto[ok, result] = check(tx, ptx, *rules); !ok)
             {
                 LogPrint(BCLog::CONSENSUS, "Warning: SocialConsensus check type:%d failed with result:%d for tx:%s in blk:%s at height:%d\n",
-                    (int)txType, (int)result, tx->GetHash().GetHex(), block.GetHash().GetHex(), height);
+                    (int) *ptx->GetType(), (int)result, tx->GetHash().GetHex(), block.GetHash().GetHex(), height);
 
                 return {false, result};
             }
@@ -138,7 +203,7 @@ namespace PocketConsensus
     // Проверяет транзакцию без привязки к цепи
     tuple<bool, SocialConsensusResult> SocialConsensusHelper::Check(const CTransactionRef& tx, const PTransactionRef& ptx, int height)
     {
-        if (auto[ok, result] = check(tx, ptx, height); !ok)
+        if (auto[ok, result] = check(tx, ptx, *Rules(height)); !ok)
         {
             LogPrint(BCLog::CONSENSUS, "Warning: SocialConsensus type:%d check failed with result:%d for tx:%s at height:%d\n",
                 (int) *ptx->GetType(), (int)result, *ptx->GetHash(), height);
@@ -151,7 +216,7 @@ namespace PocketConsensus
 
     // -----------------------------------------------------------------
 
-    tuple<bool, SocialConsensusResult> SocialConsensusHelper::check(const CTransactionRef& tx, const PTransactionRef& ptx, int height)
+    tuple<bool, SocialConsensusResult> SocialConsensusHelper::check(const CTransactionRef& tx, const PTransactionRef& ptx, const SocialConsensusRules& rules)
     {
         if (!isConsensusable(*ptx->GetType()))
             return {true, SocialConsensusResult_Success};
@@ -161,54 +226,54 @@ namespace PocketConsensus
         switch (*ptx->GetType())
         {
             case ACCOUNT_SETTING:
-                return m_accountSettingFactory.Instance(height)->Check(tx, static_pointer_cast<AccountSetting>(ptx));
+                return rules.AccountSetting->Check(tx, static_pointer_cast<AccountSetting>(ptx));
             case ACCOUNT_DELETE:
-                return m_accountDeleteFactory.Instance(height)->Check(tx, static_pointer_cast<AccountDelete>(ptx));
+                return rules.AccountDelete->Check(tx, static_pointer_cast<AccountDelete>(ptx));
             case ACCOUNT_USER:
-                return m_accountUserFactory.Instance(height)->Check(tx, static_pointer_cast<User>(ptx));
+                return rules.AccountUser->Check(tx, static_pointer_cast<User>(ptx));
             case CONTENT_POST:
-                return m_postFactory.Instance(height)->Check(tx, static_pointer_cast<Post>(ptx));
+                return rules.Post->Check(tx, static_pointer_cast<Post>(ptx));
             case CONTENT_VIDEO:
-                return m_videoFactory.Instance(height)->Check(tx, static_pointer_cast<Video>(ptx));
+                return rules.Video->Check(tx, static_pointer_cast<Video>(ptx));
             case CONTENT_ARTICLE:
-                return m_articleFactory.Instance(height)->Check(tx, static_pointer_cast<Article>(ptx));
+                return rules.Article->Check(tx, static_pointer_cast<Article>(ptx));
             case CONTENT_COMMENT:
-                return m_commentFactory.Instance(height)->Check(tx, static_pointer_cast<Comment>(ptx));
+                return rules.Comment->Check(tx, static_pointer_cast<Comment>(ptx));
             case CONTENT_COMMENT_EDIT:
-                return m_commentEditFactory.Instance(height)->Check(tx, static_pointer_cast<CommentEdit>(ptx));
+                return rules.CommentEdit->Check(tx, static_pointer_cast<CommentEdit>(ptx));
             case CONTENT_COMMENT_DELETE:
-                return m_commentDeleteFactory.Instance(height)->Check(tx, static_pointer_cast<CommentDelete>(ptx));
+                return rules.CommentDelete->Check(tx, static_pointer_cast<CommentDelete>(ptx));
             case CONTENT_DELETE:
-                return m_contentDeleteFactory.Instance(height)->Check(tx, static_pointer_cast<ContentDelete>(ptx));
+                return rules.ContentDelete->Check(tx, static_pointer_cast<ContentDelete>(ptx));
             case BOOST_CONTENT:
-                return m_boostContentFactory.Instance(height)->Check(tx, static_pointer_cast<BoostContent>(ptx));
+                return rules.BoostContent->Check(tx, static_pointer_cast<BoostContent>(ptx));
             case ACTION_SCORE_CONTENT:
-                return m_scoreContentFactory.Instance(height)->Check(tx, static_pointer_cast<ScoreContent>(ptx));
+                return rules.ScoreContent->Check(tx, static_pointer_cast<ScoreContent>(ptx));
             case ACTION_SCORE_COMMENT:
-                return m_scoreCommentFactory.Instance(height)->Check(tx, static_pointer_cast<ScoreComment>(ptx));
+                return rules.ScoreComment->Check(tx, static_pointer_cast<ScoreComment>(ptx));
             case ACTION_SUBSCRIBE:
-                return m_subscribeFactory.Instance(height)->Check(tx, static_pointer_cast<Subscribe>(ptx));
+                return rules.Subscribe->Check(tx, static_pointer_cast<Subscribe>(ptx));
             case ACTION_SUBSCRIBE_PRIVATE:
-                return m_subscribePrivateFactory.Instance(height)->Check(tx, static_pointer_cast<SubscribePrivate>(ptx));
+                return rules.SubscribePrivate->Check(tx, static_pointer_cast<SubscribePrivate>(ptx));
             case ACTION_SUBSCRIBE_CANCEL:
-                return m_subscribeCancelFactory.Instance(height)->Check(tx, static_pointer_cast<SubscribeCancel>(ptx));
+                return rules.SubscribeCancel->Check(tx, static_pointer_cast<SubscribeCancel>(ptx));
             case ACTION_BLOCKING:
-                return m_blockingFactory.Instance(height)->Check(tx, static_pointer_cast<Blocking>(ptx));
+                return rules.Blocking->Check(tx, static_pointer_cast<Blocking>(ptx));
             case ACTION_BLOCKING_CANCEL:
-                return m_blockingCancelFactory.Instance(height)->Check(tx, static_pointer_cast<BlockingCancel>(ptx));
+                return rules.BlockingCancel->Check(tx, static_pointer_cast<BlockingCancel>(ptx));
             case ACTION_COMPLAIN:
-                return m_complainFactory.Instance(height)->Check(tx, static_pointer_cast<Complain>(ptx));
+                return rules.Complain->Check(tx, static_pointer_cast<Complain>(ptx));
 
             // Moderation
             case MODERATION_FLAG:
-                return m_moderationFlagFactory.Instance(height)->Check(tx, static_pointer_cast<ModerationFlag>(ptx));
+                return rules.ModerationFlag->Check(tx, static_pointer_cast<ModerationFlag>(ptx));
 
             default:
                 return {false, SocialConsensusResult_NotImplemeted};
         }
     }
 
-    tuple<bool, SocialConsensusResult> SocialConsensusHelper::validate(const CTransactionRef& tx, const PTransactionRef& ptx, const PocketBlockRef& pBlock, int height)
+    tuple<bool, SocialConsensusResult> SocialConsensusHelper::validate(const CTransactionRef& tx, const PTransactionRef& ptx, const PocketBlockRef& pBlock, const SocialConsensusRules& rules)
     {
         if (!isConsensusable(*ptx->GetType()))
             return {true, SocialConsensusResult_Success};
@@ -218,47 +283,47 @@ namespace PocketConsensus
         switch (*ptx->GetType())
         {
             case ACCOUNT_SETTING:
-                return m_accountSettingFactory.Instance(height)->Validate(tx, static_pointer_cast<AccountSetting>(ptx), pBlock);
+                return rules.AccountSetting->Validate(tx, static_pointer_cast<AccountSetting>(ptx), pBlock);
             case ACCOUNT_DELETE:
-                return m_accountDeleteFactory.Instance(height)->Validate(tx, static_pointer_cast<AccountDelete>(ptx), pBlock);
+                return rules.AccountDelete->Validate(tx, static_pointer_cast<AccountDelete>(ptx), pBlock);
             case ACCOUNT_USER:
-                return m_accountUserFactory.Instance(height)->Validate(tx, static_pointer_cast<User>(ptx), pBlock);
+                return rules.AccountUser->Validate(tx, static_pointer_cast<User>(ptx), pBlock);
             case CONTENT_POST:
-                return m_postFactory.Instance(height)->Validate(tx, static_pointer_cast<Post>(ptx), pBlock);
+                return rules.Post->Validate(tx, static_pointer_cast<Post>(ptx), pBlock);
             case CONTENT_VIDEO:
-                return m_videoFactory.Instance(height)->Validate(tx, static_pointer_cast<Video>(ptx), pBlock);
+                return rules.Video->Validate(tx, static_pointer_cast<Video>(ptx), pBlock);
             case CONTENT_ARTICLE:
-                return m_articleFactory.Instance(height)->Validate(tx, static_pointer_cast<Article>(ptx), pBlock);
+                return rules.Article->Validate(tx, static_pointer_cast<Article>(ptx), pBlock);
             case CONTENT_COMMENT:
-                return m_commentFactory.Instance(height)->Validate(tx, static_pointer_cast<Comment>(ptx), pBlock);
+                return rules.Comment->Validate(tx, static_pointer_cast<Comment>(ptx), pBlock);
             case CONTENT_COMMENT_EDIT:
-                return m_commentEditFactory.Instance(height)->Validate(tx, static_pointer_cast<CommentEdit>(ptx), pBlock);
+                return rules.CommentEdit->Validate(tx, static_pointer_cast<CommentEdit>(ptx), pBlock);
             case CONTENT_COMMENT_DELETE:
-                return m_commentDeleteFactory.Instance(height)->Validate(tx, static_pointer_cast<CommentDelete>(ptx), pBlock);
+                return rules.CommentDelete->Validate(tx, static_pointer_cast<CommentDelete>(ptx), pBlock);
             case CONTENT_DELETE:
-                return m_contentDeleteFactory.Instance(height)->Validate(tx, static_pointer_cast<ContentDelete>(ptx), pBlock);
+                return rules.ContentDelete->Validate(tx, static_pointer_cast<ContentDelete>(ptx), pBlock);
             case BOOST_CONTENT:
-                return m_boostContentFactory.Instance(height)->Validate(tx, static_pointer_cast<BoostContent>(ptx), pBlock);
+                return rules.BoostContent->Validate(tx, static_pointer_cast<BoostContent>(ptx), pBlock);
             case ACTION_SCORE_CONTENT:
-                return m_scoreContentFactory.Instance(height)->Validate(tx, static_pointer_cast<ScoreContent>(ptx), pBlock);
+                return rules.ScoreContent->Validate(tx, static_pointer_cast<ScoreContent>(ptx), pBlock);
             case ACTION_SCORE_COMMENT:
-                return m_scoreCommentFactory.Instance(height)->Validate(tx, static_pointer_cast<ScoreComment>(ptx), pBlock);
+                return rules.ScoreComment->Validate(tx, static_pointer_cast<ScoreComment>(ptx), pBlock);
             case ACTION_SUBSCRIBE:
-                return m_subscribeFactory.Instance(height)->Validate(tx, static_pointer_cast<Subscribe>(ptx), pBlock);
+                return rules.Subscribe->Validate(tx, static_pointer_cast<Subscribe>(ptx), pBlock);
             case ACTION_SUBSCRIBE_PRIVATE:
-                return m_subscribePrivateFactory.Instance(height)->Validate(tx, static_pointer_cast<SubscribePrivate>(ptx), pBlock);
+                return rules.SubscribePrivate->Validate(tx, static_pointer_cast<SubscribePrivate>(ptx), pBlock);
             case ACTION_SUBSCRIBE_CANCEL:
-                return m_subscribeCancelFactory.Instance(height)->Validate(tx, static_pointer_cast<SubscribeCancel>(ptx), pBlock);
+                return rules.SubscribeCancel->Validate(tx, static_pointer_cast<SubscribeCancel>(ptx), pBlock);
             case ACTION_BLOCKING:
-                return m_blockingFactory.Instance(height)->Validate(tx, static_pointer_cast<Blocking>(ptx), pBlock);
+                return rules.Blocking->Validate(tx, static_pointer_cast<Blocking>(ptx), pBlock);
             case ACTION_BLOCKING_CANCEL:
-                return m_blockingCancelFactory.Instance(height)->Validate(tx, static_pointer_cast<BlockingCancel>(ptx), pBlock);
+                return rules.BlockingCancel->Validate(tx, static_pointer_cast<BlockingCancel>(ptx), pBlock);
             case ACTION_COMPLAIN:
-                return m_complainFactory.Instance(height)->Validate(tx, static_pointer_cast<Complain>(ptx), pBlock);
+                return rules.Complain->Validate(tx, static_pointer_cast<Complain>(ptx), pBlock);
 
             // Moderation
             case MODERATION_FLAG:
-                return m_moderationFlagFactory.Instance(height)->Validate(tx, static_pointer_cast<ModerationFlag>(ptx), pBlock);
+                return rules.ModerationFlag->Validate(tx, static_pointer_cast<ModerationFlag>(ptx), pBlock);
 
             default:
                 return {false, SocialConsensusResult_NotImplemeted};
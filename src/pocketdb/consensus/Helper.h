@@ -37,18 +37,49 @@ namespace PocketConsensus
     using namespace PocketTx;
     using namespace PocketDb;
 
+    // Social consensus rules selected for one height.
+    // Rules are stateless apart from height, so one set is shared by all transactions of block.
+    struct SocialConsensusRules
+    {
+        int Height;
+        shared_ptr<AccountUserConsensus> AccountUser;
+        shared_ptr<AccountSettingConsensus> AccountSetting;
+        shared_ptr<AccountDeleteConsensus> AccountDelete;
+        shared_ptr<PostConsensus> Post;
+        shared_ptr<VideoConsensus> Video;
+        shared_ptr<ArticleConsensus> Article;
+        shared_ptr<CommentConsensus> Comment;
+        shared_ptr<CommentEditConsensus> CommentEdit;
+        shared_ptr<CommentDeleteConsensus> CommentDelete;
+        shared_ptr<ScoreContentConsensus> ScoreContent;
+        shared_ptr<ScoreCommentConsensus> ScoreComment;
+        shared_ptr<SubscribeConsensus> Subscribe;
+        shared_ptr<SubscribePrivateConsensus> SubscribePrivate;
+        shared_ptr<SubscribeCancelConsensus> SubscribeCancel;
+        shared_ptr<BlockingConsensus> Blocking;
+        shared_ptr<BlockingCancelConsensus> BlockingCancel;
+        shared_ptr<ComplainConsensus> Complain;
+        shared_ptr<ContentDeleteConsensus> ContentDelete;
+        shared_ptr<BoostContentConsensus> BoostContent;
+
+        shared_ptr<ModerationFlagConsensus> ModerationFlag;
+    };
+
+    typedef shared_ptr<const SocialConsensusRules> SocialConsensusRulesRef;
+
     // This helper need for hide selector Consensus rules
     class SocialConsensusHelper
     {
     public:
+        static SocialConsensusRulesRef Rules(int height);
         static tuple<bool, SocialConsensusResult> Validate(const CBlock& block, const PocketBlockRef& pBlock, int height);
         static tuple<bool, SocialConsensusResult> Validate(const CTransactionRef& tx, const PTransactionRef& ptx, int height);
         static tuple<bool, SocialConsensusResult> Validate(const CTransactionRef& tx, const PTransactionRef& ptx, PocketBlockRef& pBlock, int height);
         static tuple<bool, SocialConsensusResult> Check(const CBlock& block, const PocketBlockRef& pBlock, int height);
         static tuple<bool, SocialConsensusResult> Check(const CTransactionRef& tx, const PTransactionRef& ptx, int height);
     protected:
-        static tuple<bool, SocialConsensusResult> validate(const CTransactionRef& tx, const PTransactionRef& ptx, const PocketBlockRef& pBlock, int height);
-        static tuple<bool, SocialConsensusResult> check(const CTransactionRef& tx, const PTransactionRef& ptx, int height);
+        static tuple<bool, SocialConsensusResult> validate(const CTransactionRef& tx, const PTransactionRef& ptx, const PocketBlockRef& pBlock, const SocialConsensusRules& rules);
+        static tuple<bool, SocialConsensusResult> check(const CTransactionRef& tx, const PTransactionRef& ptx, const SocialConsensusRules& rules);
         static bool isConsensusable(TxType txType);
     private:
         static AccountUserConsensusFactory m_accountUserFactory;
@@ -72,6 +103,10 @@ namespace PocketConsensus
         static BoostContentConsensusFactory m_boostContentFactory;
         
         static ModerationFlagConsensusFactory m_moderationFlagFactory;
+
+        // Last selected rules - transactions of mempool and of one block use the same height
+        static Mutex m_rulesMutex;
+        static SocialConsensusRulesRef m_rules;
     };
 }
 
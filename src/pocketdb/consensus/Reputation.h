@@ -405,16 +405,26 @@ namespace PocketConsensus
             { 1700000, 761000, [](int height) { return make_shared<ReputationConsensus_checkpoint_scores_content_author_reducing_impact>(height); }},
             { 1757000, 947500, [](int height) { return make_shared<ReputationConsensus_checkpoint_badges>(height); }},
         };
+        // Rules are stateless apart from height - social rules of one block share instance
+        Mutex m_last_mutex;
+        shared_ptr<ReputationConsensus> m_last;
     public:
         shared_ptr<ReputationConsensus> Instance(int height)
         {
             int m_height = (height > 0 ? height : 0);
-            return (--upper_bound(m_rules.begin(), m_rules.end(), m_height,
+
+            LOCK(m_last_mutex);
+            if (m_last && m_last->GetHeight() == m_height)
+                return m_last;
+
+            m_last = (--upper_bound(m_rules.begin(), m_rules.end(), m_height,
                 [&](int target, const ConsensusCheckpoint<ReputationConsensus>& itm)
                 {
-                    return target < itm.Height(Params().NetworkIDString());
+                    return target < itm.Height(Params().NetworkID());
                 }
             ))->m_func(m_height);
+
+            return m_last;
         }
     };
 
@@ -0,0 +1,143 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/helpers/SqlJsonWriter.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace PocketHelpers
+{
+    SqlJsonWriter::SqlJsonWriter()
+    {
+        m_out.reserve(4096);
+    }
+
+    void SqlJsonWriter::NextElement()
+    {
+        if (m_first.empty())
+            return;
+
+        if (!m_first.back())
+            m_out += ',';
+
+        m_first.back() = false;
+    }
+
+    void SqlJsonWriter::BeginArray()
+    {
+        NextElement();
+        m_out += '[';
+        m_first.push_back(true);
+    }
+
+    void SqlJsonWriter::EndArray()
+    {
+        m_out += ']';
+        m_first.pop_back();
+    }
+
+    void SqlJsonWriter::WriteRow(sqlite3_stmt* stmt, const SqlJsonSchema& schema)
+    {
+        NextElement();
+        m_out += '{';
+
+        bool first = true;
+        for (const auto& field : schema)
+        {
+            bool isNull = sqlite3_column_type(stmt, field.Column) == SQLITE_NULL;
+            if (isNull && !field.Required)
+                continue;
+
+            if (!first)
+                m_out += ',';
+            first = false;
+
+            m_out += '"';
+            m_out += field.Name;
+            m_out += "\":";
+
+            if (field.Const)
+            {
+                WriteString(m_out, field.Const, strlen(field.Const));
+                continue;
+            }
+
+            switch (field.Type)
+            {
+                case SqlJsonType::Text:
+                {
+                    // Text ends at first NUL as string read by TryGetColumnString
+                    auto value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, field.Column));
+                    WriteString(m_out, value ? value : "", value ? strlen(value) : 0);
+                    break;
+                }
+                case SqlJsonType::Int:
+                    m_out += to_string(sqlite3_column_int64(stmt, field.Column));
+                    break;
+                case SqlJsonType::Real:
+                {
+                    // Same format as UniValue::setFloat
+                    char buf[32];
+                    snprintf(buf, sizeof(buf), "%.16g", sqlite3_column_double(stmt, field.Column));
+                    m_out += buf;
+                    break;
+                }
+                case SqlJsonType::Bool:
+                    m_out += sqlite3_column_int64(stmt, field.Column) == 1 ? "true" : "false";
+                    break;
+                case SqlJsonType::Json:
+                {
+                    auto value = reinterpret_cast<const char*>(sqlite3_column_text(stmt, field.Column));
+                    if (value)
+                        m_out.append(value, sqlite3_column_bytes(stmt, field.Column));
+                    else
+                        m_out += "null";
+                    break;
+                }
+            }
+        }
+
+        m_out += '}';
+    }
+
+    void SqlJsonWriter::WriteString(string& out, const char* value, size_t size)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        out += '"';
+
+        // Copy runs without escaping at once - escapes are rare in texts
+        size_t start = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            unsigned char c = value[i];
+            if (c >= 0x20 && c != '"' && c != '\\' && c != 0x7f)
+                continue;
+
+            out.append(value + start, i - start);
+            start = i + 1;
+
+            switch (c)
+            {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\f': out += "\\f"; break;
+                case '\r': out += "\\r"; break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 15];
+                    break;
+            }
+        }
+
+        out.append(value + start, size - start);
+        out += '"';
+    }
+
+} // namespace PocketHelpers
@@ -0,0 +1,67 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_SQLJSONWRITER_H
+#define POCKETDB_SQLJSONWRITER_H
+
+#include <sqlite3.h>
+
+#include <string>
+#include <vector>
+
+namespace PocketHelpers
+{
+    using namespace std;
+
+    enum class SqlJsonType
+    {
+        Text,   // column text as JSON string
+        Int,    // column integer as JSON number
+        Real,   // column double as JSON number
+        Bool,   // column integer as true/false
+        Json,   // column text is already JSON
+    };
+
+    struct SqlJsonField
+    {
+        const char* Name;
+        int Column;
+        SqlJsonType Type = SqlJsonType::Text;
+
+        // Field is skipped for NULL column unless required - then empty value is written
+        bool Required = false;
+
+        // Written as string instead of column value when column is not NULL
+        const char* Const = nullptr;
+    };
+
+    using SqlJsonSchema = vector<SqlJsonField>;
+
+    // Streams result rows into JSON text without building UniValue tree.
+    // Output is the same as UniValue::write() for the equal pushKV sequence.
+    class SqlJsonWriter
+    {
+    public:
+        SqlJsonWriter();
+
+        void BeginArray();
+        void EndArray();
+
+        // Write current statement row as object - next element of opened array
+        void WriteRow(sqlite3_stmt* stmt, const SqlJsonSchema& schema);
+
+        string& Str() { return m_out; }
+
+        static void WriteString(string& out, const char* value, size_t size);
+
+    private:
+        string m_out;
+        vector<bool> m_first;
+
+        void NextElement();
+    };
+
+} // namespace PocketHelpers
+
+#endif // POCKETDB_SQLJSONWRITER_H
@@ -3,9 +3,60 @@
 // https://www.apache.org/licenses/LICENSE-2.0
 
 #include "pocketdb/helpers/TransactionHelper.h"
+#include "crypto/common.h"
 
 namespace PocketHelpers
 {
+    // OP_RETURN type markers decoded from hex constants at compile time
+    struct OpReturnTypeEntry
+    {
+        unsigned char Data[32] = {};
+        size_t Size = 0;
+        TxType Type = TxType::TX_DEFAULT;
+    };
+
+    static constexpr unsigned char HexDigit(char c)
+    {
+        return (unsigned char) (c >= 'a' ? c - 'a' + 10 : c - '0');
+    }
+
+    static constexpr OpReturnTypeEntry MakeOpReturnTypeEntry(const char* hex, TxType type)
+    {
+        OpReturnTypeEntry entry;
+        while (hex[entry.Size * 2] != 0)
+        {
+            entry.Data[entry.Size] = (unsigned char) ((HexDigit(hex[entry.Size * 2]) << 4) | HexDigit(hex[entry.Size * 2 + 1]));
+            entry.Size++;
+        }
+        entry.Type = type;
+        return entry;
+    }
+
+    // Same mapping as ConvertOpReturnToType(const string&)
+    static constexpr OpReturnTypeEntry OpReturnTypes[] = {
+        MakeOpReturnTypeEntry(OR_POST, TxType::CONTENT_POST),
+        MakeOpReturnTypeEntry(OR_POSTEDIT, TxType::CONTENT_POST),
+        MakeOpReturnTypeEntry(OR_VIDEO, TxType::CONTENT_VIDEO),
+        MakeOpReturnTypeEntry(OR_ARTICLE, TxType::CONTENT_ARTICLE),
+        MakeOpReturnTypeEntry(OR_CONTENT_BOOST, TxType::BOOST_CONTENT),
+        MakeOpReturnTypeEntry(OR_CONTENT_DELETE, TxType::CONTENT_DELETE),
+        MakeOpReturnTypeEntry(OR_SUBSCRIBE, TxType::ACTION_SUBSCRIBE),
+        MakeOpReturnTypeEntry(OR_SUBSCRIBEPRIVATE, TxType::ACTION_SUBSCRIBE_PRIVATE),
+        MakeOpReturnTypeEntry(OR_UNSUBSCRIBE, TxType::ACTION_SUBSCRIBE_CANCEL),
+        MakeOpReturnTypeEntry(OR_USERINFO, TxType::ACCOUNT_USER),
+        MakeOpReturnTypeEntry(OR_ACCOUNT_SETTING, TxType::ACCOUNT_SETTING),
+        MakeOpReturnTypeEntry(OR_ACCOUNT_DELETE, TxType::ACCOUNT_DELETE),
+        MakeOpReturnTypeEntry(OR_BLOCKING, TxType::ACTION_BLOCKING),
+        MakeOpReturnTypeEntry(OR_UNBLOCKING, TxType::ACTION_BLOCKING_CANCEL),
+        MakeOpReturnTypeEntry(OR_COMMENT, TxType::CONTENT_COMMENT),
+        MakeOpReturnTypeEntry(OR_COMMENT_EDIT, TxType::CONTENT_COMMENT_EDIT),
+        MakeOpReturnTypeEntry(OR_COMMENT_DELETE, TxType::CONTENT_COMMENT_DELETE),
+        MakeOpReturnTypeEntry(OR_COMMENT_SCORE, TxType::ACTION_SCORE_COMMENT),
+        MakeOpReturnTypeEntry(OR_SCORE, TxType::ACTION_SCORE_CONTENT),
+        MakeOpReturnTypeEntry(OR_COMPLAIN, TxType::ACTION_COMPLAIN),
+        MakeOpReturnTypeEntry(OR_MODERATION_FLAG, TxType::MODERATION_FLAG),
+    };
+
     txnouttype TransactionHelper::ScriptType(const CScript& scriptPubKey)
     {
         std::vector<std::vector<unsigned char>> vSolutions;
@@ -85,6 +136,63 @@ namespace PocketHelpers
         return TxType::TX_DEFAULT;
     }
 
+    TxType TransactionHelper::ConvertOpReturnToType(const unsigned char* data, size_t size)
+    {
+        for (const auto& entry : OpReturnTypes)
+            if (entry.Size == size && memcmp(entry.Data, data, size) == 0)
+                return entry.Type;
+
+        return TxType::TX_DEFAULT;
+    }
+
+    TxType TransactionHelper::ParseOpReturnType(const CScript& scriptPubKey)
+    {
+        // Equal to ParseAsmType + ConvertOpReturnToType without building asm string:
+        // type is the first push after OP_RETURN, pushes up to 4 bytes are
+        // written to asm as numbers and never match any type
+        if (scriptPubKey.empty() || scriptPubKey[0] != OP_RETURN)
+            return TxType::TX_DEFAULT;
+
+        auto pc = scriptPubKey.begin() + 1;
+        auto end = scriptPubKey.end();
+        if (pc >= end)
+            return TxType::TX_DEFAULT;
+
+        unsigned int opcode = *pc++;
+        size_t size = 0;
+        if (opcode < OP_PUSHDATA1)
+        {
+            size = opcode;
+        }
+        else if (opcode == OP_PUSHDATA1)
+        {
+            if (end - pc < 1) return TxType::TX_DEFAULT;
+            size = *pc;
+            pc += 1;
+        }
+        else if (opcode == OP_PUSHDATA2)
+        {
+            if (end - pc < 2) return TxType::TX_DEFAULT;
+            size = ReadLE16(&pc[0]);
+            pc += 2;
+        }
+        else if (opcode == OP_PUSHDATA4)
+        {
+            if (end - pc < 4) return TxType::TX_DEFAULT;
+            size = ReadLE32(&pc[0]);
+            pc += 4;
+        }
+        else
+        {
+            return TxType::TX_DEFAULT;
+        }
+
+        if (size <= 4 || (size_t) (end - pc) < size)
+            return TxType::TX_DEFAULT;
+
+        return ConvertOpReturnToType(&pc[0], size);
+    }
+
     string TransactionHelper::ParseAsmType(const CTransactionRef& tx, vector<string>& vasm)
     {
         if (tx->vout.empty())
@@ -123,8 +231,33 @@ namespace PocketHelpers
 
     TxType TransactionHelper::ParseType(const CTransactionRef& tx)
     {
-        vector<string> vasm;
-        return ParseType(tx, vasm);
+        return ParseType(*tx);
+    }
+
+    TxType TransactionHelper::ParseType(const CTransaction& tx)
+    {
+        if (int cached = tx.GetPocketType(); cached >= 0)
+            return (TxType) cached;
+
+        TxType type;
+        if (tx.IsCoinBase())
+        {
+            int txOutSum = std::accumulate(begin(tx.vout), end(tx.vout), 0,
+                [](int i, const CTxOut& o) { return o.nValue + i; });
+
+            type = txOutSum <= 0 ? TxType::NOT_SUPPORTED : TxType::TX_COINBASE;
+        }
+        else if (tx.IsCoinStake())
+        {
+            type = TxType::TX_COINSTAKE;
+        }
+        else
+        {
+            type = tx.vout.empty() ? TxType::TX_DEFAULT : ParseOpReturnType(tx.vout[0].scriptPubKey);
+        }
+
+        tx.SetPocketType((int) type);
+        return type;
     }
 
     string TransactionHelper::ConvertToReindexerTable(const Transaction& transaction)
@@ -205,8 +338,7 @@ namespace PocketHelpers
 
     bool TransactionHelper::IsPocketSupportedTransaction(const CTransaction& tx)
     {
-        auto txRef = MakeTransactionRef(tx);
-        return IsPocketSupportedTransaction(txRef);
+        return ParseType(tx) != NOT_SUPPORTED;
     }
 
     bool TransactionHelper::IsPocketTransaction(TxType& txType)
@@ -231,8 +363,8 @@ namespace PocketHelpers
 
     bool TransactionHelper::IsPocketTransaction(const CTransaction& tx)
     {
-        auto txRef = MakeTransactionRef(tx);
-        return IsPocketTransaction(txRef);
+        TxType txType = ParseType(tx);
+        return IsPocketTransaction(txType);
     }
 
     // TODO (o1q): Implement it for setting minimum fee for several PocketNet transactions
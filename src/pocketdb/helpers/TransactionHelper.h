@@ -64,9 +64,12 @@ namespace PocketHelpers
         static std::string ExtractDestination(const CScript& scriptPubKey);
         static tuple<bool, string> GetPocketAuthorAddress(const CTransactionRef& tx);
         static TxType ConvertOpReturnToType(const string& op);
+        static TxType ConvertOpReturnToType(const unsigned char* data, size_t size);
+        static TxType ParseOpReturnType(const CScript& scriptPubKey);
         static string ParseAsmType(const CTransactionRef& tx, vector<string>& vasm);
         static TxType ParseType(const CTransactionRef& tx, vector<string>& vasm);
         static TxType ParseType(const CTransactionRef& tx);
+        static TxType ParseType(const CTransaction& tx);
         static string ConvertToReindexerTable(const Transaction& transaction);
         static string ExtractOpReturnHash(const CTransactionRef& tx);
         static tuple<bool, string> ExtractOpReturnPayload(const CTransactionRef& tx);
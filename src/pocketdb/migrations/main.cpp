@@ -174,6 +174,24 @@ namespace PocketDb
             );
         )sql");
 
+        _tables.emplace_back(R"sql(
+            create table if not exists LastUndo
+            (
+                -- Height of block that cleared Last flag
+                Height      int     not null,
+                -- 0 - block indexed with undo records
+                -- 1 - Transactions, 2 - Ratings, 3 - Balances
+                Type        int     not null,
+                -- Transactions.Hash or Balances.AddressHash
+                Hash        text    null,
+                -- Ratings.Type & Ratings.Id
+                RatingType  int     null,
+                Id          int     null,
+                -- Height of previous Last record in Ratings or Balances
+                PrevHeight  int     null
+            );
+        )sql");
+
         _tables.emplace_back(R"sql(
             create table if not exists System
             (
@@ -256,6 +274,8 @@ namespace PocketDb
             create index if not exists Balances_Last_Value on Balances (Last, Value);
             create index if not exists Balances_AddressHash_Last on Balances (AddressHash, Last);
 
+            create index if not exists LastUndo_Type_Height on LastUndo (Type, Height);
+
         )sql";
 
         _postProcessing = R"sql(
@@ -42,6 +42,24 @@ namespace PocketDb
             );
         )sql");
 
+        // Ranked search index: ROWID = ContentId * 16 + FieldType so that rows are ordered
+        // by content id for keyset paging and can be deleted by ROWID range.
+        // Filter columns are stored unindexed and checked while walking the posting list.
+        _tables.emplace_back(R"sql(
+            create virtual table if not exists ContentSearch using fts5
+            (
+                Value,
+                ContentId unindexed,
+                FieldType unindexed,
+                TxType unindexed,
+                Height unindexed,
+                Lang unindexed,
+                Author unindexed,
+                prefix = '2 3',
+                tokenize = 'unicode61 remove_diacritics 2'
+            );
+        )sql");
+
         _tables.emplace_back(R"sql(
             create table if not exists Badges
             (
@@ -23,6 +23,10 @@ namespace PocketDbWeb
         string Address;
         bool OrderByRank = false;
 
+        // Ranked search only: language filter and keyset paging - return content with Id less than LastId
+        string Lang;
+        int64_t LastId = 0;
+
         vector<ContentFieldType> FieldTypes;
         vector<TxType> TxTypes;
 
@@ -13,12 +13,21 @@ namespace PocketDbWeb
     using namespace std;
     using namespace PocketTx;
 
+    // ROWID multiplier of ranked search index - FieldType must be less than this value
+    static const int64_t CONTENT_SEARCH_FIELDS = 16;
+
     struct WebContent
     {
         int64_t ContentId;
         ContentFieldType FieldType;
         string Value;
 
+        // Filter columns of ranked search index
+        TxType Type = TxType::NOT_SUPPORTED;
+        int Height = 0;
+        string Lang;
+        string Author;
+
         WebContent(int64_t contentId, ContentFieldType fieldType, const string& value)
         {
             ContentId = contentId;
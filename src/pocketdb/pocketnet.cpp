@@ -6,6 +6,9 @@
 
 namespace PocketDb
 {
+    SQLiteProfiler SQLiteProfilerInst;
+    AccountProfileCache AccountProfileCacheInst;
+    ConsensusCounters ConsensusCountersInst;
     SQLiteDatabase SQLiteDbInst(false);
     TransactionRepository TransRepoInst(SQLiteDbInst);
     ChainRepository ChainRepoInst(SQLiteDbInst);
@@ -26,4 +29,6 @@ namespace PocketWeb
 namespace PocketServices
 {
     WebPostProcessor WebPostProcessorInst;
+    WalCheckpointer WalCheckpointerInst;
+    MempoolWriter MempoolWriterInst(PocketDb::SQLiteDbInst, PocketDb::TransRepoInst);
 } // namespace PocketServices
\ No newline at end of file
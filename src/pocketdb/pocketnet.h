@@ -27,6 +27,8 @@
 
 #include "pocketdb/web/PocketFrontend.h"
 #include "pocketdb/services/WebPostProcessing.h"
+#include "pocketdb/services/WalCheckpoint.h"
+#include "pocketdb/services/MempoolWriter.h"
 
 namespace PocketDb
 {
@@ -45,6 +47,8 @@ namespace PocketDb
 namespace PocketServices
 {
     extern WebPostProcessor WebPostProcessorInst;
+    extern WalCheckpointer WalCheckpointerInst;
+    extern MempoolWriter MempoolWriterInst;
 } // namespace PocketServices
 
 namespace PocketWeb
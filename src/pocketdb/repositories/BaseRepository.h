@@ -63,13 +63,15 @@ namespace PocketDb
         template<typename T>
         void TryTransactionStep(const string& func, T sql)
         {
+            int64_t nTime1 = GetTimeMicros();
+
             try
             {
-                int64_t nTime1 = GetTimeMicros();
-
                 if (!m_database.BeginTransaction())
                     throw std::runtime_error(strprintf("%s: can't begin transaction\n", func));
 
+                m_database.m_profile_func = func;
+
                 // We are running SQL logic with timeout only for read-only connections
                 if (m_database.IsReadOnly())
                 {
@@ -98,10 +100,12 @@ namespace PocketDb
                 int64_t nTime2 = GetTimeMicros();
 
                 LogPrint(BCLog::SQLBENCH, "SQL Bench `%s`: %.2fms\n", func, 0.001 * (nTime2 - nTime1));
+                SQLiteProfilerInst.AddCall(func, nTime2 - nTime1, true);
             }
             catch (const std::exception& ex)
             {
                 m_database.AbortTransaction();
+                SQLiteProfilerInst.AddCall(func, GetTimeMicros() - nTime1, false);
                 throw std::runtime_error(func + ": " + ex.what());
             }
         }
@@ -52,6 +52,9 @@ namespace PocketDb
             // After set height and mark inputs as spent we need recalculcate balances
             IndexBalances(height);
 
+            // Mark block as indexed with undo records for fast rollback
+            IndexLastUndo(height);
+
             int64_t nTime3 = GetTimeMicros();
 
             LogPrint(BCLog::BENCH, "    - IndexBlock: %.2fms + %.2fms = %.2fms\n",
@@ -70,7 +73,8 @@ namespace PocketDb
         string sql = R"sql(
             select
                 ifnull((select 1 from Transactions where BlockHash = ? and Height = ? limit 1), 0)current,
-                ifnull((select 1 from Transactions where Height = ? limit 1), 0)next
+                ifnull((select 1 from Transactions where Height = ? limit 1), 0)next,
+                ifnull((select 1 from Transactions where Height = ? and BlockHash != ? limit 1), 0)stale
         )sql";
 
         TryTransactionStep(__func__, [&]()
@@ -79,6 +83,8 @@ namespace PocketDb
             TryBindStatementText(stmt, 1, blockHash);
             TryBindStatementInt(stmt, 2, height);
             TryBindStatementInt(stmt, 3, height + 1);
+            TryBindStatementInt(stmt, 4, height);
+            TryBindStatementText(stmt, 5, blockHash);
 
             if (sqlite3_step(*stmt) == SQLITE_ROW)
             {
@@ -87,6 +93,14 @@ namespace PocketDb
 
                 if (auto[ok, value] = TryGetColumnInt(*stmt, 1); ok && value == 1)
                     last = false;
+
+                // Rows of other block at this height are left by disconnect without rollback (node stopped
+                // before batched rollback) - reported as not existing and not last so that callers roll back
+                if (auto[ok, value] = TryGetColumnInt(*stmt, 2); ok && value == 1)
+                {
+                    exists = false;
+                    last = false;
+                }
             }
 
             FinalizeSqlStatement(*stmt);
@@ -95,6 +109,45 @@ namespace PocketDb
         return {exists, last};
     }
 
+    vector<int64_t> ChainRepository::GetAccountIdsByHeight(int height)
+    {
+        vector<int64_t> result;
+
+        // String2 & String3 hold target address for subscribes, blockings and flags - hashes just don't match
+        string sql = R"sql(
+            select u.Id
+            from Transactions t indexed by Transactions_Height_Type
+            cross join Transactions u indexed by Transactions_Type_Last_String1_Height_Id
+                on u.Type in (100, 170) and u.Last = 1 and u.String1 in (t.String1, t.String2, t.String3) and u.Height is not null
+            where t.Height = ?
+              and t.Type >= 100
+
+            union
+
+            select r.Id
+            from Ratings r indexed by Ratings_Height_Last
+            where r.Height = ?
+              and r.Type in (0, 111, 112, 113)
+        )sql";
+
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(sql);
+            TryBindStatementInt(stmt, 1, height);
+            TryBindStatementInt(stmt, 2, height);
+
+            while (sqlite3_step(*stmt) == SQLITE_ROW)
+            {
+                if (auto[ok, value] = TryGetColumnInt64(*stmt, 0); ok)
+                    result.push_back(value);
+            }
+
+            FinalizeSqlStatement(*stmt);
+        });
+
+        return result;
+    }
+
 
     void ChainRepository::UpdateTransactionHeight(const string& blockHash, int blockNumber, int height, const string& txHash)
     {
@@ -180,6 +233,24 @@ namespace PocketDb
         TryBindStatementInt(stmt, 3, height);
         TryStepStatement(stmt);
 
+        // Save old Last records for rollback
+        auto stmtUndo = SetupSqlStatement(R"sql(
+            insert into LastUndo (Height, Type, Hash, PrevHeight)
+            select ?, 3, b.AddressHash, b.Height
+            from Balances b indexed by Balances_AddressHash_Last_Height
+            where b.Last = 1
+              and b.Height < ?
+              and b.AddressHash in (
+                select bh.AddressHash
+                from Balances bh indexed by Balances_Height
+                where bh.Height = ?
+              )
+        )sql");
+        TryBindStatementInt(stmtUndo, 1, height);
+        TryBindStatementInt(stmtUndo, 2, height);
+        TryBindStatementInt(stmtUndo, 3, height);
+        TryStepStatement(stmtUndo);
+
         // Remove old Last records
         auto stmtOld = SetupSqlStatement(R"sql(
             update Balances indexed by Balances_AddressHash_Last_Height
@@ -498,7 +569,16 @@ namespace PocketDb
             // Update transactions
             TryTransactionStep(__func__, [&]()
             {
-                RestoreOldLast(height);
+                // Range already removed - for example, with rollback before disconnecting many blocks
+                if (!ExistsHeight(height))
+                    return;
+
+                // Blocks indexed before undo records were introduced (or pruned) require full scan
+                if (ExistsLastUndo(height))
+                    RestoreLastUndo(height);
+                else
+                    RestoreOldLast(height);
+
                 RollbackBlockingList(height);
                 RollbackHeight(height);
             });
@@ -514,6 +594,18 @@ namespace PocketDb
     
     void ChainRepository::ClearOldLast(const string& txHash)
     {
+        // Save old Last records for rollback
+        auto stmtUndo = SetupSqlStatement(R"sql(
+            insert into LastUndo (Height, Type, Hash)
+            select tInner.Height, 1, t.Hash
+            from Transactions tInner
+            join Transactions t indexed by Transactions_Id_Last
+              on t.Id = tInner.Id and t.Last = 1 and t.Hash != tInner.Hash
+            where tInner.Hash = ?
+        )sql");
+        TryBindStatementText(stmtUndo, 1, txHash);
+        TryStepStatement(stmtUndo);
+
         auto stmt = SetupSqlStatement(R"sql(
             UPDATE Transactions indexed by Transactions_Id_Last SET
                 Last = 0
@@ -621,6 +713,139 @@ namespace PocketDb
         LogPrint(BCLog::BENCH, "        - RestoreOldLast (Balances): %.2fms\n", 0.001 * (nTime3 - nTime2));
     }
 
+    bool ChainRepository::ExistsHeight(int height)
+    {
+        bool result = false;
+
+        auto stmt = SetupSqlStatement(R"sql(
+            select
+                exists(select 1 from Transactions indexed by Transactions_Height_Id where Height >= ?) or
+                exists(select 1 from Ratings indexed by Ratings_Height_Last where Height >= ?) or
+                exists(select 1 from Balances indexed by Balances_Height where Height >= ?) or
+                exists(select 1 from TxOutputs indexed by TxOutputs_SpentHeight_AddressHash where SpentHeight >= ?)
+        )sql");
+        TryBindStatementInt(stmt, 1, height);
+        TryBindStatementInt(stmt, 2, height);
+        TryBindStatementInt(stmt, 3, height);
+        TryBindStatementInt(stmt, 4, height);
+
+        if (sqlite3_step(*stmt) == SQLITE_ROW)
+            if (auto[ok, value] = TryGetColumnInt(*stmt, 0); ok && value == 1)
+                result = true;
+
+        FinalizeSqlStatement(*stmt);
+        return result;
+    }
+
+    bool ChainRepository::ExistsLastUndo(int height)
+    {
+        bool result = false;
+
+        // Undo records are complete for all blocks above first marked block
+        auto stmt = SetupSqlStatement(R"sql(
+            select 1
+            from LastUndo indexed by LastUndo_Type_Height
+            where Type = 0
+              and Height <= ?
+            limit 1
+        )sql");
+        TryBindStatementInt(stmt, 1, height);
+
+        if (sqlite3_step(*stmt) == SQLITE_ROW)
+            result = true;
+
+        FinalizeSqlStatement(*stmt);
+        return result;
+    }
+
+    void ChainRepository::IndexLastUndo(int height)
+    {
+        auto stmt = SetupSqlStatement(R"sql(
+            insert into LastUndo (Height, Type) values (?, 0)
+        )sql");
+        TryBindStatementInt(stmt, 1, height);
+        TryStepStatement(stmt);
+
+        // Keep undo records only for the last blocks
+        auto stmtPrune = SetupSqlStatement(R"sql(
+            delete from LastUndo indexed by LastUndo_Type_Height
+            where Type in (0, 1, 2, 3)
+              and Height < ?
+        )sql");
+        TryBindStatementInt(stmtPrune, 1, height - (int) gArgs.GetArg("-sqlundodepth", 1440));
+        TryStepStatement(stmtPrune);
+    }
+
+    void ChainRepository::RestoreLastUndo(int height)
+    {
+        int64_t nTime0 = GetTimeMicros();
+
+        // ----------------------------------------
+        // Restore old Last transactions
+        auto stmt1 = SetupSqlStatement(R"sql(
+            update Transactions
+                set Last = 1
+            where Hash in (
+                select u.Hash
+                from LastUndo u indexed by LastUndo_Type_Height
+                where u.Type = 1
+                  and u.Height >= ?
+            )
+            and Height < ?
+        )sql");
+        TryBindStatementInt(stmt1, 1, height);
+        TryBindStatementInt(stmt1, 2, height);
+        TryStepStatement(stmt1);
+
+        int64_t nTime1 = GetTimeMicros();
+        LogPrint(BCLog::BENCH, "        - RestoreLastUndo (Transactions): %.2fms\n", 0.001 * (nTime1 - nTime0));
+
+        // ----------------------------------------
+        // Restore Last for deleting ratings
+        auto stmt2 = SetupSqlStatement(R"sql(
+            update Ratings indexed by Ratings_Type_Id_Height_Value
+                set Last = 1
+            from (
+                select u.RatingType, u.Id, u.PrevHeight
+                from LastUndo u indexed by LastUndo_Type_Height
+                where u.Type = 2
+                  and u.Height >= ?
+                  and u.PrevHeight < ?
+            )u
+            where Ratings.Type = u.RatingType
+              and Ratings.Id = u.Id
+              and Ratings.Height = u.PrevHeight
+        )sql");
+        TryBindStatementInt(stmt2, 1, height);
+        TryBindStatementInt(stmt2, 2, height);
+        TryStepStatement(stmt2);
+
+        int64_t nTime2 = GetTimeMicros();
+        LogPrint(BCLog::BENCH, "        - RestoreLastUndo (Ratings): %.2fms\n", 0.001 * (nTime2 - nTime1));
+
+        // ----------------------------------------
+        // Restore Last for deleting balances
+        auto stmt3 = SetupSqlStatement(R"sql(
+            update Balances
+                set Last = 1
+            from (
+                select u.Hash, u.PrevHeight
+                from LastUndo u indexed by LastUndo_Type_Height
+                where u.Type = 3
+                  and u.Height >= ?
+                  and u.PrevHeight < ?
+            )u
+            where Balances.AddressHash = u.Hash
+              and Balances.Height = u.PrevHeight
+        )sql");
+        TryBindStatementInt(stmt3, 1, height);
+        TryBindStatementInt(stmt3, 2, height);
+        TryStepStatement(stmt3);
+
+        int64_t nTime3 = GetTimeMicros();
+        LogPrint(BCLog::BENCH, "        - RestoreLastUndo (Balances): %.2fms\n", 0.001 * (nTime3 - nTime2));
+    }
+
     void ChainRepository::RollbackHeight(int height)
     {
         int64_t nTime0 = GetTimeMicros();
@@ -692,6 +917,18 @@ namespace PocketDb
 
         int64_t nTime5 = GetTimeMicros();
         LogPrint(BCLog::BENCH, "        - RollbackHeight (Balances delete): %.2fms\n", 0.001 * (nTime5 - nTime4));
+
+        // ----------------------------------------
+        // Remove undo records
+        auto stmt6 = SetupSqlStatement(R"sql(
+            delete from LastUndo
+            where Height >= ?
+        )sql");
+        TryBindStatementInt(stmt6, 1, height);
+        TryStepStatement(stmt6);
+
+        int64_t nTime6 = GetTimeMicros();
+        LogPrint(BCLog::BENCH, "        - RollbackHeight (LastUndo delete): %.2fms\n", 0.001 * (nTime6 - nTime5));
     }
 
     void ChainRepository::RollbackBlockingList(int height)
@@ -43,11 +43,15 @@ namespace PocketDb
         bool ClearDatabase();
 
         // Erase all calculated data great or equals block
+        // Rollback of many blocks in one call is much cheaper than block by block
         bool Rollback(int height);
 
         // Check block exist in db
         tuple<bool, bool> ExistsBlock(const string& blockHash, int height);
 
+        // Accounts affected by block - authors and targets of transactions, changed ratings
+        vector<int64_t> GetAccountIdsByHeight(int height);
+
     private:
 
         void RollbackBlockingList(int height);
@@ -55,6 +59,11 @@ namespace PocketDb
         void RollbackHeight(int height);
         void RestoreOldLast(int height);
 
+        bool ExistsHeight(int height);
+        bool ExistsLastUndo(int height);
+        void RestoreLastUndo(int height);
+        void IndexLastUndo(int height);
+
         void UpdateTransactionHeight(const string& blockHash, int blockNumber, int height, const string& txHash);
         void UpdateTransactionOutputs(const TransactionIndexingInfo& txInfo, int height);
 
@@ -0,0 +1,162 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/repositories/ConsensusCounters.h"
+#include "pocketdb/pocketnet.h"
+
+namespace PocketDb
+{
+    // Twice the largest height window of social limits (ConsensusLimit_depth)
+    static const int CONSENSUS_COUNTERS_DEPTH = 2880;
+
+    // Old heights are dropped in batches
+    static const int CONSENSUS_COUNTERS_PRUNE_STEP = 100;
+
+    bool ConsensusCounters::IsCounted(TxType type)
+    {
+        switch (type)
+        {
+            case ACCOUNT_USER:
+            case CONTENT_POST:
+            case CONTENT_VIDEO:
+            case CONTENT_ARTICLE:
+            case ACTION_SCORE_CONTENT:
+            case ACTION_SCORE_COMMENT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool ConsensusCounters::CountChain(TxType type, const string& address, int height, bool originals, int& count)
+    {
+        LOCK(m_mutex);
+
+        if (m_tip < 0 || (height < m_from && m_from > 0))
+            return false;
+
+        count = 0;
+
+        auto itAddress = m_counts.find(address);
+        if (itAddress == m_counts.end())
+            return true;
+
+        auto itType = itAddress->second.find((int) type);
+        if (itType == itAddress->second.end())
+            return true;
+
+        const auto& counts = itType->second;
+        for (auto it = counts.rbegin(); it != counts.rend() && it->Height >= height; it++)
+            count += originals ? it->Originals : it->All;
+
+        return true;
+    }
+
+    void ConsensusCounters::Index(int height)
+    {
+        LOCK(m_mutex);
+
+        try
+        {
+            // Not sequential indexing (startup, reindex, failures) - reload window
+            if (m_tip < 0 || height != m_tip + 1)
+            {
+                Reset();
+                m_from = max(0, height - CONSENSUS_COUNTERS_DEPTH + 1);
+                Load(m_from, height);
+                m_tip = height;
+                return;
+            }
+
+            Load(height, height);
+            m_tip = height;
+        }
+        catch (...)
+        {
+            Reset();
+            throw;
+        }
+
+        if (m_tip - m_from >= CONSENSUS_COUNTERS_DEPTH + CONSENSUS_COUNTERS_PRUNE_STEP)
+            Prune();
+    }
+
+    void ConsensusCounters::Rollback(int height)
+    {
+        LOCK(m_mutex);
+
+        if (m_tip < 0 || height > m_tip)
+            return;
+
+        if (height <= m_from)
+        {
+            Reset();
+            return;
+        }
+
+        for (auto itAddress = m_counts.begin(); itAddress != m_counts.end();)
+        {
+            auto& types = itAddress->second;
+            for (auto itType = types.begin(); itType != types.end();)
+            {
+                auto& counts = itType->second;
+                while (!counts.empty() && counts.back().Height >= height)
+                    counts.pop_back();
+
+                itType = counts.empty() ? types.erase(itType) : next(itType);
+            }
+
+            itAddress = types.empty() ? m_counts.erase(itAddress) : next(itAddress);
+        }
+
+        m_tip = height - 1;
+    }
+
+    void ConsensusCounters::Clear()
+    {
+        LOCK(m_mutex);
+        Reset();
+    }
+
+    void ConsensusCounters::Load(int fromHeight, int toHeight)
+    {
+        for (const auto&[address, type, height, original] : ConsensusRepoInst.GetCountersData(fromHeight, toHeight))
+        {
+            auto& counts = m_counts[address][type];
+            if (counts.empty() || counts.back().Height != height)
+                counts.push_back({ height, 0, 0 });
+
+            counts.back().All += 1;
+            counts.back().Originals += original ? 1 : 0;
+        }
+    }
+
+    void ConsensusCounters::Prune()
+    {
+        m_from = m_tip - CONSENSUS_COUNTERS_DEPTH + 1;
+
+        for (auto itAddress = m_counts.begin(); itAddress != m_counts.end();)
+        {
+            auto& types = itAddress->second;
+            for (auto itType = types.begin(); itType != types.end();)
+            {
+                auto& counts = itType->second;
+                while (!counts.empty() && counts.front().Height < m_from)
+                    counts.pop_front();
+
+                itType = counts.empty() ? types.erase(itType) : next(itType);
+            }
+
+            itAddress = types.empty() ? m_counts.erase(itAddress) : next(itAddress);
+        }
+    }
+
+    void ConsensusCounters::Reset()
+    {
+        m_counts.clear();
+        m_from = -1;
+        m_tip = -1;
+    }
+
+} // namespace PocketDb
@@ -0,0 +1,70 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_CONSENSUS_COUNTERS_H
+#define POCKETDB_CONSENSUS_COUNTERS_H
+
+#include <deque>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "pocketdb/models/base/PocketTypes.h"
+#include "sync.h"
+
+namespace PocketDb
+{
+    using namespace std;
+    using namespace PocketTx;
+
+    // Address, type, height and "original content" flag of transaction in chain
+    typedef vector<tuple<string, int, int, bool>> ConsensusCountersData;
+
+    // Chain counts of social transactions by address for last blocks.
+    // Social limits count transactions of address since some height - counts are
+    // kept per height and updated with every indexed or rolled back block,
+    // so limit checks do not query database. Counters are loaded from database
+    // with the first indexed block and reloaded whenever indexing is not sequential.
+    class ConsensusCounters
+    {
+    public:
+        // Types counted by height windows
+        static bool IsCounted(TxType type);
+
+        // Count of transactions of address with height >= height.
+        // Returns false if window is not covered by counters - caller counts in database.
+        bool CountChain(TxType type, const string& address, int height, bool originals, int& count);
+
+        void Index(int height);
+        void Rollback(int height);
+        void Clear();
+
+    private:
+        struct HeightCount
+        {
+            int Height;
+            int All;
+            int Originals;
+        };
+
+        Mutex m_mutex;
+
+        // Counters cover all transactions with height in [m_from, m_tip], m_tip < 0 - not loaded
+        int m_from = -1;
+        int m_tip = -1;
+
+        // Ascending per height counts by address and type
+        unordered_map<string, unordered_map<int, deque<HeightCount>>> m_counts;
+
+        void Load(int fromHeight, int toHeight);
+        void Prune();
+        void Reset();
+    };
+
+    extern ConsensusCounters ConsensusCountersInst;
+
+} // namespace PocketDb
+
+#endif // POCKETDB_CONSENSUS_COUNTERS_H
@@ -1015,6 +1015,41 @@ namespace PocketDb
 
     // Mempool counts
 
+    ConsensusCountersData ConsensusRepository::GetCountersData(int fromHeight, int toHeight)
+    {
+        ConsensusCountersData result;
+
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(R"sql(
+                select String1, Type, Height, (Hash = String2)
+                from Transactions indexed by Transactions_Height_Type
+                where Height between ? and ?
+                  and Type in (100, 200, 201, 202, 300, 301)
+                  and String1 is not null
+                order by Height
+            )sql");
+
+            TryBindStatementInt(stmt, 1, fromHeight);
+            TryBindStatementInt(stmt, 2, toHeight);
+
+            while (sqlite3_step(*stmt) == SQLITE_ROW)
+            {
+                auto[ok0, address] = TryGetColumnString(*stmt, 0);
+                auto[ok1, type] = TryGetColumnInt(*stmt, 1);
+                auto[ok2, height] = TryGetColumnInt(*stmt, 2);
+                auto[ok3, original] = TryGetColumnInt(*stmt, 3);
+
+                if (ok0 && ok1 && ok2)
+                    result.emplace_back(address, type, height, ok3 && original == 1);
+            }
+
+            FinalizeSqlStatement(*stmt);
+        });
+
+        return result;
+    }
+
     int ConsensusRepository::CountMempoolBlocking(const string& address, const string& addressTo)
     {
         int result = 0;
@@ -1294,6 +1329,9 @@ namespace PocketDb
     {
         int result = 0;
 
+        if (ConsensusCountersInst.CountChain(CONTENT_POST, address, height, true, result))
+            return result;
+
         TryTransactionStep(__func__, [&]()
         {
             auto stmt = SetupSqlStatement(R"sql(
@@ -1348,6 +1386,9 @@ namespace PocketDb
     {
         int result = 0;
 
+        if (ConsensusCountersInst.CountChain(CONTENT_VIDEO, address, height, true, result))
+            return result;
+
         TryTransactionStep(__func__, [&]()
         {
             auto stmt = SetupSqlStatement(R"sql(
@@ -1402,6 +1443,9 @@ namespace PocketDb
     {
         int result = 0;
 
+        if (ConsensusCountersInst.CountChain(CONTENT_ARTICLE, address, height, true, result))
+            return result;
+
         TryTransactionStep(__func__, [&]()
         {
             auto stmt = SetupSqlStatement(R"sql(
@@ -1482,6 +1526,9 @@ namespace PocketDb
     {
         int result = 0;
 
+        if (ConsensusCountersInst.CountChain(ACTION_SCORE_COMMENT, address, height, false, result))
+            return result;
+
         TryTransactionStep(__func__, [&]()
         {
             auto stmt = SetupSqlStatement(R"sql(
@@ -1562,6 +1609,9 @@ namespace PocketDb
     {
         int result = 0;
 
+        if (ConsensusCountersInst.CountChain(ACTION_SCORE_CONTENT, address, height, false, result))
+            return result;
+
         TryTransactionStep(__func__, [&]()
         {
             auto stmt = SetupSqlStatement(R"sql(
@@ -1643,6 +1693,9 @@ namespace PocketDb
     {
         int result = 0;
 
+        if (ConsensusCounters::IsCounted(txType) && ConsensusCountersInst.CountChain(txType, address, height, false, result))
+            return result;
+
         TryTransactionStep(__func__, [&]()
         {
             auto stmt = SetupSqlStatement(R"sql(
@@ -9,6 +9,7 @@
 
 #include "pocketdb/helpers/TransactionHelper.h"
 #include "pocketdb/repositories/BaseRepository.h"
+#include "pocketdb/repositories/ConsensusCounters.h"
 #include "pocketdb/repositories/TransactionRepository.h"
 
 #include <boost/algorithm/string/join.hpp>
@@ -123,6 +124,9 @@ namespace PocketDb
         bool ExistsInMempool(const string& string1, const string& string2, const vector<TxType>& types);
         bool ExistsNotDeleted(const string& txHash, const string& address, const vector<TxType>& types);
 
+        // Counted by height windows transactions of chain for ConsensusCounters
+        ConsensusCountersData GetCountersData(int fromHeight, int toHeight);
+
         // get counts in "mempool" - Height is null
         int CountMempoolBlocking(const string& address, const string& addressTo);
         int CountMempoolSubscribe(const string& address, const string& addressTo);
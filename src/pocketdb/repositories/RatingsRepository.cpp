@@ -89,6 +89,22 @@ namespace PocketDb
             TryBindStatementInt64(stmt, 7, rating.GetValue());
             TryStepStatement(stmt);
 
+            // Save old Last record for rollback
+            auto stmtUndo = SetupSqlStatement(R"sql(
+                insert into LastUndo (Height, Type, RatingType, Id, PrevHeight)
+                select ?, 2, r.Type, r.Id, r.Height
+                from Ratings r indexed by Ratings_Type_Id_Last_Height
+                where r.Type = ?
+                  and r.Last = 1
+                  and r.Id = ?
+                  and r.Height < ?
+            )sql");
+            TryBindStatementInt(stmtUndo, 1, rating.GetHeight());
+            TryBindStatementInt(stmtUndo, 2, *rating.GetType());
+            TryBindStatementInt64(stmtUndo, 3, rating.GetId());
+            TryBindStatementInt(stmtUndo, 4, rating.GetHeight());
+            TryStepStatement(stmtUndo);
+
             // Clear old Last record
             auto stmtUpdate = SetupSqlStatement(R"sql(
                 update Ratings indexed by Ratings_Type_Id_Last_Height
@@ -458,6 +458,62 @@ namespace PocketDb
         });
     }
 
+    void TransactionRepository::CleanTransactions(const vector<string>& hashes)
+    {
+        // Keep number of variables in statement under SQLite limit
+        const size_t chunkSize = 500;
+
+        TryTransactionStep(__func__, [&]()
+        {
+            for (size_t begin = 0; begin < hashes.size(); begin += chunkSize)
+            {
+                size_t end = min(hashes.size(), begin + chunkSize);
+                string txReplacers = join(vector<string>(end - begin, "?"), ",");
+
+                const auto bindHashes = [&](shared_ptr<sqlite3_stmt*>& stmt)
+                {
+                    for (size_t i = begin; i < end; i++)
+                        TryBindStatementText(stmt, (int)(i - begin + 1), hashes[i]);
+                };
+
+                // Clear Payload table
+                auto stmt = SetupSqlStatement(R"sql(
+                    delete from Payload
+                    where TxHash in (
+                      select t.Hash
+                      from Transactions t
+                      where t.Hash in ( )sql" + txReplacers + R"sql( )
+                        and t.Height isnull
+                    )
+                )sql");
+                bindHashes(stmt);
+                TryStepStatement(stmt);
+
+                // Clear TxOutputs table
+                stmt = SetupSqlStatement(R"sql(
+                    delete from TxOutputs
+                    where TxHash in (
+                      select t.Hash
+                      from Transactions t
+                      where t.Hash in ( )sql" + txReplacers + R"sql( )
+                        and t.Height isnull
+                    )
+                )sql");
+                bindHashes(stmt);
+                TryStepStatement(stmt);
+
+                // Clear Transactions table
+                stmt = SetupSqlStatement(R"sql(
+                    delete from Transactions
+                    where Hash in ( )sql" + txReplacers + R"sql( )
+                      and Height isnull
+                )sql");
+                bindHashes(stmt);
+                TryStepStatement(stmt);
+            }
+        });
+    }
+
     void TransactionRepository::CleanMempool()
     {
         TryTransactionStep(__func__, [&]()
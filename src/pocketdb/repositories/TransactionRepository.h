@@ -43,6 +43,7 @@ namespace PocketDb
         int MempoolCount();
 
         void CleanTransaction(const string& hash);
+        void CleanTransactions(const vector<string>& hashes);
         void CleanMempool();
         void Clean();
 
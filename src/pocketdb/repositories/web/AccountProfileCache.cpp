@@ -0,0 +1,115 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/repositories/web/AccountProfileCache.h"
+#include "util.h"
+
+namespace PocketDb
+{
+    // Reads older than this number of versions are never cached
+    static const int64_t PROFILE_CACHE_TOUCHED_DEPTH = 100;
+
+    int64_t AccountProfileCache::Version()
+    {
+        LOCK(m_mutex);
+        return m_version;
+    }
+
+    bool AccountProfileCache::Get(int64_t id, UniValue& profile)
+    {
+        LOCK(m_mutex);
+
+        auto it = m_profiles.find(id);
+        if (it == m_profiles.end())
+            return false;
+
+        profile = it->second.Profile;
+        return true;
+    }
+
+    bool AccountProfileCache::Get(const string& address, int64_t& id, UniValue& profile)
+    {
+        LOCK(m_mutex);
+
+        auto itId = m_ids.find(address);
+        auto it = itId != m_ids.end() ? m_profiles.find(itId->second) : m_profiles.end();
+        if (it == m_profiles.end())
+            return false;
+
+        id = it->first;
+        profile = it->second.Profile;
+        return true;
+    }
+
+    bool AccountProfileCache::IsStale(int64_t id, int64_t version) const
+    {
+        if (version < m_clearVersion || version < m_pruneVersion)
+            return true;
+
+        auto it = m_touched.find(id);
+        return it != m_touched.end() && it->second > version;
+    }
+
+    void AccountProfileCache::Put(int64_t id, const string& address, const UniValue& profile, int64_t version)
+    {
+        static const size_t maxSize = (size_t) gArgs.GetArg("-rpcprofilecachesize", 20000);
+
+        LOCK(m_mutex);
+
+        if (IsStale(id, version))
+            return;
+
+        // Hot authors are cached again quickly - simply start over when full
+        if (m_profiles.size() >= maxSize)
+        {
+            m_profiles.clear();
+            m_ids.clear();
+        }
+
+        m_profiles.insert_or_assign(id, Entry{ address, profile });
+        m_ids.insert_or_assign(address, id);
+    }
+
+    void AccountProfileCache::Invalidate(const vector<int64_t>& ids)
+    {
+        LOCK(m_mutex);
+
+        m_version += 1;
+
+        for (int64_t id : ids)
+        {
+            if (auto it = m_profiles.find(id); it != m_profiles.end())
+            {
+                m_ids.erase(it->second.Address);
+                m_profiles.erase(it);
+            }
+
+            m_touched[id] = m_version;
+        }
+
+        // Forget old invalidations - reads started before are not cached anymore
+        m_pruneVersion = m_version - PROFILE_CACHE_TOUCHED_DEPTH;
+        for (auto it = m_touched.begin(); it != m_touched.end();)
+            it = it->second < m_pruneVersion ? m_touched.erase(it) : next(it);
+    }
+
+    void AccountProfileCache::Clear()
+    {
+        LOCK(m_mutex);
+
+        m_version += 1;
+        m_clearVersion = m_version;
+
+        m_profiles.clear();
+        m_ids.clear();
+        m_touched.clear();
+    }
+
+    bool AccountProfileCache::Empty()
+    {
+        LOCK(m_mutex);
+        return m_profiles.empty();
+    }
+
+} // namespace PocketDb
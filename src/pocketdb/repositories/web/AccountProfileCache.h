@@ -0,0 +1,62 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_ACCOUNT_PROFILE_CACHE_H
+#define POCKETDB_ACCOUNT_PROFILE_CACHE_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <univalue.h>
+#include "sync.h"
+
+namespace PocketDb
+{
+    using namespace std;
+
+    // Short form account profiles shared by all web RPC connections.
+    // Version is increased for every indexed or rolled back block and entries
+    // of accounts touched by the block are dropped. Readers take Version()
+    // before reading the database - a profile read from an older snapshot
+    // is not cached if its account was touched after that version.
+    class AccountProfileCache
+    {
+    public:
+        int64_t Version();
+
+        bool Get(int64_t id, UniValue& profile);
+        bool Get(const string& address, int64_t& id, UniValue& profile);
+        void Put(int64_t id, const string& address, const UniValue& profile, int64_t version);
+
+        void Invalidate(const vector<int64_t>& ids);
+        void Clear();
+        bool Empty();
+
+    private:
+        struct Entry
+        {
+            string Address;
+            UniValue Profile;
+        };
+
+        Mutex m_mutex;
+        int64_t m_version = 0;
+        int64_t m_clearVersion = 0;
+        int64_t m_pruneVersion = 0;
+
+        unordered_map<int64_t, Entry> m_profiles;
+        unordered_map<string, int64_t> m_ids;
+        // Version of last invalidation by account id - only for the last versions
+        map<int64_t, int64_t> m_touched;
+
+        bool IsStale(int64_t id, int64_t version) const;
+    };
+
+    extern AccountProfileCache AccountProfileCacheInst;
+
+} // namespace PocketDb
+
+#endif // POCKETDB_ACCOUNT_PROFILE_CACHE_H
@@ -50,6 +50,9 @@ namespace PocketDb
         if (request.Keyword.empty())
             return ids;
 
+        if (gArgs.GetBoolArg("-searchranked", false))
+            return SearchIdsRanked(request);
+
         // First search request
         string fieldTypes = join(request.FieldTypes | transformed(static_cast<std::string(*)(int)>(std::to_string)), ",");
         string txTypes = join(request.TxTypes | transformed(static_cast<std::string(*)(int)>(std::to_string)), ",");
@@ -105,6 +108,149 @@ namespace PocketDb
         return ids;
     }
 
+    // FTS5 query for keyword: exact phrase or all words with prefix match of the last one.
+    // Words are quoted so that user input can not break query syntax.
+    static string BuildMatchQuery(const string& keyword)
+    {
+        const auto quote = [](const string& str)
+        {
+            string result = "\"";
+            for (char c : str)
+            {
+                if (c == '"') result += '"';
+                result += c;
+            }
+            return result + "\"";
+        };
+
+        vector<string> words;
+        boost::split(words, keyword, boost::is_any_of("\t "), boost::token_compress_on);
+        words.erase(remove(words.begin(), words.end(), ""), words.end());
+
+        string prefix;
+        for (size_t i = 0; i < words.size(); i++)
+            prefix += (i > 0 ? " " : "") + quote(words[i]) + (i + 1 == words.size() ? "*" : "");
+
+        return quote(keyword) + " OR (" + prefix + ")";
+    }
+
+    vector<int64_t> SearchRepository::SearchIdsRanked(const SearchRequest& request)
+    {
+        auto func = __func__;
+        vector<int64_t> ids;
+
+        string keyword = request.Keyword;
+        boost::trim(keyword);
+        if (keyword.empty())
+            return ids;
+
+        // Ranked mode scores only the most recent matches so that popular words
+        // do not sort the whole posting list
+        int window = (int) gArgs.GetArg("-searchrankwindow", 5000);
+
+        string fieldTypes = join(request.FieldTypes | transformed(static_cast<std::string(*)(int)>(std::to_string)), ",");
+        string txTypes = join(request.TxTypes | transformed(static_cast<std::string(*)(int)>(std::to_string)), ",");
+
+        // Filters are checked on unindexed columns while walking posting list in ROWID order
+        string filters = " and cs.FieldType in ( " + fieldTypes + " ) and cs.TxType in ( " + txTypes + " ) ";
+        if (request.TopBlock > 0) filters += " and cs.Height <= ? ";
+        if (!request.Lang.empty()) filters += " and cs.Lang = ? ";
+        if (!request.Address.empty()) filters += " and cs.Author = ? ";
+        if (request.LastId > 0) filters += " and cs.ROWID < ? ";
+
+        // Content can be deleted or changed after indexing - check last state for found rows only
+        string sql;
+        if (request.OrderByRank)
+        {
+            sql = R"sql(
+                select s.ContentId
+                from (
+                    select cs.ContentId, cs.Height, cs.rank as Rank
+                    from web.ContentSearch cs
+                    where cs.Value match ?
+                        )sql" + filters + R"sql(
+                    order by cs.ROWID desc
+                    limit ?
+                ) s
+                cross join Transactions t indexed by Transactions_Last_Id_Height
+                    on t.Last = 1 and t.Id = s.ContentId and t.Height is not null
+                where t.Type in ( )sql" + txTypes + R"sql( )
+                group by s.ContentId
+                order by min(s.Rank / (1.0 + max(? - s.Height, 0) / 43200.0)), s.ContentId desc
+                limit ?
+                offset ?
+            )sql";
+        }
+        else
+        {
+            sql = R"sql(
+                select cs.ContentId
+                from web.ContentSearch cs
+                cross join Transactions t indexed by Transactions_Last_Id_Height
+                    on t.Last = 1 and t.Id = cs.ContentId and t.Height is not null
+                where cs.Value match ?
+                    )sql" + filters + R"sql(
+                    and t.Type in ( )sql" + txTypes + R"sql( )
+                order by cs.ROWID desc
+            )sql";
+        }
+
+        TryTransactionStep(func, [&]()
+        {
+            auto stmt = SetupSqlStatement(sql);
+
+            int i = 1;
+            TryBindStatementText(stmt, i++, BuildMatchQuery(keyword));
+            if (request.TopBlock > 0)
+                TryBindStatementInt(stmt, i++, request.TopBlock);
+            if (!request.Lang.empty())
+                TryBindStatementText(stmt, i++, request.Lang);
+            if (!request.Address.empty())
+                TryBindStatementText(stmt, i++, request.Address);
+            if (request.LastId > 0)
+                TryBindStatementInt64(stmt, i++, request.LastId * CONTENT_SEARCH_FIELDS);
+
+            if (request.OrderByRank)
+            {
+                TryBindStatementInt(stmt, i++, window);
+                TryBindStatementInt(stmt, i++, request.TopBlock);
+                TryBindStatementInt(stmt, i++, request.PageSize);
+                TryBindStatementInt(stmt, i++, request.PageStart);
+
+                while (sqlite3_step(*stmt) == SQLITE_ROW)
+                {
+                    if (auto[ok, value] = TryGetColumnInt64(*stmt, 0); ok)
+                        ids.push_back(value);
+                }
+            }
+            else
+            {
+                // Rows of one content are adjacent - stop walking posting list as soon as page is collected
+                int skip = request.PageStart;
+                int64_t prevId = -1;
+                while ((int) ids.size() < request.PageSize && sqlite3_step(*stmt) == SQLITE_ROW)
+                {
+                    auto[ok, value] = TryGetColumnInt64(*stmt, 0);
+                    if (!ok || value == prevId)
+                        continue;
+
+                    prevId = value;
+                    if (skip > 0)
+                    {
+                        skip--;
+                        continue;
+                    }
+
+                    ids.push_back(value);
+                }
+            }
+
+            FinalizeSqlStatement(*stmt);
+        });
+
+        return ids;
+    }
+
     vector<int64_t> SearchRepository::SearchUsersOld(const SearchRequest& request)
     {
         auto func = __func__;
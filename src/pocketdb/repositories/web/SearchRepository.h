@@ -11,6 +11,7 @@
 #include "core_io.h"
 
 #include "pocketdb/models/web/SearchRequest.h"
+#include "pocketdb/models/web/WebContent.h"
 #include "pocketdb/repositories/BaseRepository.h"
 
 namespace PocketDb
@@ -30,6 +31,7 @@ namespace PocketDb
 
         UniValue SearchTags(const SearchRequest& request);
         vector<int64_t> SearchIds(const SearchRequest& request);
+        vector<int64_t> SearchIdsRanked(const SearchRequest& request);
 
         vector<int64_t> SearchUsersOld(const SearchRequest& request);
         vector<int64_t> SearchUsers(const string& keyword);
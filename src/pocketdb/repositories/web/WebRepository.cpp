@@ -117,7 +117,9 @@ namespace PocketDb
                 p.String4,
                 p.String5,
                 p.String6,
-                p.String7
+                p.String7,
+                t.Height,
+                t.String1
             from Transactions t indexed by Transactions_BlockHash
             join Payload p on p.TxHash = t.Hash
             where t.BlockHash = ?
@@ -136,6 +138,8 @@ namespace PocketDb
                 if (!okType || !okId)
                     continue;
 
+                size_t rowFirst = result.size();
+
                 switch ((TxType)type)
                 {
                 case ACCOUNT_USER:
@@ -189,6 +193,18 @@ namespace PocketDb
                 default:
                     break;
                 }
+
+                // Filter columns for ranked search
+                auto[okLang, lang] = TryGetColumnString(*stmt, 2);
+                auto[okHeight, height] = TryGetColumnInt(*stmt, 9);
+                auto[okAuthor, author] = TryGetColumnString(*stmt, 10);
+                for (size_t i = rowFirst; i < result.size(); i++)
+                {
+                    result[i].Type = (TxType) type;
+                    result[i].Height = okHeight ? height : 0;
+                    result[i].Lang = okLang ? lang : "";
+                    result[i].Author = okAuthor ? author : "";
+                }
            }
 
            FinalizeSqlStatement(*stmt);
@@ -197,7 +213,7 @@ namespace PocketDb
         return result;
     }
 
-    void WebRepository::UpsertContent(const vector<WebContent>& contentList)
+    void WebRepository::UpsertContent(const vector<WebContent>& contentList, bool searchIndex)
     {
         auto func = __func__;
 
@@ -228,6 +244,20 @@ namespace PocketDb
             for (const auto& id: ids) TryBindStatementInt64(delContentStmt, i++, id);
             TryStepStatement(delContentStmt);
 
+            for (const auto& id: ids)
+            {
+                if (!searchIndex)
+                    continue;
+
+                auto delSearchStmt = SetupSqlStatement(R"sql(
+                    delete from web.ContentSearch
+                    where ROWID >= ? and ROWID < ?
+                )sql");
+                TryBindStatementInt64(delSearchStmt, 1, id * CONTENT_SEARCH_FIELDS);
+                TryBindStatementInt64(delSearchStmt, 2, (id + 1) * CONTENT_SEARCH_FIELDS);
+                TryStepStatement(delSearchStmt);
+            }
+
             // ---------------------------------------------------------
             int64_t nTime2 = GetTimeMicros();
 
@@ -273,6 +303,25 @@ namespace PocketDb
                     LogPrintf("Warning: content (%d) field (%d) not indexed in search db\n",
                         contentItm.ContentId, (int)contentItm.FieldType);
                 }
+
+                // ---------------------------------------------------------
+
+                if (!searchIndex)
+                    continue;
+
+                auto stmtSearch = SetupSqlStatement(R"sql(
+                    replace into web.ContentSearch (ROWID, Value, ContentId, FieldType, TxType, Height, Lang, Author)
+                    values (?,?,?,?,?,?,?,?)
+                )sql");
+                TryBindStatementInt64(stmtSearch, 1, contentItm.ContentId * CONTENT_SEARCH_FIELDS + (int)contentItm.FieldType);
+                TryBindStatementText(stmtSearch, 2, contentItm.Value);
+                TryBindStatementInt64(stmtSearch, 3, contentItm.ContentId);
+                TryBindStatementInt(stmtSearch, 4, (int)contentItm.FieldType);
+                TryBindStatementInt(stmtSearch, 5, (int)contentItm.Type);
+                TryBindStatementInt(stmtSearch, 6, contentItm.Height);
+                TryBindStatementText(stmtSearch, 7, contentItm.Lang);
+                TryBindStatementText(stmtSearch, 8, contentItm.Author);
+                TryStepStatement(stmtSearch);
             }
 
             // ---------------------------------------------------------
@@ -288,6 +337,83 @@ namespace PocketDb
         });
     }
 
+    bool WebRepository::IsContentSearchEmpty()
+    {
+        bool result = true;
+
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(R"sql(
+                select 1 from web.ContentSearch limit 1
+            )sql");
+
+            result = (sqlite3_step(*stmt) != SQLITE_ROW);
+            FinalizeSqlStatement(*stmt);
+        });
+
+        return result;
+    }
+
+    void WebRepository::FillContentSearch()
+    {
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(R"sql(
+                replace into web.ContentSearch (ROWID, Value, ContentId, FieldType, TxType, Height, Lang, Author)
+                select
+                    cm.ContentId * ? + cm.FieldType,
+                    c.Value,
+                    cm.ContentId,
+                    cm.FieldType,
+                    t.Type,
+                    t.Height,
+                    p.String1,
+                    t.String1
+                from web.ContentMap cm
+                join web.Content c on c.ROWID = cm.ROWID
+                cross join Transactions t indexed by Transactions_Last_Id_Height
+                    on t.Last = 1 and t.Id = cm.ContentId and t.Height is not null
+                cross join Payload p on p.TxHash = t.Hash
+            )sql");
+            TryBindStatementInt64(stmt, 1, CONTENT_SEARCH_FIELDS);
+            TryStepStatement(stmt);
+        });
+    }
+
+    void WebRepository::ClearContentSearch()
+    {
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(R"sql(
+                delete from web.ContentSearch
+            )sql");
+            TryStepStatement(stmt);
+        });
+    }
+
+    void WebRepository::MergeContentSearch(int pages)
+    {
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(R"sql(
+                insert into web.ContentSearch (ContentSearch, rank) values ('merge', ?)
+            )sql");
+            TryBindStatementInt(stmt, 1, pages);
+            TryStepStatement(stmt);
+        });
+    }
+
+    void WebRepository::OptimizeContentSearch()
+    {
+        TryTransactionStep(__func__, [&]()
+        {
+            auto stmt = SetupSqlStatement(R"sql(
+                insert into web.ContentSearch (ContentSearch) values ('optimize')
+            )sql");
+            TryStepStatement(stmt);
+        });
+    }
+
     void WebRepository::CalculateSharkAccounts(BadgeSharkConditions& cond)
     {
         TryTransactionStep(__func__, [&]()
@@ -34,7 +34,15 @@ namespace PocketDb
         void UpsertContentTags(const vector<WebTag>& contentTags);
 
         vector<WebContent> GetContent(const string& blockHash);
-        void UpsertContent(const vector<WebContent>& contentList);
+        // Ranked search index is updated only with searchIndex
+        void UpsertContent(const vector<WebContent>& contentList, bool searchIndex);
+
+        // Ranked search index maintenance
+        bool IsContentSearchEmpty();
+        void FillContentSearch();
+        void ClearContentSearch();
+        void MergeContentSearch(int pages);
+        void OptimizeContentSearch();
 
         void CalculateSharkAccounts(BadgeSharkConditions& cond);
         void CalculateValidAuthors(int blockHeight);
@@ -714,6 +714,55 @@ namespace PocketDb
         const vector<int64_t>& ids,
         bool shortForm,
         int firstFlagsDepth)
+    {
+        // Only short form with default flags depth is shared between requests
+        if (!shortForm || firstFlagsDepth != DEFAULT_FIRST_FLAGS_DEPTH)
+            return SelectAccountProfiles(addresses, ids, shortForm, firstFlagsDepth);
+
+        vector<tuple<string, int64_t, UniValue>> result{};
+        vector<string> missedAddresses;
+        vector<int64_t> missedIds;
+
+        // Version must be taken before reading database
+        int64_t version = AccountProfileCacheInst.Version();
+
+        for (const auto& address : addresses)
+        {
+            int64_t id;
+            UniValue profile;
+            if (AccountProfileCacheInst.Get(address, id, profile))
+                result.emplace_back(address, id, profile);
+            else
+                missedAddresses.push_back(address);
+        }
+
+        for (int64_t id : ids)
+        {
+            UniValue profile;
+            if (AccountProfileCacheInst.Get(id, profile))
+                result.emplace_back(profile["address"].get_str(), id, profile);
+            else
+                missedIds.push_back(id);
+        }
+
+        if (missedAddresses.empty() && missedIds.empty())
+            return result;
+
+        // Fetch all missed profiles in one query
+        for (auto& [address, id, profile] : SelectAccountProfiles(missedAddresses, missedIds, shortForm, firstFlagsDepth))
+        {
+            AccountProfileCacheInst.Put(id, address, profile, version);
+            result.emplace_back(address, id, profile);
+        }
+
+        return result;
+    }
+
+    vector<tuple<string, int64_t, UniValue>> WebRpcRepository::SelectAccountProfiles(
+        const vector<string>& addresses,
+        const vector<int64_t>& ids,
+        bool shortForm,
+        int firstFlagsDepth)
     {
         vector<tuple<string, int64_t, UniValue>> result{};
 
@@ -988,10 +1037,33 @@ namespace PocketDb
         return result;
     }
 
-    UniValue WebRpcRepository::GetLastComments(int count, int height, const string& lang)
+    string WebRpcRepository::GetLastComments(int count, int height, const string& lang)
     {
         auto func = __func__;
-        auto result = UniValue(UniValue::VARR);
+
+        static const SqlJsonSchema schema = {
+            { "id", 0 },
+            { "postid", 1 },
+            { "address", 2 },
+            { "time", 3 },
+            { "timeUpd", 3 },
+            { "block", 4 },
+            { "msg", 5 },
+            { "parentid", 6 },
+            { "answerid", 7 },
+            { "addressContent", 8 },
+            { "addressCommentParent", 9 },
+            { "addressCommentAnswer", 10 },
+            { "scoreUp", 11 },
+            { "scoreDown", 12 },
+            { "reputation", 13 },
+            { "edit", 14, SqlJsonType::Bool },
+            { "donation", 15, SqlJsonType::Text, false, "true" },
+            { "amount", 15 },
+        };
+
+        SqlJsonWriter result;
+        result.BeginArray();
 
         auto sql = R"sql(
             select
@@ -1077,42 +1149,13 @@ namespace PocketDb
             TryBindStatementInt(stmt, i++, count);
 
             while (sqlite3_step(*stmt) == SQLITE_ROW)
-            {
-                UniValue record(UniValue::VOBJ);
-
-                int i = 0;
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("id", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("postid", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("address", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok)
-                {
-                    record.pushKV("time", value);
-                    record.pushKV("timeUpd", value);
-                }
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("block", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("msg", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("parentid", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("answerid", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("addressContent", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("addressCommentParent", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("addressCommentAnswer", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("scoreUp", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("scoreDown", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok) record.pushKV("reputation", value);
-                if (auto[ok, value] = TryGetColumnInt(*stmt, i++); ok) record.pushKV("edit", value == 1);
-                if (auto[ok, value] = TryGetColumnString(*stmt, i++); ok)
-                {
-                    record.pushKV("donation", "true");
-                    record.pushKV("amount", value);
-                }
-
-                result.push_back(record);
-            }
+                result.WriteRow(*stmt, schema);
 
             FinalizeSqlStatement(*stmt);
         });
 
-        return result;
+        result.EndArray();
+        return move(result.Str());
     }
 
     map<int64_t, UniValue> WebRpcRepository::GetLastComments(const vector<int64_t>& ids, const string& address)
@@ -1262,10 +1305,33 @@ namespace PocketDb
         return result;
     }
 
-    UniValue WebRpcRepository::GetCommentsByPost(const string& postHash, const string& parentHash, const string& addressHash)
+    string WebRpcRepository::GetCommentsByPost(const string& postHash, const string& parentHash, const string& addressHash)
     {
         auto func = __func__;
-        auto result = UniValue(UniValue::VARR);
+
+        static const SqlJsonSchema schema = {
+            { "id", 2, SqlJsonType::Text, true },
+            { "postid", 3 },
+            { "address", 4 },
+            { "time", 5 },
+            { "timeUpd", 6 },
+            { "block", 7 },
+            { "msg", 8 },
+            { "parentid", 9 },
+            { "answerid", 10 },
+            { "scoreUp", 11 },
+            { "scoreDown", 12 },
+            { "reputation", 13 },
+            { "myScore", 14 },
+            { "children", 15 },
+            { "amount", 16 },
+            { "donation", 16, SqlJsonType::Text, false, "true" },
+            { "deleted", 17, SqlJsonType::Bool },
+            { "edit", 18, SqlJsonType::Bool },
+        };
+
+        SqlJsonWriter result;
+        result.BeginArray();
 
         string parentWhere = " and c.String4 is null ";
         if (!parentHash.empty())
@@ -1317,7 +1383,10 @@ namespace PocketDb
                       )
                 ) AS ChildrenCount,
 
-                o.Value as Donate
+                o.Value as Donate,
+
+                (case when c.Type = 206 then 1 else 0 end) as Deleted,
+                (case when c.Type in (205, 206) then 1 else 0 end) as Edit
 
             from Transactions c indexed by Transactions_Type_Last_String3_Height
 
@@ -1363,63 +1432,13 @@ namespace PocketDb
                 TryBindStatementText(stmt, i++, parentHash);
 
             while (sqlite3_step(*stmt) == SQLITE_ROW)
-            {
-                UniValue record(UniValue::VOBJ);
-
-                //auto[ok0, txHash] = TryGetColumnString(stmt, 1);
-                auto[ok1, rootTxHash] = TryGetColumnString(*stmt, 2);
-                record.pushKV("id", rootTxHash);
-
-                if (auto[ok, value] = TryGetColumnString(*stmt, 3); ok)
-                    record.pushKV("postid", value);
-
-                if (auto[ok, value] = TryGetColumnString(*stmt, 4); ok) record.pushKV("address", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 5); ok) record.pushKV("time", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 6); ok) record.pushKV("timeUpd", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 7); ok) record.pushKV("block", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 8); ok) record.pushKV("msg", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 9); ok) record.pushKV("parentid", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 10); ok) record.pushKV("answerid", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 11); ok) record.pushKV("scoreUp", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 12); ok) record.pushKV("scoreDown", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 13); ok) record.pushKV("reputation", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 14); ok) record.pushKV("myScore", value);
-                if (auto[ok, value] = TryGetColumnString(*stmt, 15); ok) record.pushKV("children", value);
-
-                if (auto[ok, value] = TryGetColumnString(*stmt, 16); ok)
-                {
-                    record.pushKV("amount", value);
-                    record.pushKV("donation", "true");
-                }
-
-                if (auto[ok, value] = TryGetColumnInt(*stmt, 0); ok)
-                {
-                    switch (static_cast<TxType>(value))
-                    {
-                        case PocketTx::CONTENT_COMMENT:
-                            record.pushKV("deleted", false);
-                            record.pushKV("edit", false);
-                            break;
-                        case PocketTx::CONTENT_COMMENT_EDIT:
-                            record.pushKV("deleted", false);
-                            record.pushKV("edit", true);
-                            break;
-                        case PocketTx::CONTENT_COMMENT_DELETE:
-                            record.pushKV("deleted", true);
-                            record.pushKV("edit", true);
-                            break;
-                        default:
-                            break;
-                    }
-                }
-
-                result.push_back(record);
-            }
+                result.WriteRow(*stmt, schema);
 
             FinalizeSqlStatement(*stmt);
         });
 
-        return result;
+        result.EndArray();
+        return move(result.Str());
     }
 
     UniValue WebRpcRepository::GetCommentsByHashes(const vector<string>& cmntHashes, const string& addressHash)
@@ -6,8 +6,10 @@
 #define POCKETDB_WEB_RPC_REPOSITORY_H
 
 #include "pocketdb/helpers/PocketnetHelper.h"
+#include "pocketdb/helpers/SqlJsonWriter.h"
 #include "pocketdb/helpers/TransactionHelper.h"
 #include "pocketdb/repositories/BaseRepository.h"
+#include "pocketdb/repositories/web/AccountProfileCache.h"
 
 #include <boost/algorithm/string/join.hpp>
 #include <boost/range/adaptor/transformed.hpp>
@@ -25,6 +27,9 @@ namespace PocketDb
     using namespace PocketTx;
     using namespace PocketHelpers;
 
+    // Default depth (days) of first flags in account profiles - only profiles with it are cached
+    static const int DEFAULT_FIRST_FLAGS_DEPTH = 14;
+
     struct HierarchicalRecord
     {
         int64_t Id;
@@ -68,10 +73,10 @@ namespace PocketDb
 
         UniValue GetUserStatistic(const vector<string>& addresses, const int nHeight = 0, const int depthR = 0, const int depthC = 0, const int cntC = 1);
 
-        UniValue GetCommentsByPost(const string& postHash, const string& parentHash, const string& addressHash);
+        string GetCommentsByPost(const string& postHash, const string& parentHash, const string& addressHash);
         UniValue GetCommentsByHashes(const vector<string>& cmntHashes, const string& addressHash);
 
-        UniValue GetLastComments(int count, int height, const string& lang);
+        string GetLastComments(int count, int height, const string& lang);
         map<int64_t, UniValue> GetLastComments(const vector<int64_t>& ids, const string& address);
 
         UniValue GetPagesScores(const vector<string>& postHashes, const vector<string>& commentHashes, const string& address);
@@ -80,8 +85,8 @@ namespace PocketDb
         UniValue GetAddressScores(const vector<string>& postHashes, const string& address);
         UniValue GetAccountRaters(const string& address);
 
-        map<string, UniValue> GetAccountProfiles(const vector<string>& addresses, bool shortForm = true, int firstFlagsDepth = 14);
-        map<int64_t, UniValue> GetAccountProfiles(const vector<int64_t>& ids, bool shortForm = true, int firstFlagsDepth = 14);
+        map<string, UniValue> GetAccountProfiles(const vector<string>& addresses, bool shortForm = true, int firstFlagsDepth = DEFAULT_FIRST_FLAGS_DEPTH);
+        map<int64_t, UniValue> GetAccountProfiles(const vector<int64_t>& ids, bool shortForm = true, int firstFlagsDepth = DEFAULT_FIRST_FLAGS_DEPTH);
 
         UniValue GetSubscribesAddresses(const string& address, const vector<TxType>& types = {ACTION_SUBSCRIBE, ACTION_SUBSCRIBE_PRIVATE });
         UniValue GetSubscribersAddresses(const string& address, const vector<TxType>& types = {ACTION_SUBSCRIBE, ACTION_SUBSCRIBE_PRIVATE });
@@ -202,6 +207,7 @@ namespace PocketDb
         double dekayContent =  0.96;
 
         vector<tuple<string, int64_t, UniValue>> GetAccountProfiles(const vector<string>& addresses, const vector<int64_t>& ids, bool shortForm, int firstFlagsDepth);
+        vector<tuple<string, int64_t, UniValue>> SelectAccountProfiles(const vector<string>& addresses, const vector<int64_t>& ids, bool shortForm, int firstFlagsDepth);
     };
 
     typedef shared_ptr<WebRpcRepository> WebRpcRepositoryRef;
@@ -8,6 +8,13 @@ namespace PocketServices
 {
     // Important! The method can return true with empty data, keep this in mind when using.
     bool Accessor::GetBlock(const CBlock& block, PocketBlockRef& pocketBlock)
+    {
+        return GetBlock(block, pocketBlock, PocketDb::TransRepoInst);
+    }
+
+    // Read block payload with the given repository - e.g. read-only connection of other thread
+    // Important! The method can return true with empty data, keep this in mind when using.
+    bool Accessor::GetBlock(const CBlock& block, PocketBlockRef& pocketBlock, TransactionRepository& repository)
     {
         try
         {
@@ -23,7 +30,7 @@ namespace PocketServices
             if (txs.empty())
                 return true;
 
-            pocketBlock = PocketDb::TransRepoInst.List(txs, true);
+            pocketBlock = repository.List(txs, true);
             return pocketBlock && pocketBlock->size() == txs.size();
         }
         catch (const std::exception& e)
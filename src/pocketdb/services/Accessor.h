@@ -27,6 +27,7 @@ namespace PocketServices
     {
     public:
         static bool GetBlock(const CBlock& block, PocketBlockRef& pocketBlock);
+        static bool GetBlock(const CBlock& block, PocketBlockRef& pocketBlock, TransactionRepository& repository);
         static bool GetBlock(const CBlock& block, string& data);
         static bool GetTransaction(const CTransaction& tx, PTransactionRef& pocketTx);
         static bool GetTransaction(const CTransaction& tx, string& data);
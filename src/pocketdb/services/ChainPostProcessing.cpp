@@ -22,12 +22,32 @@ namespace PocketServices
 
         int64_t nTime3 = GetTimeMicros();
         LogPrint(BCLog::BENCH, "    - IndexRatings: %.2fms _ %d\n", 0.001 * (double)(nTime3 - nTime2), height);
+
+        InvalidateAccountProfiles(height, txs);
+
+        PocketDb::ConsensusCountersInst.Index(height);
     }
 
     bool ChainPostProcessing::Rollback(int height)
     {
         LogPrint(BCLog::SYNC, "Rollback current block to prev at height %d\n", height - 1);
-        return PocketDb::ChainRepoInst.Rollback(height);
+
+        // Rollbacks are rare - drop all cached profiles. Readers started before the rollback
+        // is committed still see old rows, so profiles are dropped again after the commit.
+        PocketDb::AccountProfileCacheInst.Clear();
+
+        bool result = PocketDb::ChainRepoInst.Rollback(height);
+
+        PocketDb::AccountProfileCacheInst.Clear();
+
+        if (!result)
+        {
+            PocketDb::ConsensusCountersInst.Clear();
+            return false;
+        }
+
+        PocketDb::ConsensusCountersInst.Rollback(height);
+        return true;
     }
 
     void ChainPostProcessing::PrepareTransactions(const CBlock& block, vector<TransactionIndexingInfo>& txs)
@@ -53,6 +73,22 @@ namespace PocketServices
             }
         }
 
+    void ChainPostProcessing::InvalidateAccountProfiles(int height, const vector<TransactionIndexingInfo>& txs)
+    {
+        // Nothing to look up while cache is empty (e.g. during sync)
+        // Deleted account changes counters of all its subscriptions
+        bool clear = PocketDb::AccountProfileCacheInst.Empty() ||
+            any_of(txs.begin(), txs.end(), [](const TransactionIndexingInfo& txInfo) { return txInfo.Type == ACCOUNT_DELETE; });
+
+        if (clear)
+        {
+            PocketDb::AccountProfileCacheInst.Clear();
+            return;
+        }
+
+        PocketDb::AccountProfileCacheInst.Invalidate(PocketDb::ChainRepoInst.GetAccountIdsByHeight(height));
+    }
+
     // Set block height for all transactions in block
     void ChainPostProcessing::IndexChain(const string& blockHash, int height, vector<TransactionIndexingInfo>& txs)
     {
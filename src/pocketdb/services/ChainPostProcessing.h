@@ -12,6 +12,7 @@
 #include "pocketdb/consensus/Reputation.h"
 #include "pocketdb/helpers/TransactionHelper.h"
 #include "pocketdb/pocketnet.h"
+#include "pocketdb/repositories/web/AccountProfileCache.h"
 
 namespace PocketServices
 {
@@ -33,6 +34,7 @@ namespace PocketServices
         static void PrepareTransactions(const CBlock& block, vector<TransactionIndexingInfo>& txs);
         static void IndexChain(const string& blockHash, int height, vector<TransactionIndexingInfo>& txs);
         static void IndexRatings(int height, vector<TransactionIndexingInfo>& txs);
+        static void InvalidateAccountProfiles(int height, const vector<TransactionIndexingInfo>& txs);
     };
 } // namespace PocketServices
 
@@ -0,0 +1,252 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/services/MempoolWriter.h"
+#include "util.h"
+
+namespace PocketServices
+{
+    MempoolWriter::MempoolWriter(SQLiteDatabase& db, TransactionRepository& repository)
+        : m_database(db), m_repository(repository)
+    {
+    }
+
+    void MempoolWriter::Start(boost::thread_group& threadGroup)
+    {
+        batchTime = gArgs.GetArg("-sqlmempoolbatchms", 50);
+        batchSize = (int) gArgs.GetArg("-sqlmempoolbatchsize", 500);
+
+        // Zero time disables grouping - every mempool change is committed at once
+        if (batchTime <= 0)
+            return;
+
+        m_database.SetGroupFinished([this](int64_t groupId, bool committed) { OnGroupFinished(groupId, committed); });
+
+        {
+            LOCK(_queue_mutex);
+            shutdown = false;
+            running = true;
+        }
+
+        threadGroup.create_thread([this] { Worker(); });
+    }
+
+    void MempoolWriter::Stop()
+    {
+        // Signal for complete all tasks
+        {
+            LOCK(_queue_mutex);
+
+            shutdown = true;
+            running = false;
+            _queue_cond.notify_all();
+        }
+
+        // Wait all tasks completed
+        LOCK(_running_mutex);
+
+        Flush();
+    }
+
+    void MempoolWriter::Insert(PocketBlock& pocketBlock)
+    {
+        vector<string> inserted;
+        for (const auto& ptx : pocketBlock)
+            inserted.push_back(*ptx->GetHash());
+
+        Step([this, pocketBlock]() mutable { m_repository.InsertTransactions(pocketBlock); }, move(inserted), {});
+    }
+
+    void MempoolWriter::Clean(const unordered_set<string>& hashes)
+    {
+        if (hashes.empty())
+            return;
+
+        vector<string> txHashes(hashes.begin(), hashes.end());
+        Step([this, txHashes]() { m_repository.CleanTransactions(txHashes); }, {}, txHashes);
+    }
+
+    bool MempoolWriter::Exists(const string& hash)
+    {
+        {
+            LOCK(m_state_mutex);
+            if (m_inserted.count(hash))
+                return true;
+        }
+
+        return m_repository.Exists(hash);
+    }
+
+    void MempoolWriter::Flush()
+    {
+        m_database.CommitGroup();
+
+        // Steps of a group that failed to commit are executed again
+        LOCK(m_step_mutex);
+        if (Replay())
+            m_database.CommitGroup();
+    }
+
+    void MempoolWriter::Step(std::function<void()> func, vector<string> inserted, vector<string> cleaned)
+    {
+        bool grouped;
+        {
+            LOCK(_queue_mutex);
+            grouped = running;
+        }
+
+        if (!grouped)
+        {
+            func();
+            return;
+        }
+
+        {
+            LOCK(m_step_mutex);
+
+            {
+                LOCK(m_state_mutex);
+                for (const auto& hash : cleaned)
+                    m_inserted.erase(hash);
+                for (const auto& hash : inserted)
+                    m_inserted.insert(hash);
+            }
+
+            Replay();
+            Execute(PendingStep{ 0, move(func), move(inserted) });
+        }
+
+        if (get<0>(m_database.GroupState()) >= batchSize)
+        {
+            Flush();
+            return;
+        }
+
+        LOCK(_queue_mutex);
+        _pending = true;
+        _queue_cond.notify_one();
+    }
+
+    void MempoolWriter::Execute(PendingStep step)
+    {
+        try
+        {
+            SQLiteGroupScope scope;
+            step.Func();
+        }
+        catch (const std::exception&)
+        {
+            LOCK(m_state_mutex);
+            for (const auto& hash : step.Inserted)
+                m_inserted.erase(hash);
+
+            throw;
+        }
+
+        step.GroupId = SQLiteGroupScope::LastGroup();
+
+        LOCK(m_state_mutex);
+        m_steps.push_back(move(step));
+        Settle();
+    }
+
+    bool MempoolWriter::Replay()
+    {
+        vector<PendingStep> lost;
+        {
+            LOCK(m_state_mutex);
+            Settle();
+            lost.swap(m_lost);
+
+            // No step is executing now - all finished groups are settled
+            m_lost_groups.clear();
+        }
+
+        for (auto& step : lost)
+        {
+            try
+            {
+                Execute(move(step));
+            }
+            catch (const std::exception& e)
+            {
+                LogPrintf("MempoolWriter: failed to execute lost step again: %s\n", e.what());
+            }
+        }
+
+        if (!lost.empty())
+            LogPrintf("MempoolWriter: %d mempool changes executed again after failed group commit\n", lost.size());
+
+        return !lost.empty();
+    }
+
+    void MempoolWriter::OnGroupFinished(int64_t groupId, bool committed)
+    {
+        {
+            LOCK(m_state_mutex);
+
+            m_finished_group = groupId;
+            if (!committed)
+                m_lost_groups.insert(groupId);
+
+            Settle();
+        }
+
+        // Worker executes lost steps again
+        if (!committed)
+        {
+            LOCK(_queue_mutex);
+            _pending = true;
+            _queue_cond.notify_one();
+        }
+    }
+
+    void MempoolWriter::Settle()
+    {
+        // Steps are ordered by group - finished groups are at the front
+        while (!m_steps.empty() && m_steps.front().GroupId <= m_finished_group)
+        {
+            auto& step = m_steps.front();
+
+            if (m_lost_groups.count(step.GroupId))
+            {
+                m_lost.push_back(move(step));
+            }
+            else
+            {
+                // Committed rows are found in database
+                for (const auto& hash : step.Inserted)
+                    m_inserted.erase(hash);
+            }
+
+            m_steps.pop_front();
+        }
+    }
+
+    void MempoolWriter::Worker()
+    {
+        LogPrintf("MempoolWriter: starting thread worker\n");
+
+        LOCK(_running_mutex);
+
+        while (true)
+        {
+            {
+                WAIT_LOCK(_queue_mutex, lock);
+
+                _queue_cond.wait(lock, [this]() { return shutdown || _pending; });
+                if (shutdown) break;
+
+                // Collect next changes into the same group
+                _queue_cond.wait_for(lock, chrono::milliseconds(batchTime), [this]() { return shutdown; });
+                _pending = false;
+            }
+
+            Flush();
+        }
+
+        LogPrintf("MempoolWriter: thread worker exit\n");
+    }
+
+} // PocketServices
@@ -0,0 +1,87 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_MEMPOOL_WRITER_H
+#define POCKETDB_MEMPOOL_WRITER_H
+
+#include <boost/thread.hpp>
+#include <deque>
+#include <set>
+#include <unordered_set>
+#include "sync.h"
+
+#include "pocketdb/SQLiteDatabase.h"
+#include "pocketdb/repositories/TransactionRepository.h"
+
+namespace PocketServices
+{
+    using namespace std;
+    using namespace PocketDb;
+
+    // Group commit of mempool pocket transactions.
+    // Inserts and cleanups are executed as savepoints of one open transaction of the
+    // write connection. The transaction is committed every -sqlmempoolbatchms milliseconds,
+    // after -sqlmempoolbatchsize steps or together with the first other write (block indexing, rollback).
+    // Reads of other threads are executed inside the open group and do not commit it.
+    // Hashes of pending inserts are kept in memory for Exists. Steps of a group that failed
+    // to commit are executed again in the next group.
+    class MempoolWriter
+    {
+    public:
+        MempoolWriter(SQLiteDatabase& db, TransactionRepository& repository);
+        void Start(boost::thread_group& threadGroup);
+        void Stop();
+
+        void Insert(PocketBlock& pocketBlock);
+        void Clean(const unordered_set<string>& hashes);
+
+        // Transaction exists in pending inserts or in database
+        bool Exists(const string& hash);
+
+        // Commit pending mempool changes
+        void Flush();
+
+    private:
+        struct PendingStep
+        {
+            int64_t GroupId;
+            std::function<void()> Func;
+            vector<string> Inserted;
+        };
+
+        SQLiteDatabase& m_database;
+        TransactionRepository& m_repository;
+
+        int64_t batchTime = 50;
+        int batchSize = 500;
+        bool running = false;
+        bool shutdown = false;
+
+        Mutex _running_mutex;
+        Mutex _queue_mutex;
+        std::condition_variable _queue_cond;
+        bool _pending = false;
+
+        // Serializes execution of steps and replay of lost steps
+        Mutex m_step_mutex;
+
+        // Pending state - also changed under the connection lock when a group is finished
+        Mutex m_state_mutex;
+        deque<PendingStep> m_steps GUARDED_BY(m_state_mutex);
+        vector<PendingStep> m_lost GUARDED_BY(m_state_mutex);
+        unordered_set<string> m_inserted GUARDED_BY(m_state_mutex);
+        int64_t m_finished_group GUARDED_BY(m_state_mutex) = 0;
+        set<int64_t> m_lost_groups GUARDED_BY(m_state_mutex);
+
+        void Worker();
+        void Step(std::function<void()> func, vector<string> inserted, vector<string> cleaned);
+        void Execute(PendingStep step) EXCLUSIVE_LOCKS_REQUIRED(m_step_mutex);
+        bool Replay() EXCLUSIVE_LOCKS_REQUIRED(m_step_mutex);
+        void OnGroupFinished(int64_t groupId, bool committed);
+        void Settle() EXCLUSIVE_LOCKS_REQUIRED(m_state_mutex);
+    };
+
+} // PocketServices
+
+#endif // POCKETDB_MEMPOOL_WRITER_H
@@ -0,0 +1,52 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/services/PocketCheckQueue.h"
+
+#include "checkqueue.h"
+#include "util.h"
+#include "validation.h"
+
+namespace PocketServices
+{
+    // Batches smaller than this are cheaper to execute without waking up workers
+    static const size_t POCKET_CHECK_MIN_PARALLEL = 8;
+
+    static CCheckQueue<PocketCheck> pocketcheckqueue(16);
+
+    bool PocketCheck::operator()()
+    {
+        try
+        {
+            return m_func();
+        }
+        catch (const std::exception& ex)
+        {
+            LogPrintf("Error: PocketCheck failed with exception: %s\n", ex.what());
+            return false;
+        }
+    }
+
+    void ThreadPocketCheck()
+    {
+        RenameThread("pocketcoin-pocketch");
+        pocketcheckqueue.Thread();
+    }
+
+    bool RunPocketChecks(std::vector<PocketCheck>& checks)
+    {
+        if (nScriptCheckThreads == 0 || checks.size() < POCKET_CHECK_MIN_PARALLEL)
+        {
+            for (auto& check : checks)
+                if (!check())
+                    return false;
+
+            return true;
+        }
+
+        CCheckQueueControl<PocketCheck> control(&pocketcheckqueue);
+        control.Add(checks);
+        return control.Wait();
+    }
+}
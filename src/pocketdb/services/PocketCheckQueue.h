@@ -0,0 +1,40 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_POCKETCHECKQUEUE_H
+#define POCKETDB_POCKETCHECKQUEUE_H
+
+#include <functional>
+#include <vector>
+
+namespace PocketServices
+{
+    // Single unit of work for pocket check queue.
+    // Used for payload decoding and stateless social consensus checks of block transactions.
+    class PocketCheck
+    {
+    private:
+        std::function<bool()> m_func;
+
+    public:
+        PocketCheck() = default;
+        explicit PocketCheck(std::function<bool()> func) : m_func(std::move(func)) {}
+
+        // Exceptions must not leave worker threads - treated as failed check
+        bool operator()();
+
+        void swap(PocketCheck& check) { m_func.swap(check.m_func); }
+    };
+
+    // Worker thread for pocket check queue - started next to script check threads (-par)
+    void ThreadPocketCheck();
+
+    // Execute all checks on the worker threads and wait for completion.
+    // Small batches and nodes without worker threads execute checks in the calling thread.
+    // Batches of several threads (connected and prefetched block) use the workers in turns.
+    // Returns false if any of checks failed.
+    bool RunPocketChecks(std::vector<PocketCheck>& checks);
+}
+
+#endif // POCKETDB_POCKETCHECKQUEUE_H
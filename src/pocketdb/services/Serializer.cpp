@@ -3,6 +3,7 @@
 // https://www.apache.org/licenses/LICENSE-2.0
 
 #include "pocketdb/services/Serializer.h"
+#include "pocketdb/services/PocketCheckQueue.h"
 
 namespace PocketServices
 {
@@ -17,6 +18,15 @@ namespace PocketServices
         UniValue fakeData(UniValue::VOBJ);
         return deserializeBlock(block, fakeData);
     }
+    tuple<bool, PocketBlock> Serializer::DeserializeBlock(const CBlock& block, UniValue& pocketData)
+    {
+        return deserializeBlock(block, pocketData);
+    }
+
+    UniValue Serializer::DeserializeData(CDataStream& stream)
+    {
+        return parseStream(stream);
+    }
 
     tuple<bool, PTransactionRef> Serializer::DeserializeTransactionRpc(const CTransactionRef& tx, const UniValue& pocketData)
     {
@@ -203,32 +213,57 @@ namespace PocketServices
 
     tuple<bool, PocketBlock> Serializer::deserializeBlock(const CBlock& block, UniValue& pocketData)
     {
-        // Restore pocket transaction instance
-        PocketBlock pocketBlock;
-        for (const auto& tx : block.vtx)
+        // Index payload entries by hash - UniValue lookup by key is linear
+        unordered_map<string, const UniValue*> entries;
+        if (pocketData.isObject())
         {
-            auto txHash = tx->GetHash().GetHex();
+            const auto& keys = pocketData.getKeys();
+            const auto& values = pocketData.getValues();
+            for (size_t i = 0; i < keys.size(); i++)
+                entries.emplace(keys[i], &values[i]);
+        }
 
-            UniValue entry(UniValue::VOBJ);
-            if (pocketData.exists(txHash))
+        // Restore pocket transaction instances on check queue workers
+        // Every job writes only own slot so the order of transactions is kept
+        vector<PTransactionRef> ptxs(block.vtx.size());
+        vector<PocketCheck> checks;
+        checks.reserve(block.vtx.size());
+
+        for (size_t i = 0; i < block.vtx.size(); i++)
+        {
+            checks.emplace_back([&block, &entries, &ptxs, i]()
             {
-                auto entrySrc = pocketData[txHash];
+                const auto& tx = block.vtx[i];
+                auto txHash = tx->GetHash().GetHex();
 
-                try
+                UniValue entry(UniValue::VOBJ);
+                if (auto it = entries.find(txHash); it != entries.end())
                 {
-                    entry.read(entrySrc.get_str());
+                    try
+                    {
+                        entry.read(it->second->get_str());
+                    }
+                    catch (std::exception& ex)
+                    {
+                        LogPrintf("Error deserialize transaction: %s: %s\n", txHash, ex.what());
+                    }
                 }
-                catch (std::exception& ex)
-                {
-                    LogPrintf("Error deserialize transaction: %s: %s\n", txHash, ex.what());
-                }
-            }
 
-            if (auto[ok, ptx] = deserializeTransaction(tx, entry); ok && ptx)
-                pocketBlock.push_back(ptx);
+                if (auto[ok, ptx] = deserializeTransaction(tx, entry); ok && ptx)
+                    ptxs[i] = ptx;
+
+                return true;
+            });
         }
 
-        return { true, pocketBlock };
+        bool ok = RunPocketChecks(checks);
+
+        PocketBlock pocketBlock;
+        for (const auto& ptx : ptxs)
+            if (ptx)
+                pocketBlock.push_back(ptx);
+
+        return { ok, pocketBlock };
     }
 
     tuple<bool, shared_ptr<Transaction>> Serializer::deserializeTransaction(const CTransactionRef& tx, UniValue& pocketData)
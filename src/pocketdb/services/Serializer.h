@@ -26,6 +26,10 @@ namespace PocketServices
     public:
         static tuple<bool, PocketBlock> DeserializeBlock(const CBlock& block, CDataStream& stream);
         static tuple<bool, PocketBlock> DeserializeBlock(const CBlock& block);
+        static tuple<bool, PocketBlock> DeserializeBlock(const CBlock& block, UniValue& pocketData);
+
+        // Read payloads object (transaction hash -> serialized data) from network message
+        static UniValue DeserializeData(CDataStream& stream);
 
         static tuple<bool, PTransactionRef> DeserializeTransactionRpc(const CTransactionRef& tx, const UniValue& pocketData);
         static tuple<bool, PTransactionRef> DeserializeTransaction(const CTransactionRef& tx, CDataStream& stream);
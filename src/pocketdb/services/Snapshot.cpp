@@ -0,0 +1,365 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/services/Snapshot.h"
+
+#include "chainparams.h"
+#include "crypto/sha256.h"
+#include "util.h"
+#include "utilstrencodings.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace PocketServices
+{
+    static const char* SNAPSHOT_MANIFEST = "manifest.txt";
+    static const char* SNAPSHOT_DATABASES[] = { "main", "web" };
+
+    uint256 SnapshotManifest::Hash() const
+    {
+        CSHA256 hasher;
+        auto write = [&](const string& line) { hasher.Write((const unsigned char*) line.data(), line.size()); };
+
+        write(strprintf("height %d\nblock %s\n", Height, BlockHash));
+        for (const auto& chunk : Chunks)
+            write(strprintf("chunk %s %d %s\n", chunk.File, chunk.Size, chunk.Hash));
+
+        uint256 hash;
+        hasher.Finalize(hash.begin());
+        return hash;
+    }
+
+    SnapshotManifest Snapshot::Export(const fs::path& dbPath, const fs::path& dir, size_t chunkSize,
+        const std::function<void()>& onReadSnapshot)
+    {
+        if (fs::exists(dir) && !fs::is_empty(dir))
+            throw std::runtime_error(strprintf("Snapshot directory %s is not empty", dir.string()));
+
+        fs::create_directories(dir);
+
+        sqlite3* source = nullptr;
+        if (sqlite3_open_v2((dbPath / "main.sqlite3").string().c_str(), &source, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+            sqlite3_close(source);
+            throw std::runtime_error("Failed to open main database for snapshot");
+        }
+
+        SnapshotManifest manifest;
+        try
+        {
+            string attach = "attach database '" + (dbPath / "web.sqlite3").string() + "' as web;";
+            if (sqlite3_exec(source, attach.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+                throw std::runtime_error("Failed to attach web database for snapshot");
+
+            // Deferred transaction takes read snapshot of every database at its first read,
+            // so both are read right away before anything else. Images contain only blocks committed
+            // completely; web has all of them as long as the caller drained WebPostProcessor.
+            if (sqlite3_exec(source, "begin;", nullptr, nullptr, nullptr) != SQLITE_OK ||
+                sqlite3_exec(source, "select count(*) from main.sqlite_master; select count(*) from web.sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK)
+                throw std::runtime_error("Failed to begin snapshot transaction");
+
+            if (onReadSnapshot)
+                onReadSnapshot();
+
+            sqlite3_stmt* stmt = nullptr;
+            string sql = R"sql(
+                select BlockHash, Height
+                from Transactions
+                where Height = (select max(Height) from Transactions) and BlockHash is not null
+                limit 1
+            )sql";
+
+            if (sqlite3_prepare_v2(source, sql.c_str(), (int) sql.size(), &stmt, nullptr) != SQLITE_OK)
+                throw std::runtime_error("Failed to read snapshot height");
+
+            if (sqlite3_step(stmt) == SQLITE_ROW)
+            {
+                manifest.BlockHash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+                manifest.Height = sqlite3_column_int(stmt, 1);
+            }
+            sqlite3_finalize(stmt);
+
+            if (manifest.Height < 0)
+                throw std::runtime_error("Pocket DB has no indexed blocks");
+
+            for (const char* dbName : SNAPSHOT_DATABASES)
+                ExportDatabase(source, dbName, dir, chunkSize, manifest);
+
+            sqlite3_exec(source, "commit;", nullptr, nullptr, nullptr);
+        }
+        catch (const std::exception&)
+        {
+            sqlite3_exec(source, "rollback;", nullptr, nullptr, nullptr);
+            sqlite3_close(source);
+            throw;
+        }
+
+        sqlite3_close(source);
+
+        std::ofstream out((dir / SNAPSHOT_MANIFEST).string(), std::ios::trunc);
+        out << "height " << manifest.Height << "\n";
+        out << "block " << manifest.BlockHash << "\n";
+        for (const auto& chunk : manifest.Chunks)
+            out << "chunk " << chunk.File << " " << chunk.Size << " " << chunk.Hash << "\n";
+        out << "hash " << manifest.Hash().GetHex() << "\n";
+        out.close();
+
+        if (out.fail())
+            throw std::runtime_error("Failed to write snapshot manifest");
+
+        LogPrintf("Pocket DB snapshot exported at height %d with %d chunks: %s\n",
+            manifest.Height, manifest.Chunks.size(), manifest.Hash().GetHex());
+
+        return manifest;
+    }
+
+    void Snapshot::ExportDatabase(sqlite3* source, const string& dbName, const fs::path& dir, size_t chunkSize, SnapshotManifest& manifest)
+    {
+        fs::path image = dir / (dbName + ".sqlite3");
+
+        sqlite3* dest = nullptr;
+        if (sqlite3_open_v2(image.string().c_str(), &dest, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK)
+        {
+            sqlite3_close(dest);
+            throw std::runtime_error(strprintf("Failed to create snapshot image of %s database", dbName));
+        }
+
+        // Backup runs in the open read transaction of source connection
+        int rc = SQLITE_ERROR;
+        if (auto backup = sqlite3_backup_init(dest, "main", source, dbName.c_str()))
+        {
+            rc = sqlite3_backup_step(backup, -1);
+            sqlite3_backup_finish(backup);
+        }
+
+        // Mempool transactions are not part of any block - a node loading the snapshot has own mempool
+        if (rc == SQLITE_DONE && dbName == "main")
+        {
+            rc = sqlite3_exec(dest, R"sql(
+                delete from Payload where TxHash in (select Hash from Transactions where Height is null);
+                delete from TxOutputs where TxHash in (select Hash from Transactions where Height is null);
+                delete from TxInputs where SpentTxHash in (select Hash from Transactions where Height is null);
+                delete from Transactions where Height is null;
+            )sql", nullptr, nullptr, nullptr);
+
+            if (rc == SQLITE_OK)
+                rc = SQLITE_DONE;
+        }
+
+        // Image without free pages and WAL is smaller and opened by any connection
+        if (rc == SQLITE_DONE)
+            rc = sqlite3_exec(dest, "pragma journal_mode = delete; vacuum;", nullptr, nullptr, nullptr);
+
+        sqlite3_close(dest);
+
+        if (rc != SQLITE_OK && rc != SQLITE_DONE)
+            throw std::runtime_error(strprintf("Failed to copy %s database into snapshot: %s", dbName, sqlite3_errstr(rc)));
+
+        std::ifstream in(image.string(), std::ios::binary);
+        vector<char> buffer(std::min(chunkSize, (size_t) 1024 * 1024));
+
+        for (int index = 0; in.peek() != EOF; index++)
+        {
+            SnapshotChunk chunk{ strprintf("%s.%04d.chunk", dbName, index), 0, "" };
+            std::ofstream out((dir / chunk.File).string(), std::ios::binary | std::ios::trunc);
+            CSHA256 hasher;
+
+            while ((size_t) chunk.Size < chunkSize && in)
+            {
+                in.read(buffer.data(), std::min(buffer.size(), chunkSize - (size_t) chunk.Size));
+                auto read = in.gcount();
+                if (read <= 0)
+                    break;
+
+                out.write(buffer.data(), read);
+                hasher.Write((const unsigned char*) buffer.data(), read);
+                chunk.Size += read;
+            }
+
+            out.close();
+            if (out.fail())
+                throw std::runtime_error(strprintf("Failed to write snapshot chunk %s", chunk.File));
+
+            unsigned char hash[CSHA256::OUTPUT_SIZE];
+            hasher.Finalize(hash);
+            chunk.Hash = HexStr(hash, hash + CSHA256::OUTPUT_SIZE);
+
+            manifest.Chunks.push_back(std::move(chunk));
+        }
+
+        in.close();
+        fs::remove(image);
+    }
+
+    string Snapshot::HashFile(const fs::path& file, int64_t& size, std::ostream* copy)
+    {
+        std::ifstream in(file.string(), std::ios::binary);
+        if (!in)
+            return "";
+
+        CSHA256 hasher;
+        vector<char> buffer(1024 * 1024);
+        size = 0;
+
+        while (in)
+        {
+            in.read(buffer.data(), buffer.size());
+            auto read = in.gcount();
+            if (read <= 0)
+                break;
+
+            hasher.Write((const unsigned char*) buffer.data(), read);
+            size += read;
+
+            if (copy)
+                copy->write(buffer.data(), read);
+        }
+
+        unsigned char hash[CSHA256::OUTPUT_SIZE];
+        hasher.Finalize(hash);
+        return HexStr(hash, hash + CSHA256::OUTPUT_SIZE);
+    }
+
+    bool Snapshot::ReadManifest(const fs::path& dir, SnapshotManifest& manifest, uint256& hash)
+    {
+        std::ifstream in((dir / SNAPSHOT_MANIFEST).string());
+        if (!in)
+            return false;
+
+        string line;
+        string declaredHash;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            string key;
+            fields >> key;
+
+            if (key == "height")
+                fields >> manifest.Height;
+            else if (key == "block")
+                fields >> manifest.BlockHash;
+            else if (key == "hash")
+                fields >> declaredHash;
+            else if (key == "chunk")
+            {
+                SnapshotChunk chunk;
+                fields >> chunk.File >> chunk.Size >> chunk.Hash;
+                manifest.Chunks.push_back(chunk);
+            }
+
+            if (fields.fail())
+                return false;
+        }
+
+        // Chunk files are opened by name - do not allow paths outside of snapshot directory
+        for (const auto& chunk : manifest.Chunks)
+            if (chunk.File.find_first_of("/\\") != string::npos || chunk.File.find("..") != string::npos)
+                return false;
+
+        hash = manifest.Hash();
+        return manifest.Height >= 0 && !manifest.Chunks.empty() && declaredHash == hash.GetHex();
+    }
+
+    bool Snapshot::IsTrusted(const SnapshotManifest& manifest, const uint256& hash)
+    {
+        // Operator can trust own snapshot explicitly
+        if (gArgs.IsArgSet("-pocketdbsnapshothash"))
+            return uint256S(gArgs.GetArg("-pocketdbsnapshothash", "")) == hash;
+
+        const auto& snapshots = Params().PocketDbSnapshots();
+        auto it = snapshots.find(manifest.Height);
+        return it != snapshots.end() &&
+            it->second.blockHash.GetHex() == manifest.BlockHash &&
+            it->second.snapshotHash == hash;
+    }
+
+    bool Snapshot::Import(const fs::path& dir, const fs::path& dbPath, string& error)
+    {
+        if (fs::exists(dbPath / "main.sqlite3"))
+        {
+            LogPrintf("Pocket DB already exists, snapshot %s is not loaded\n", dir.string());
+            return true;
+        }
+
+        // Web database left without main is not replaced silently
+        if (fs::exists(dbPath / "web.sqlite3"))
+        {
+            error = strprintf("Pocket DB web database %s exists without main database, remove it to load snapshot",
+                (dbPath / "web.sqlite3").string());
+            return false;
+        }
+
+        SnapshotManifest manifest;
+        uint256 hash;
+        if (!ReadManifest(dir, manifest, hash))
+        {
+            error = strprintf("Invalid Pocket DB snapshot manifest in %s", dir.string());
+            return false;
+        }
+
+        if (!IsTrusted(manifest, hash))
+        {
+            error = strprintf("Unknown Pocket DB snapshot %s at height %d", hash.GetHex(), manifest.Height);
+            return false;
+        }
+
+        LogPrintf("Loading Pocket DB snapshot %s at height %d\n", hash.GetHex(), manifest.Height);
+        fs::create_directories(dbPath);
+
+        // Databases are assembled in temporary files and appear only after all chunks are verified
+        vector<fs::path> assembled;
+        auto cleanup = [&]()
+        {
+            for (const auto& file : assembled)
+                fs::remove(file);
+        };
+
+        for (const char* dbName : SNAPSHOT_DATABASES)
+        {
+            fs::path target = dbPath / (string(dbName) + ".sqlite3.snapshot");
+            std::ofstream out(target.string(), std::ios::binary | std::ios::trunc);
+            assembled.push_back(target);
+
+            string prefix = string(dbName) + ".";
+            for (const auto& chunk : manifest.Chunks)
+            {
+                if (chunk.File.compare(0, prefix.size(), prefix) != 0)
+                    continue;
+
+                int64_t size = 0;
+                if (HashFile(dir / chunk.File, size, &out) != chunk.Hash || size != chunk.Size)
+                {
+                    out.close();
+                    cleanup();
+                    error = strprintf("Pocket DB snapshot chunk %s is corrupted", chunk.File);
+                    return false;
+                }
+            }
+
+            out.close();
+            if (out.fail())
+            {
+                cleanup();
+                error = strprintf("Failed to restore %s database from snapshot", dbName);
+                return false;
+            }
+        }
+
+        // `main` is moved last - its existence marks completed import
+        for (int i = (int) assembled.size() - 1; i >= 0; i--)
+        {
+            fs::path dbFile = assembled[i];
+            dbFile.replace_extension();
+
+            fs::remove(fs::path(dbFile.string() + "-wal"));
+            fs::remove(fs::path(dbFile.string() + "-shm"));
+            fs::rename(assembled[i], dbFile);
+        }
+
+        LogPrintf("Pocket DB snapshot loaded, blocks up to height %d are not indexed again\n", manifest.Height);
+        return true;
+    }
+
+} // namespace PocketServices
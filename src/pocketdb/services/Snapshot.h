@@ -0,0 +1,70 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_SNAPSHOT_H
+#define POCKETDB_SNAPSHOT_H
+
+#include "fs.h"
+#include "uint256.h"
+
+#include <sqlite3.h>
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace PocketServices
+{
+    using std::string;
+    using std::vector;
+
+    static const size_t DEFAULT_SNAPSHOT_CHUNK_SIZE = 64 * 1024 * 1024;
+
+    struct SnapshotChunk
+    {
+        string File;
+        int64_t Size;
+        string Hash;
+    };
+
+    struct SnapshotManifest
+    {
+        int Height = -1;
+        string BlockHash;
+        vector<SnapshotChunk> Chunks;
+
+        // Hash of height, block and all chunks - identifies the whole snapshot
+        uint256 Hash() const;
+    };
+
+    // Image of `main` and `web` databases at the last indexed block.
+    // Blocks existing in pocketdb are not checked and indexed again by ConnectBlock,
+    // so a node started from the snapshot only validates the chain up to its height.
+    class Snapshot
+    {
+    public:
+        // Export image of databases from dbPath into empty directory, mempool transactions are excluded.
+        // Blocks in `main` are not queued for `web` on the importing node, so callers stop connecting blocks
+        // and drain WebPostProcessor before export; onReadSnapshot is called once images are fixed and
+        // blocks may be connected again.
+        static SnapshotManifest Export(const fs::path& dbPath, const fs::path& dir, size_t chunkSize,
+            const std::function<void()>& onReadSnapshot = nullptr);
+
+        // Verify snapshot against known hashes and restore databases into dbPath.
+        // Existing databases are never overwritten - snapshot is skipped if `main` exists
+        // and refused if only `web` exists.
+        static bool Import(const fs::path& dir, const fs::path& dbPath, string& error);
+
+        static bool ReadManifest(const fs::path& dir, SnapshotManifest& manifest, uint256& hash);
+        static bool IsTrusted(const SnapshotManifest& manifest, const uint256& hash);
+
+    private:
+        static void ExportDatabase(sqlite3* source, const string& dbName, const fs::path& dir, size_t chunkSize, SnapshotManifest& manifest);
+        // Hash of file content, written also into copy if set
+        static string HashFile(const fs::path& file, int64_t& size, std::ostream* copy = nullptr);
+    };
+} // namespace PocketServices
+
+#endif // POCKETDB_SNAPSHOT_H
@@ -0,0 +1,255 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include "pocketdb/services/WalCheckpoint.h"
+#include "util.h"
+
+namespace PocketServices
+{
+    WalCheckpointer::WalCheckpointer() = default;
+
+    void WalCheckpointer::Start(boost::thread_group& threadGroup)
+    {
+        idleTimeout = gArgs.GetArg("-sqlwalidletimeout", 10) * 1000;
+        walSizeLimit = gArgs.GetArg("-sqlwalsizelimit", 256) * 1024 * 1024;
+        readerPause = gArgs.GetArg("-sqlwalreaderpause", 250);
+
+        auto dbBasePath = GetDataDir() / "pocketdb";
+        walMainPath = (dbBasePath / "main.sqlite3-wal").string();
+        walWebPath = (dbBasePath / "web.sqlite3-wal").string();
+
+        shutdown = false;
+        threadGroup.create_thread([this] { Worker(); });
+    }
+
+    void WalCheckpointer::Stop()
+    {
+        // Signal for complete all tasks
+        {
+            LOCK(_queue_mutex);
+
+            shutdown = true;
+            _queue_cond.notify_all();
+        }
+
+        // Never leave readers paused
+        ResumeReaders();
+
+        // Wait all tasks completed
+        LOCK(_running_mutex);
+    }
+
+    void WalCheckpointer::Notify(int height)
+    {
+        LOCK(_queue_mutex);
+        _notified_height = height;
+        _queue_cond.notify_one();
+    }
+
+    void WalCheckpointer::Worker()
+    {
+        LogPrintf("WalCheckpointer: starting thread worker\n");
+
+        LOCK(_running_mutex);
+
+        // Run database
+        auto dbBasePath = (GetDataDir() / "pocketdb").string();
+
+        sqliteDbInst = make_shared<SQLiteDatabase>(false);
+        sqliteDbInst->Init(dbBasePath, "main");
+        sqliteDbInst->AttachDatabase("web");
+
+        // RESTART and TRUNCATE modes wait writer and readers with busy-handler
+        sqlite3_busy_timeout(sqliteDbInst->m_db, (int) readerPause);
+
+        // Start worker infinity loop
+        while (true)
+        {
+            int height = -1;
+
+            {
+                WAIT_LOCK(_queue_mutex, lock);
+
+                if (!shutdown && _notified_height < 0)
+                    _queue_cond.wait_for(lock, chrono::milliseconds(idleTimeout));
+
+                if (shutdown) break;
+
+                height = _notified_height;
+                _notified_height = -1;
+            }
+
+            {
+                LOCK(_stat_mutex);
+                if (height >= 0) _last_height = height;
+            }
+
+            // Copy all committed pages back to database without blocking anyone
+            Checkpoint(SQLITE_CHECKPOINT_PASSIVE, _stat_passive);
+
+            // WAL file is never shrunk by PASSIVE checkpoints - reset it if grew too much
+            if (GetWalSize() > walSizeLimit)
+            {
+                PauseReaders();
+
+                if (!Checkpoint(SQLITE_CHECKPOINT_TRUNCATE, _stat_truncate))
+                    Checkpoint(SQLITE_CHECKPOINT_RESTART, _stat_truncate);
+
+                ResumeReaders();
+            }
+        }
+
+        // Final checkpoint before shutdown
+        Checkpoint(SQLITE_CHECKPOINT_TRUNCATE, _stat_truncate);
+
+        // Shutdown DB
+        sqliteDbInst->m_connection_mutex.lock();
+
+        sqliteDbInst->DetachDatabase("web");
+        sqliteDbInst->Close();
+
+        sqliteDbInst->m_connection_mutex.unlock();
+        sqliteDbInst = nullptr;
+
+        LogPrintf("WalCheckpointer: thread worker exit\n");
+    }
+
+    bool WalCheckpointer::Checkpoint(int mode, WalCheckpointStat& stat)
+    {
+        int64_t nTime1 = GetTimeMicros();
+
+        int logFrames = 0;
+        int checkpointedFrames = 0;
+        int res = SQLITE_OK;
+
+        {
+            lock_guard<mutex> lock(sqliteDbInst->m_connection_mutex);
+            res = sqlite3_wal_checkpoint_v2(sqliteDbInst->m_db, nullptr, mode, &logFrames, &checkpointedFrames);
+        }
+
+        int64_t nTime2 = GetTimeMicros();
+
+        bool ok = (res == SQLITE_OK);
+
+        {
+            LOCK(_stat_mutex);
+
+            stat.Count += 1;
+            stat.Failed += ok ? 0 : 1;
+            stat.LastTime = GetTime();
+            stat.LastDuration = nTime2 - nTime1;
+            stat.MaxDuration = max(stat.MaxDuration, stat.LastDuration);
+            stat.TotalDuration += stat.LastDuration;
+            stat.LastLogFrames = logFrames;
+            stat.LastCheckpointedFrames = checkpointedFrames;
+        }
+
+        LogPrint(BCLog::SQLBENCH, "SQL Bench `WalCheckpointer::Checkpoint` (mode %d, result %d, frames %d/%d): %.2fms\n",
+            mode, res, checkpointedFrames, logFrames, 0.001 * (double)(nTime2 - nTime1));
+
+        return ok;
+    }
+
+    bool WalCheckpointer::PauseReaders()
+    {
+        WAIT_LOCK(_readers_mutex, lock);
+
+        _readers_paused = true;
+        _readers_recycled += (int64_t) _readers.size();
+
+        // Wait for the current readers to release their snapshots
+        return _readers_cond.wait_for(lock, chrono::milliseconds(readerPause), [this]() { return _readers.empty(); });
+    }
+
+    void WalCheckpointer::ResumeReaders()
+    {
+        LOCK(_readers_mutex);
+        _readers_paused = false;
+        _readers_cond.notify_all();
+    }
+
+    void WalCheckpointer::ReaderBegin(const SQLiteDatabase* db)
+    {
+        WAIT_LOCK(_readers_mutex, lock);
+
+        // Readers pause only briefly - checkpoint will fallback to RESTART if the pause expires
+        if (_readers_paused)
+            _readers_cond.wait_for(lock, chrono::milliseconds(readerPause), [this]() { return !_readers_paused; });
+
+        _readers[db] = GetTimeMillis();
+    }
+
+    void WalCheckpointer::ReaderEnd(const SQLiteDatabase* db)
+    {
+        LOCK(_readers_mutex);
+        if (_readers.erase(db) > 0 && _readers_paused && _readers.empty())
+            _readers_cond.notify_all();
+    }
+
+    int64_t WalCheckpointer::GetWalSize() const
+    {
+        int64_t size = 0;
+
+        for (const auto& path : { walMainPath, walWebPath })
+        {
+            boost::system::error_code ec;
+            auto fileSize = fs::file_size(path, ec);
+            if (!ec) size += (int64_t) fileSize;
+        }
+
+        return size;
+    }
+
+    tuple<int, int64_t> WalCheckpointer::GetReadersLag()
+    {
+        LOCK(_readers_mutex);
+
+        int64_t now = GetTimeMillis();
+        int64_t lag = 0;
+        for (const auto& reader : _readers)
+            lag = max(lag, now - reader.second);
+
+        return { (int) _readers.size(), lag };
+    }
+
+    UniValue WalCheckpointer::Stats()
+    {
+        const auto statToJson = [](const WalCheckpointStat& stat)
+        {
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("Count", stat.Count);
+            result.pushKV("Failed", stat.Failed);
+            result.pushKV("LastTime", stat.LastTime);
+            result.pushKV("LastDuration", stat.LastDuration);
+            result.pushKV("MaxDuration", stat.MaxDuration);
+            result.pushKV("AvgDuration", stat.Count > 0 ? stat.TotalDuration / stat.Count : 0);
+            result.pushKV("LastLogFrames", stat.LastLogFrames);
+            result.pushKV("LastCheckpointedFrames", stat.LastCheckpointedFrames);
+            return result;
+        };
+
+        auto[readers, readersLag] = GetReadersLag();
+
+        UniValue result(UniValue::VOBJ);
+        result.pushKV("WalSize", GetWalSize());
+        result.pushKV("WalSizeLimit", walSizeLimit);
+        result.pushKV("Readers", readers);
+        result.pushKV("ReadersLag", readersLag);
+
+        {
+            LOCK(_readers_mutex);
+            result.pushKV("ReadersRecycled", _readers_recycled);
+        }
+
+        {
+            LOCK(_stat_mutex);
+            result.pushKV("LastHeight", _last_height);
+            result.pushKV("Passive", statToJson(_stat_passive));
+            result.pushKV("Truncate", statToJson(_stat_truncate));
+        }
+
+        return result;
+    }
+
+} // PocketServices
@@ -0,0 +1,93 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#ifndef POCKETDB_WAL_CHECKPOINT_H
+#define POCKETDB_WAL_CHECKPOINT_H
+
+#include <boost/thread.hpp>
+#include <univalue.h>
+#include "utiltime.h"
+#include "sync.h"
+
+#include "pocketdb/SQLiteDatabase.h"
+
+namespace PocketServices
+{
+    using namespace std;
+    using namespace PocketDb;
+
+    struct WalCheckpointStat
+    {
+        int64_t Count = 0;
+        int64_t Failed = 0;
+        int64_t LastTime = 0;
+        int64_t LastDuration = 0;
+        int64_t MaxDuration = 0;
+        int64_t TotalDuration = 0;
+        int LastLogFrames = 0;
+        int LastCheckpointedFrames = 0;
+    };
+
+    // Background checkpoint scheduler for pocketdb WAL files.
+    // SQLite auto-checkpoint is disabled for write connections and checkpoints
+    // are executed from a separate thread between blocks:
+    //  - PASSIVE after every connected block or on idle timeout
+    //  - TRUNCATE (or RESTART as fallback) when WAL grows over -sqlwalsizelimit.
+    //    For this case new read transactions are paused for a short time so that
+    //    long-lived readers release their snapshots and the WAL can be reset.
+    class WalCheckpointer
+    {
+    public:
+        WalCheckpointer();
+        void Start(boost::thread_group& threadGroup);
+        void Stop();
+
+        // Wake up scheduler after new block indexed
+        void Notify(int height);
+
+        // Read transactions registry for tracking reader lag
+        void ReaderBegin(const SQLiteDatabase* db);
+        void ReaderEnd(const SQLiteDatabase* db);
+
+        UniValue Stats();
+
+    private:
+        SQLiteDatabaseRef sqliteDbInst;
+        string walMainPath;
+        string walWebPath;
+
+        int64_t idleTimeout = 10 * 1000;
+        int64_t walSizeLimit = 256 * 1024 * 1024;
+        int64_t readerPause = 250;
+        bool shutdown = false;
+
+        Mutex _running_mutex;
+        Mutex _queue_mutex;
+        std::condition_variable _queue_cond;
+        int _notified_height = -1;
+
+        Mutex _readers_mutex;
+        std::condition_variable _readers_cond;
+        bool _readers_paused = false;
+        map<const SQLiteDatabase*, int64_t> _readers;
+        int64_t _readers_recycled = 0;
+
+        Mutex _stat_mutex;
+        WalCheckpointStat _stat_passive;
+        WalCheckpointStat _stat_truncate;
+        int _last_height = -1;
+
+        void Worker();
+
+        bool Checkpoint(int mode, WalCheckpointStat& stat);
+        bool PauseReaders();
+        void ResumeReaders();
+
+        int64_t GetWalSize() const;
+        tuple<int, int64_t> GetReadersLag();
+    };
+
+} // PocketServices
+
+#endif // POCKETDB_WAL_CHECKPOINT_H
@@ -11,7 +11,12 @@ namespace PocketServices
 
     void WebPostProcessor::Start(boost::thread_group& threadGroup)
     {
-        shutdown = false;
+        {
+            LOCK(_queue_mutex);
+            shutdown = false;
+            started = true;
+        }
+
         threadGroup.create_thread([this] { Worker(); });
     }
 
@@ -44,6 +49,9 @@ namespace PocketServices
 
         webRepoInst = make_shared<WebRepository>(*sqliteDbInst);
 
+        contentSearch = gArgs.GetBoolArg("-searchranked", false);
+        PrepareContentSearch();
+
         // Start worker infinity loop
         while (true)
         {
@@ -59,6 +67,7 @@ namespace PocketServices
 
                 queueRecord = std::move(_queue_records.front());
                 _queue_records.pop_front();
+                processing = true;
             }
 
             switch (queueRecord.Type)
@@ -67,6 +76,7 @@ namespace PocketServices
                 {
                     ProcessTags(queueRecord.BlockHash);
                     ProcessSearchContent(queueRecord.BlockHash);
+                    MaintainContentSearch();
                     break;
                 }
                 case QueueRecordType::BlockHeight:
@@ -78,6 +88,18 @@ namespace PocketServices
                 default:
                     break;
             }
+
+            {
+                LOCK(_queue_mutex);
+                processing = false;
+                _queue_cond.notify_all();
+            }
+        }
+
+        {
+            LOCK(_queue_mutex);
+            started = false;
+            _queue_cond.notify_all();
         }
 
         // Shutdown DB
@@ -100,7 +122,7 @@ namespace PocketServices
         QueueRecord rcrd = { QueueRecordType::BlockHash, blockHash, -1 };
         LOCK(_queue_mutex);
         _queue_records.emplace_back(rcrd);
-        _queue_cond.notify_one();
+        _queue_cond.notify_all();
     }
 
     void WebPostProcessor::Enqueue(int blockHeight)
@@ -108,7 +130,14 @@ namespace PocketServices
         QueueRecord rcrd = { QueueRecordType::BlockHeight, "", blockHeight };
         LOCK(_queue_mutex);
         _queue_records.emplace_back(rcrd);
-        _queue_cond.notify_one();
+        _queue_cond.notify_all();
+    }
+
+    void WebPostProcessor::WaitIdle()
+    {
+        WAIT_LOCK(_queue_mutex, lock);
+        while (started && !shutdown && (processing || !_queue_records.empty()))
+            _queue_cond.wait(lock);
     }
 
     void WebPostProcessor::ProcessTags(const string& blockHash)
@@ -188,7 +217,7 @@ namespace PocketServices
             LogPrint(BCLog::BENCH, "    - WebPostProcessor::ProcessSearchContent (Prepare): %.2fms\n", 0.001 * (double)(nTime3 - nTime2));
 
             // Insert content
-            webRepoInst->UpsertContent(contentList);
+            webRepoInst->UpsertContent(contentList, contentSearch);
 
             int64_t nTime4 = GetTimeMicros();
             LogPrint(BCLog::BENCH, "    - WebPostProcessor::ProcessSearchContent (Upsert): %.2fms\n", 0.001 * (double)(nTime4 - nTime3));
@@ -199,6 +228,65 @@ namespace PocketServices
         }
     }
 
+    void WebPostProcessor::PrepareContentSearch()
+    {
+        try
+        {
+            if (!contentSearch)
+            {
+                // Index is not updated without -searchranked - drop it so that it is filled again once enabled
+                if (!webRepoInst->IsContentSearchEmpty())
+                    webRepoInst->ClearContentSearch();
+
+                return;
+            }
+
+            if (!webRepoInst->IsContentSearchEmpty())
+                return;
+
+            int64_t nTime1 = GetTimeMicros();
+
+            webRepoInst->FillContentSearch();
+            webRepoInst->OptimizeContentSearch();
+
+            int64_t nTime2 = GetTimeMicros();
+            LogPrintf("WebPostProcessor: ranked search index filled in %.2fms\n", 0.001 * (double)(nTime2 - nTime1));
+        }
+        catch (const std::exception& e)
+        {
+            LogPrintf("Warning: WebPostProcessor::PrepareContentSearch - %s\n", e.what());
+        }
+    }
+
+    void WebPostProcessor::MaintainContentSearch()
+    {
+        // Every block adds small FTS segments - merge them a little at a time so that
+        // posting lists of popular terms stay in few segments
+        static const int MERGE_INTERVAL = 10;
+        static const int MERGE_PAGES = 500;
+        static const int OPTIMIZE_INTERVAL = 5760;
+
+        if (!contentSearch || ++contentSearchBlocks % MERGE_INTERVAL != 0)
+            return;
+
+        try
+        {
+            int64_t nTime1 = GetTimeMicros();
+
+            if (contentSearchBlocks % OPTIMIZE_INTERVAL == 0)
+                webRepoInst->OptimizeContentSearch();
+            else
+                webRepoInst->MergeContentSearch(MERGE_PAGES);
+
+            int64_t nTime2 = GetTimeMicros();
+            LogPrint(BCLog::BENCH, "    - WebPostProcessor::MaintainContentSearch: %.2fms\n", 0.001 * (double)(nTime2 - nTime1));
+        }
+        catch (const std::exception& e)
+        {
+            LogPrintf("Warning: WebPostProcessor::MaintainContentSearch - %s\n", e.what());
+        }
+    }
+
     void WebPostProcessor::ProcessBadges(int blockHeight)
     {
         try
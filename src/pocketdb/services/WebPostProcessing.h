@@ -42,6 +42,9 @@ namespace PocketServices
 
         void Enqueue(const string& blockHash);
         void Enqueue(int blockHeight);
+
+        // Wait until all queued blocks are processed - callers hold cs_main so that nothing new is queued
+        void WaitIdle();
                 
         void ProcessTags(const string& blockHash);
         void ProcessSearchContent(const string& blockHash);
@@ -49,12 +52,22 @@ namespace PocketServices
         void ProcessBadges(int blockHeight);
         void ProcessAuthors(int blockHeight);
 
+        // Ranked search index: initial fill for existing databases and incremental merge of FTS segments
+        void PrepareContentSearch();
+        void MaintainContentSearch();
+
     private:
         SQLiteDatabaseRef sqliteDbInst;
         WebRepositoryRef webRepoInst;
 
         uint32_t sleep = 5 * 1000;
         bool shutdown = false;
+        bool started = false;
+        bool processing = false;
+
+        // Ranked search index is kept only with -searchranked
+        bool contentSearch = false;
+        int contentSearchBlocks = 0;
 
         Mutex _running_mutex;
         Mutex _queue_mutex;
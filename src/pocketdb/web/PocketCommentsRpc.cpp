@@ -6,7 +6,7 @@
 
 namespace PocketWeb::PocketWebRpc
 {
-    UniValue GetCommentsByPost(const JSONRPCRequest& request)
+    string GetCommentsByPost(const JSONRPCRequest& request)
     {
         if (request.fHelp)
             throw runtime_error(
@@ -44,12 +44,12 @@ namespace PocketWeb::PocketWebRpc
         }
 
         if (!cmntHashes.empty())
-            return request.DbConnection()->WebRpcRepoInst->GetCommentsByHashes(cmntHashes, addressHash);
+            return request.DbConnection()->WebRpcRepoInst->GetCommentsByHashes(cmntHashes, addressHash).write();
         else
             return request.DbConnection()->WebRpcRepoInst->GetCommentsByPost(postHash, parentHash, addressHash);
     }
 
-    UniValue GetLastComments(const JSONRPCRequest& request)
+    string GetLastComments(const JSONRPCRequest& request)
     {
         if (request.fHelp)
             throw runtime_error(
@@ -13,8 +13,9 @@ namespace PocketWeb::PocketWebRpc
 {
     using namespace std;
     
-    UniValue GetCommentsByPost(const JSONRPCRequest& request);
-    UniValue GetLastComments(const JSONRPCRequest& request);
+    // Raw handlers - result JSON is written directly from SQL rows
+    string GetCommentsByPost(const JSONRPCRequest& request);
+    string GetLastComments(const JSONRPCRequest& request);
 } // namespace PocketWeb
 
 
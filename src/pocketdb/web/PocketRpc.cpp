@@ -63,8 +63,8 @@ static const CRPCCommand commands[] =
     {"tags",           "gettags",                          &GetTags,                        {"address", "count", "height", "lang"}},
 
     // Comments
-    {"comments",        "getcomments",                      &GetCommentsByPost,             {"postid", "parentid", "address", "ids"}},
-    {"comments",        "getlastcomments",                  &GetLastComments,               {"count", "address"}},
+    {"comments",        "getcomments",                      nullptr,                        {"postid", "parentid", "address", "ids"}, &GetCommentsByPost},
+    {"comments",        "getlastcomments",                  nullptr,                        {"count", "address"}, &GetLastComments},
 
     // Accounts
     {"accounts",        "getuserprofile",                   &GetAccountProfiles,             {"addresses", "short"}},
@@ -10,7 +10,7 @@ namespace PocketWeb::PocketWebRpc
     {
         if (request.fHelp)
             throw runtime_error(
-                "search \"keyword\", \"type\", topBlock, pageStart, pageSize, \"address\"\n"
+                "search \"keyword\", \"type\", topBlock, pageStart, pageSize, \"address\", \"lang\", \"orderby\", lastId\n"
                 "\nSearch data in DB.\n"
                 "\nArguments:\n"
                 "1. \"keyword\"     (string) String for search\n"
@@ -18,7 +18,10 @@ namespace PocketWeb::PocketWebRpc
                 "3. \"topBlock\"  (int, optional) Top block for search.\n"
                 "4. \"pageStart\" (int, optional) Pagination start. Default 0\n"
                 "5. \"pageSize\" (int, optional) Pagination count. Default 10\n"
-                "5. \"address\"     (string, optional) Filter by address\n"
+                "6. \"address\"     (string, optional) Filter by address\n"
+                "7. \"lang\"        (string, optional) Filter by language. Only with -searchranked\n"
+                "8. \"orderby\"     (string, optional) \"rank\" - order by relevance with recency decay, otherwise newest first. Only with -searchranked\n"
+                "9. \"lastId\"      (int or numeric string, optional) Return results older than this content id instead of pageStart. Only with -searchranked\n"
             );
 
         RPCTypeCheck(request.params, {UniValue::VSTR, UniValue::VSTR});
@@ -71,6 +74,32 @@ namespace PocketWeb::PocketWebRpc
             searchRequest.Address = request.params[5].get_str();
         }
 
+        // Lang
+        if (request.params.size() > 6 && request.params[6].isStr())
+            searchRequest.Lang = request.params[6].get_str();
+
+        // OrderBy
+        if (request.params.size() > 7 && request.params[7].isStr())
+        {
+            string orderBy = request.params[7].get_str();
+            HtmlUtils::StringToLower(orderBy);
+            searchRequest.OrderByRank = (orderBy == "rank");
+        }
+
+        // LastId
+        if (request.params.size() > 8 && !request.params[8].isNull())
+        {
+            const UniValue& lastId = request.params[8];
+            if (lastId.isNum())
+                searchRequest.LastId = lastId.get_int64();
+            else if (!lastId.isStr() || !ParseInt64(lastId.get_str(), &searchRequest.LastId))
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid lastId: expected integer");
+        }
+
+        // Recency decay of ranked search is counted from top block
+        if (searchRequest.OrderByRank && searchRequest.TopBlock <= 0)
+            searchRequest.TopBlock = chainActive.Height();
+
         // -----------------------------------------------------------
         UniValue result(UniValue::VOBJ);
         
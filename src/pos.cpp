@@ -8,6 +8,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <crypto/common.h>
 #include <pos.h>
 #include <pow.h>
 #include <primitives/block.h>
@@ -321,6 +322,101 @@ bool CheckStakeKernelHash(CBlockIndex *pindexPrev, unsigned int nBits, CBlockInd
     return true;
 }
 
+std::vector<const StakeKernelTable::Candidate*> StakeKernelTable::Update(const CBlockIndex* pindexPrev, unsigned int nBits,
+    const std::vector<Coin>& coins)
+{
+    // Stake modifier is taken from tip so all prefixes are rebuilt for new tip
+    if (m_tip != pindexPrev->GetBlockHash() || m_bits != nBits)
+    {
+        m_candidates.clear();
+        m_tip = pindexPrev->GetBlockHash();
+        m_bits = nBits;
+    }
+
+    arith_uint256 bnTargetBase;
+    bnTargetBase.SetCompact(nBits);
+
+    std::set<COutPoint> used;
+    std::vector<const Candidate*> result;
+    result.reserve(coins.size());
+
+    for (const auto& coin : coins)
+    {
+        COutPoint prevout(coin.tx->GetHash(), coin.n);
+        used.insert(prevout);
+
+        if (auto it = m_candidates.find(prevout); it != m_candidates.end())
+        {
+            result.push_back(&it->second);
+            continue;
+        }
+
+        auto itBlock = mapBlockIndex.find(coin.hashBlock);
+        if (itBlock == mapBlockIndex.end() || !chainActive.Contains(itBlock->second) || coin.n >= coin.tx->vout.size())
+        {
+            result.push_back(nullptr);
+            continue;
+        }
+
+        Candidate candidate;
+        candidate.prevout = prevout;
+        candidate.nTimeBlockFrom = itBlock->second->GetBlockTime();
+        candidate.nTimeTxPrev = coin.tx->nTime;
+
+        // Weighted target - same as CheckStakeKernelHash
+        arith_uint256 bnWeight = std::min(coin.tx->vout[coin.n].nValue, Params().GetConsensus().nStakeMaximumThreshold);
+        candidate.bnTarget = bnTargetBase * bnWeight;
+
+        // Kernel prefix: nStakeModifier << nTimeBlockFrom << txPrev->nTime << prevout.hash << prevout.n
+        unsigned char prefix[52];
+        WriteLE64(prefix, pindexPrev->nStakeModifier);
+        WriteLE32(prefix + 8, candidate.nTimeBlockFrom);
+        WriteLE32(prefix + 12, candidate.nTimeTxPrev);
+        memcpy(prefix + 16, prevout.hash.begin(), 32);
+        WriteLE32(prefix + 48, prevout.n);
+        candidate.hasher.Write(prefix, sizeof(prefix));
+
+        auto[it, inserted] = m_candidates.emplace(prevout, std::move(candidate));
+        result.push_back(&it->second);
+    }
+
+    // Forget spent coins
+    for (auto it = m_candidates.begin(); it != m_candidates.end();)
+        it = used.count(it->first) ? std::next(it) : m_candidates.erase(it);
+
+    return result;
+}
+
+bool StakeKernelTable::Search(const Candidate& candidate, int64_t nTimeTx, unsigned int nInterval, unsigned int& nOffset) const
+{
+    const unsigned int nStakeMinAge = Params().GetConsensus().nStakeMinAge;
+
+    for (unsigned int n = 0; n < nInterval; n++)
+    {
+        unsigned int nTime = (unsigned int) (nTimeTx - n);
+
+        // Timestamps are searched backward so there is no valid timestamp after first violation
+        if (nTime < candidate.nTimeTxPrev || candidate.nTimeBlockFrom + nStakeMinAge > nTime)
+            return false;
+
+        unsigned char time[4];
+        WriteLE32(time, nTime);
+
+        unsigned char buf[CSHA256::OUTPUT_SIZE];
+        uint256 hash;
+        CSHA256(candidate.hasher).Write(time, sizeof(time)).Finalize(buf);
+        CSHA256().Write(buf, sizeof(buf)).Finalize(hash.begin());
+
+        if (UintToArith256(hash) <= candidate.bnTarget)
+        {
+            nOffset = n;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 // Check whether the coinstake timestamp meets protocol
 bool CheckCoinStakeTimestamp(int nHeight, int64_t nTimeBlock, int64_t nTimeTx)
 {
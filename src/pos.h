@@ -8,6 +8,8 @@
 #include <validation.h>
 #include <streams.h>
 #include <key_io.h>
+#include <arith_uint256.h>
+#include <crypto/sha256.h>
 
 #include "pocketdb/consensus/Lottery.h"
 #include "pocketdb/helpers/TransactionHelper.h"
@@ -57,6 +59,44 @@ bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, int64_t nTime, con
 bool CheckStake(const std::shared_ptr<CBlock> pblock, const PocketBlockRef& pocketBlock, std::shared_ptr<CWallet> wallet, CChainParams const & chainparams);
 #endif
 
+// Stake kernel search table.
+// Kernel inputs of stakeable outpoints (blockFrom time, txPrev time, weighted target) are
+// resolved once per tip and the hasher is primed with the serialized kernel prefix, so the
+// search over (coin x timestamp) only appends nTimeTx and finalizes the double SHA256.
+// Found kernels must be confirmed with CheckKernel before use.
+class StakeKernelTable
+{
+public:
+    struct Coin
+    {
+        CTransactionRef tx;
+        unsigned int n;
+        uint256 hashBlock;
+    };
+
+    struct Candidate
+    {
+        COutPoint prevout;
+        unsigned int nTimeBlockFrom = 0;
+        unsigned int nTimeTxPrev = 0;
+        arith_uint256 bnTarget;
+        CSHA256 hasher;
+    };
+
+    // Resolve candidates for coins at the given tip. Cache is dropped when tip or nBits changed.
+    // Result has the same order as coins, unresolved coins (unconfirmed, not in active chain) are nullptr.
+    std::vector<const Candidate*> Update(const CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<Coin>& coins);
+
+    // Search timestamps from nTimeTx back to nTimeTx - nInterval + 1.
+    // Returns offset of the first timestamp satisfying the kernel target.
+    bool Search(const Candidate& candidate, int64_t nTimeTx, unsigned int nInterval, unsigned int& nOffset) const;
+
+private:
+    uint256 m_tip;
+    unsigned int m_bits = 0;
+    std::map<COutPoint, Candidate> m_candidates;
+};
+
 bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, CBlockIndex& blockFrom, CTransactionRef const & txPrev, COutPoint const & prevout, unsigned int nTimeTx, arith_uint256& hashProofOfStake, CDataStream& hashProofOfStakeSource, arith_uint256& targetProofOfStake, bool fPrintProofOfStake = true);
 
 bool CheckProofOfStake(CBlockIndex* pindexPrev, CTransactionRef const & tx, unsigned int nBits, arith_uint256& hashProofOfStake, CDataStream& hashProofOfStakeSource, arith_uint256& targetProofOfStake, std::vector<CScriptCheck> *pvChecks, bool fCheckSignature = false);
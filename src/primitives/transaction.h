@@ -13,6 +13,7 @@
 #include <uint256.h>
 #include "core_io.h"
 #include "streams.h"
+#include <atomic>
 #include <tuple>
 
 /**
@@ -330,6 +331,9 @@ private:
     const uint256 hash;
     const uint256 m_witness_hash;
 
+    /** Memory only. Pocketnet transaction type decoded from outputs, -1 until decoded. */
+    mutable std::atomic<int> m_pocket_type{-1};
+
     uint256 ComputeHash() const;
     uint256 ComputeWitnessHash() const;
 
@@ -340,6 +344,7 @@ public:
     /** Convert a CMutableTransaction into a CTransaction. */
     CTransaction(const CMutableTransaction& tx);
     CTransaction(CMutableTransaction&& tx);
+    CTransaction(const CTransaction& tx);
 
     template<typename Stream>
     inline void Serialize(Stream& s) const
@@ -360,6 +365,10 @@ public:
     const uint256& GetHash() const { return hash; }
     const uint256& GetWitnessHash() const { return m_witness_hash; };
 
+    // Type depends only on transaction data so it is decoded once (see PocketHelpers::TransactionHelper::ParseType)
+    int GetPocketType() const { return m_pocket_type.load(std::memory_order_relaxed); }
+    void SetPocketType(int type) const { m_pocket_type.store(type, std::memory_order_relaxed); }
+
     // Return sum of txouts.
     CAmount GetValueOut() const;
     // GetValueIn() is a method on CCoinsViewCache, because
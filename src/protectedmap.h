@@ -1,55 +1,105 @@
 #ifndef POCKETCOIN_PROTECTEDMAP_H
 #define POCKETCOIN_PROTECTEDMAP_H
 
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <map>
+#include <memory>
 #include <utility>
+#include <vector>
 #include <functional>
 
-template<class Key, class Value>
+// Concurrent map split into independently locked shards.
+// Elements are stored by shared pointer so Iterate works on a snapshot:
+// shard locks are held only while copying pointers and callbacks run unlocked.
+// Changes made by callbacks to the element are kept, elements inserted or
+// erased during iteration may be missed or still visited.
+template<class Key, class Value, size_t Shards = 16>
 class ProtectedMap
 {
 public:
-    auto insert_or_assign(const Key& key, const Value& value)
+    using Element = std::pair<const Key, Value>;
+
+    void insert_or_assign(const Key& key, const Value& value)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_map.insert_or_assign(key, value);
+        put(key, std::make_shared<Element>(key, value));
     }
 
-    auto insert_or_assign(const Key& key, Value&& value)
+    void insert_or_assign(const Key& key, Value&& value)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_map.insert_or_assign(key, std::forward<Value>(value));
+        put(key, std::make_shared<Element>(key, std::move(value)));
     }
 
-    auto erase(const Key& key)
+    size_t erase(const Key& key)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_map.erase(key);
+        auto& shard = get_shard(key);
+        std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+        auto erased = shard.m_map.erase(key);
+        m_size -= (int) erased;
+        return erased;
     }
 
-    auto empty()
+    // Element by key or null - changes of the returned element are kept in map
+    std::shared_ptr<Element> find(const Key& key)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_map.empty();
+        auto& shard = get_shard(key);
+        std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+        auto it = shard.m_map.find(key);
+        return it != shard.m_map.end() ? it->second : nullptr;
     }
 
-    void Iterate(const std::function<void(std::pair<const Key, Value>&)>& func)
+    bool empty() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        for (auto& elem : m_map) {
-            func(elem);
+        return m_size.load() == 0;
+    }
+
+    void Iterate(const std::function<void(Element&)>& func)
+    {
+        std::vector<std::shared_ptr<Element>> snapshot;
+        snapshot.reserve(count());
+
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.m_mutex);
+            for (auto& elem : shard.m_map)
+                snapshot.push_back(elem.second);
         }
+
+        for (auto& elem : snapshot)
+            func(*elem);
     }
 
-    int count()
+    int count() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_map.size();
+        return m_size.load();
     }
 
 protected:
-    std::map<Key, Value> m_map;
-    std::mutex m_mutex;
+    struct Shard
+    {
+        std::map<Key, std::shared_ptr<Element>> m_map;
+        std::mutex m_mutex;
+    };
+
+    std::array<Shard, Shards> m_shards;
+    std::atomic<int> m_size{0};
+
+    Shard& get_shard(const Key& key)
+    {
+        return m_shards[std::hash<Key>{}(key) % Shards];
+    }
+
+    void put(const Key& key, std::shared_ptr<Element> elem)
+    {
+        auto& shard = get_shard(key);
+        std::lock_guard<std::mutex> lock(shard.m_mutex);
+
+        auto[it, inserted] = shard.m_map.insert_or_assign(key, std::move(elem));
+        if (inserted)
+            m_size += 1;
+    }
 };
-#endif // POCKETCOIN_PROTECTEDMAP_H
\ No newline at end of file
+#endif // POCKETCOIN_PROTECTEDMAP_H
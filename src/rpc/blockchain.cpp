@@ -30,6 +30,8 @@
 #include <validation.h>
 #include <validationinterface.h>
 #include <warnings.h>
+#include <pocketdb/pocketnet.h>
+#include <pocketdb/services/Snapshot.h>
 #include <assert.h>
 #include <stdint.h>
 #include <univalue.h>
@@ -1923,6 +1925,62 @@ static UniValue savemempool(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
+static UniValue exportpocketdbsnapshot(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2) {
+        throw std::runtime_error(
+            "exportpocketdbsnapshot \"directory\" ( chunksize )\n"
+            "\nExports consistent image of Pocket DB at the last indexed block into empty directory.\n"
+            "New nodes restore it with -loadpocketdbsnapshot and do not index blocks up to its height again.\n"
+            "\nArguments:\n"
+            "1. \"directory\"    (string, required) Target directory, relative paths are relative to the data directory\n"
+            "2. chunksize      (numeric, optional, default=64) Size of snapshot chunk files in MiB\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"height\" : n,          (numeric) Height of the last block in snapshot\n"
+            "  \"blockhash\" : \"hash\", (string) Hash of the last block in snapshot\n"
+            "  \"hash\" : \"hash\",      (string) Snapshot hash to verify on import\n"
+            "  \"chunks\" : n           (numeric) Number of chunk files\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("exportpocketdbsnapshot", "\"snapshot\"") + HelpExampleRpc("exportpocketdbsnapshot", "\"snapshot\""));
+    }
+
+    size_t chunkSize = PocketServices::DEFAULT_SNAPSHOT_CHUNK_SIZE;
+    if (!request.params[1].isNull())
+        chunkSize = (size_t) std::max(request.params[1].get_int(), 1) * 1024 * 1024;
+
+    fs::path dir = fs::absolute(request.params[0].get_str(), GetDataDir());
+
+    // Importing node does not queue blocks of the snapshot for web database - no block is connected
+    // until all queued blocks are in web and read snapshot of both databases is taken
+    bool locked = true;
+    ENTER_CRITICAL_SECTION(cs_main);
+    auto unlock = [&locked]() {
+        if (locked) {
+            locked = false;
+            LEAVE_CRITICAL_SECTION(cs_main);
+        }
+    };
+
+    PocketServices::SnapshotManifest manifest;
+    try {
+        PocketServices::WebPostProcessorInst.WaitIdle();
+        manifest = PocketServices::Snapshot::Export(GetDataDir() / "pocketdb", dir, chunkSize, unlock);
+    } catch (...) {
+        unlock();
+        throw;
+    }
+    unlock();
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("height", manifest.Height);
+    result.pushKV("blockhash", manifest.BlockHash);
+    result.pushKV("hash", manifest.Hash().GetHex());
+    result.pushKV("chunks", (int) manifest.Chunks.size());
+    return result;
+}
+
 //! Search for a given set of pubkey scripts
 bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results)
 {
@@ -2187,6 +2245,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        {} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        {"height"} },
     { "blockchain",         "savemempool",            &savemempool,            {} },
+    { "blockchain",         "exportpocketdbsnapshot", &exportpocketdbsnapshot, {"directory","chunksize"} },
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
     { "blockchain",         "preciousblock",          &preciousblock,          {"blockhash"} },
     { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects"} },
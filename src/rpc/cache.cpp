@@ -5,8 +5,13 @@
 #include <rpc/cache.h>
 #include <rpc/server.h>
 
+#include <atomic>
+
 static const unsigned int MAX_CACHE_SIZE_MB = 64;
 
+static std::atomic<int64_t> g_rpc_executed{0};
+static std::atomic<int64_t> g_rpc_coalesced{0};
+
 RPCCacheInfoGroup::RPCCacheInfoGroup(int lifeTime, std::set<std::string> methods)
     : lifeTime(std::move(lifeTime)),
       methods(std::move(methods))
@@ -36,10 +41,22 @@ RPCCacheEntry::RPCCacheEntry(UniValue data, int validUntill)
     : m_data(std::move(data)),
       m_validUntill(std::move(validUntill))
 {}
+RPCCacheEntry::RPCCacheEntry(std::string raw, int validUntill)
+    : m_validUntill(std::move(validUntill)),
+      m_raw(std::move(raw))
+{}
 const UniValue& RPCCacheEntry::GetData() const
 {
     return m_data;
 }
+const std::string& RPCCacheEntry::GetRaw() const
+{
+    return m_raw;
+}
+size_t RPCCacheEntry::GetSize() const
+{
+    return m_raw.empty() ? m_data.write().size() : m_raw.size();
+}
 const int& RPCCacheEntry::GetValidUntill() const
 {
     return m_validUntill;
@@ -74,7 +91,7 @@ void RPCCache::ClearOverdue(int height)
     for (auto itr = m_cache.begin(); itr != m_cache.end();) {
         if(itr->second.GetValidUntill() <= height) {
             // TODO: calculate size more accurate, probably move to RPCCache entry or smth.
-            m_cacheSize -= (itr->first.size() + itr->second.GetData().write().size()); // Decreasing cache size 
+            m_cacheSize -= (itr->first.size() + itr->second.GetSize()); // Decreasing cache size 
             itr = m_cache.erase(itr);
         } else {
             itr++;
@@ -143,6 +160,140 @@ void RPCCache::PutRpcCache(const JSONRPCRequest& req, const UniValue& content)
     }
 }
 
+std::string RPCCache::GetRawRpcCache(const JSONRPCRequest& req)
+{
+    // Return empty string if method not supported for caching.
+    if (m_supportedMethods.find(req.strMethod) == m_supportedMethods.end())
+        return "";
+
+    std::string path = MakeHashKey(req);
+
+    LOCK(CacheMutex);
+
+    ClearOverdue(chainActive.Height());
+
+    if (auto entry = m_cache.find(path); entry != m_cache.end()) {
+        LogPrint(BCLog::RPC, "RPC Cache get found %s in cache\n", path);
+        return entry->second.GetRaw();
+    }
+
+    return "";
+}
+
+void RPCCache::PutRawRpcCache(const JSONRPCRequest& req, const std::string& content)
+{
+    auto group = m_supportedMethods.find(req.strMethod);
+    if (group == m_supportedMethods.end())
+        return;
+
+    std::string path = MakeHashKey(req);
+
+    auto currentHeight = chainActive.Height();
+    auto validUntill = currentHeight + group->second;
+
+    LOCK(CacheMutex);
+
+    int size = path.size() + content.size();
+
+    ClearOverdue(currentHeight);
+
+    if (m_maxCacheSize < size + m_cacheSize) {
+        LogPrint(BCLog::RPC, "RPC cache over size limit: current = %d, max = %d\n", size + m_cacheSize, m_maxCacheSize);
+        return;
+    }
+
+    if (auto entry = m_cache.find(path); entry != m_cache.end()) {
+        m_cacheSize -= entry->second.GetSize();
+        m_cacheSize += content.size();
+    } else {
+        LogPrint(BCLog::RPC, "RPC cache put '%s', size %d\n", path, size);
+        m_cacheSize += size;
+    }
+    m_cache.insert_or_assign(path, RPCCacheEntry(content, validUntill));
+}
+
+template<typename T>
+T RPCCache::Coalesce(const JSONRPCRequest& req, const std::function<T()>& func, T RPCInflight::*result)
+{
+    if (m_supportedMethods.find(req.strMethod) == m_supportedMethods.end())
+        return func();
+
+    std::string key = MakeHashKey(req);
+    std::shared_ptr<RPCInflight> inflight;
+    bool leader = false;
+    {
+        LOCK(InflightMutex);
+        auto& entry = m_inflight[key];
+        if (!entry)
+        {
+            entry = std::make_shared<RPCInflight>();
+            leader = true;
+        }
+        inflight = entry;
+    }
+
+    if (!leader)
+    {
+        g_rpc_coalesced++;
+
+        std::unique_lock<std::mutex> lock(inflight->mutex);
+        inflight->cond.wait(lock, [&] { return inflight->done; });
+
+        if (inflight->error)
+            std::rethrow_exception(inflight->error);
+
+        return (*inflight).*result;
+    }
+
+    g_rpc_executed++;
+
+    T ret;
+    std::exception_ptr error;
+    try
+    {
+        ret = func();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    // Later requests take result from cache
+    {
+        LOCK(InflightMutex);
+        m_inflight.erase(key);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(inflight->mutex);
+        inflight->done = true;
+        inflight->error = error;
+        if (!error)
+            (*inflight).*result = ret;
+    }
+    inflight->cond.notify_all();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return ret;
+}
+
+UniValue RPCCache::ExecuteRpc(const JSONRPCRequest& req, const std::function<UniValue()>& func)
+{
+    return Coalesce<UniValue>(req, func, &RPCInflight::data);
+}
+
+std::string RPCCache::ExecuteRawRpc(const JSONRPCRequest& req, const std::function<std::string()>& func)
+{
+    return Coalesce<std::string>(req, func, &RPCInflight::raw);
+}
+
+std::tuple<int64_t, int64_t> RPCCache::CoalesceStatistic()
+{
+    return { g_rpc_executed.load(), g_rpc_coalesced.load() };
+}
+
 std::tuple<int64_t, int64_t> RPCCache::Statistic()
 {
     LOCK(CacheMutex);
@@ -6,6 +6,10 @@
 #define POCKETCOIN_RPC_CACHE_H
 #include <univalue.h>
 #include <sync.h>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <logging.h>
 #include <validation.h>
 
@@ -32,11 +36,27 @@ class RPCCacheEntry
 {
 public:
     RPCCacheEntry(UniValue data, int validUntill);
+    RPCCacheEntry(std::string raw, int validUntill);
     const UniValue& GetData() const;
+    const std::string& GetRaw() const;
     const int& GetValidUntill() const;
+    size_t GetSize() const;
 private:
     int m_validUntill;
     UniValue m_data;
+    // JSON text of result for methods with raw handlers
+    std::string m_raw;
+};
+
+// Result of cacheable request executed right now - shared by all callers with the same key
+struct RPCInflight
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool done = false;
+    UniValue data;
+    std::string raw;
+    std::exception_ptr error;
 };
 
 class RPCCache
@@ -46,6 +66,9 @@ private:
     std::map<std::string, RPCCacheEntry> m_cache;
     int m_cacheSize;
     int m_maxCacheSize;
+
+    Mutex InflightMutex;
+    std::map<std::string, std::shared_ptr<RPCInflight>> m_inflight;
     // <methodName, lifeTime>
     std::map<std::string, int> m_supportedMethods = {
         { "getlastcomments", 1 },
@@ -94,6 +117,10 @@ private:
     std::string MakeHashKey(const JSONRPCRequest& req);
     void ClearOverdue(int height);
 
+    // Run func as the only executor of key - concurrent callers wait for its result
+    template<typename T>
+    T Coalesce(const JSONRPCRequest& req, const std::function<T()>& func, T RPCInflight::*result);
+
 public:
     RPCCache();
 
@@ -107,8 +134,22 @@ public:
 
     void PutRpcCache(const JSONRPCRequest& req, const UniValue& content);
 
+    std::string GetRawRpcCache(const JSONRPCRequest& req);
+
+    void PutRawRpcCache(const JSONRPCRequest& req, const std::string& content);
+
+    /* Execute not cached request once for all concurrent identical requests
+     * (single-flight). Methods not supported for caching are always executed.
+     */
+    UniValue ExecuteRpc(const JSONRPCRequest& req, const std::function<UniValue()>& func);
+
+    std::string ExecuteRawRpc(const JSONRPCRequest& req, const std::function<std::string()>& func);
+
     std::tuple<int64_t, int64_t> Statistic();
 
+    // Requests executed and requests served with result of another identical request in flight - for all tables
+    static std::tuple<int64_t, int64_t> CoalesceStatistic();
+
 };
 
 #endif // POCKETCOIN_RPC_CACHE_H
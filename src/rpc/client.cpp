@@ -129,6 +129,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
         {"importmulti",                   1, "options"},
         {"verifychain",                   0, "checklevel"},
         {"verifychain",                   1, "nblocks"},
+        {"exportpocketdbsnapshot",        1, "chunksize"},
         {"getblockstats",                 0, "hash_or_height"},
         {"getblockstats",                 1, "stats"},
         {"pruneblockchain",               0, "height"},
@@ -147,6 +148,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
         {"bumpfee",                       1, "options"},
         {"disconnectnode",                1, "nodeid"},
         {"addwitnessaddress",             1, "p2sh"},
+        {"getsqlstats",                   0, "reset"},
         // Echo with conversion (For testing only)
         {"echojson",                      0, "arg0"},
         {"echojson",                      1, "arg1"},
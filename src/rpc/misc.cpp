@@ -17,6 +17,7 @@
 #include <utilstrencodings.h>
 #include <validation.h>
 #include <warnings.h>
+#include <pocketdb/SQLiteProfiler.h>
 #include <cstdint>
 
 #ifdef HAVE_MALLOC_INFO
@@ -320,6 +321,47 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
     }
 }
 
+static UniValue getsqlstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getsqlstats ( reset )\n"
+            "Returns SQL execution statistics aggregated by pocketdb repository method.\n"
+            "Statistics are collected if node started with -sqlprofile (enabled by default).\n"
+            "Arguments:\n"
+            "1. reset         (boolean, optional, default=false) Reset statistics after returning them.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"since\": xxxxx,             (numeric) Time of start collecting statistics\n"
+            "  \"methods\": [                (array) Methods ordered by statements execution time\n"
+            "    {\n"
+            "      \"method\": \"name\",      (string) Repository method\n"
+            "      \"calls\": xxxxx,         (numeric) Number of method calls (SQL transactions)\n"
+            "      \"failed\": xxxxx,        (numeric) Number of failed calls\n"
+            "      \"totaltime\": xxxxx,     (numeric) Total calls time in microseconds\n"
+            "      \"avgtime\": xxxxx,       (numeric) Average call time in microseconds\n"
+            "      \"maxtime\": xxxxx,       (numeric) Maximum call time in microseconds\n"
+            "      \"histogram\": [...],     (array) Calls count by latency buckets, \"le\" is upper bound in microseconds\n"
+            "      \"statements\": xxxxx,    (numeric) Number of executed statements\n"
+            "      \"statementstime\": xxxxx, (numeric) Statements execution time reported by SQLite in microseconds\n"
+            "      \"fullscansteps\": xxxxx, (numeric) Rows stepped in full table scans\n"
+            "      \"vmsteps\": xxxxx,       (numeric) Virtual machine operations\n"
+            "      \"sorts\": xxxxx,         (numeric) Sort operations\n"
+            "      \"autoindexes\": xxxxx,   (numeric) Rows inserted into automatic indexes\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n" +
+            HelpExampleCli("getsqlstats", "") + HelpExampleCli("getsqlstats", "true") + HelpExampleRpc("getsqlstats", "true"));
+
+    UniValue result = PocketDb::SQLiteProfilerInst.Stats();
+
+    if (!request.params[0].isNull() && request.params[0].get_bool())
+        PocketDb::SQLiteProfilerInst.Reset();
+
+    return result;
+}
+
 static void EnableOrDisableLogCategories(UniValue cats, bool enable)
 {
     cats = cats.get_array();
@@ -464,6 +506,7 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "stop",                   &stop,                   {}},
     { "control",            "getmemoryinfo",          &getmemoryinfo,          {"mode"}},
+    { "control",            "getsqlstats",            &getsqlstats,            {"reset"}},
     { "control",            "logging",                &logging,                {"include", "exclude"}},
     { "control",            "uptime",                 &uptime,                 {}},
     { "util",               "validateaddress",        &validateaddress,        {"address"}},
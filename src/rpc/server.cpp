@@ -20,6 +20,8 @@
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <memory> // for unique_ptr
 #include <unordered_map>
 
@@ -180,7 +182,9 @@ std::string CRPCTable::help(const std::string& strCommand, const JSONRPCRequest&
         try
         {
             rpcfn_type pfn = pcmd->actor;
-            if (setDone.insert(pfn).second)
+            if (!pfn && pcmd->rawActor)
+                (*pcmd->rawActor)(jreq);
+            else if (setDone.insert(pfn).second)
                 (*pfn)(jreq);
         }
         catch (const std::exception& e)
@@ -368,11 +372,71 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req, const C
     return rpc_result;
 }
 
-std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, const CRPCTable& tableRPC)
+/** Elements of batch request shared by threads executing them */
+struct JSONRPCBatch
 {
+    const JSONRPCRequest* jreq;
+    const UniValue* vReq;
+    const CRPCTable* table;
+
+    std::atomic<size_t> next{0};
+    std::vector<UniValue> results;
+
+    Mutex cs;
+    std::condition_variable cond;
+    size_t done = 0;
+
+    // Take elements until all are taken - threads started after that do nothing
+    // and never touch request that can be already gone
+    void Run(const DbConnectionRef& dbConnection)
+    {
+        for (size_t i = next++; i < results.size(); i = next++)
+        {
+            JSONRPCRequest elemReq = *jreq;
+            if (dbConnection)
+                elemReq.SetDbConnection(dbConnection);
+
+            UniValue result = JSONRPCExecOne(elemReq, (*vReq)[i], *table);
+
+            LOCK(cs);
+            results[i] = std::move(result);
+            if (++done == results.size())
+                cond.notify_all();
+        }
+    }
+};
+
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, const CRPCTable& tableRPC,
+    const RPCBatchSpawn& spawn, int parallel)
+{
+    auto batch = std::make_shared<JSONRPCBatch>();
+    batch->jreq = &jreq;
+    batch->vReq = &vReq;
+    batch->table = &tableRPC;
+    batch->results.resize(vReq.size());
+
+    // Calling thread executes elements too so batch completes even if no helper is free
+    if (spawn)
+    {
+        size_t helpers = std::min((size_t) std::max(parallel, 1), vReq.size());
+        for (size_t i = 1; i < helpers; i++)
+        {
+            if (!spawn([batch](const DbConnectionRef& dbConnection) { batch->Run(dbConnection); }))
+                break;
+        }
+    }
+
+    batch->Run(jreq.DbConnection());
+
+    {
+        WAIT_LOCK(batch->cs, lock);
+        while (batch->done < batch->results.size())
+            batch->cond.wait(lock);
+    }
+
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx], tableRPC));
+    for (auto& result : batch->results)
+        ret.push_back(std::move(result));
 
     return ret.write() + "\n";
 }
@@ -447,29 +511,104 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
         throw JSONRPCError(RPC_METHOD_NOT_FOUND, "Method not found");
 
     const CRPCCommand *pcmd =  (*it).second;
+
+    // Raw handlers are parsed back for callers that need UniValue (batch requests)
+    if (!pcmd->actor)
+    {
+        UniValue ret;
+        if (!ret.read(executeRaw(*pcmd, request)))
+            throw JSONRPCError(RPC_MISC_ERROR, "Invalid JSON result");
+
+        return ret;
+    }
+
     g_rpcSignals.PreCommand(*pcmd);
     auto start = gStatEngineInstance.GetCurrentSystemTime();
 
-    // See if this request reply is cached
+    // See if this request reply is cached, identical requests in flight are executed once
     UniValue ret = cache->GetRpcCache(request);
     if (ret.isNull())
     {
-        try
+        ret = cache->ExecuteRpc(request, [&]()
         {
-            // Execute, convert arguments to array if necessary
-            if (request.params.isObject()) {
-                ret = pcmd->actor(transformNamedArguments(request, pcmd->argNames));
-            } else {
-                ret = pcmd->actor(request);
+            UniValue result;
+            try
+            {
+                // Execute, convert arguments to array if necessary
+                if (request.params.isObject()) {
+                    result = pcmd->actor(transformNamedArguments(request, pcmd->argNames));
+                } else {
+                    result = pcmd->actor(request);
+                }
+
+                // Save return value in cache for later
+                cache->PutRpcCache(request, result);
+            }
+            catch (const std::exception& e)
+            {
+                throw JSONRPCError(RPC_MISC_ERROR, e.what());
             }
 
-            // Save return value in cache for later
-            cache->PutRpcCache(request, ret);
-        }
-        catch (const std::exception& e)
+            return result;
+        });
+    }
+
+    auto stop = gStatEngineInstance.GetCurrentSystemTime();
+
+    auto diff = (stop - start);
+    LogPrint(BCLog::RPC, "RPC Method time %s (%s) - %ldms\n", request.strMethod, request.peerAddr.substr(0, request.peerAddr.find(':')), diff.count());
+
+    return ret;
+}
+
+bool CRPCTable::executeRaw(const JSONRPCRequest &request, std::string& result) const
+{
+    auto it = mapCommands.find(request.strMethod);
+    if (it == mapCommands.end() || !it->second->rawActor || it->second->actor)
+        return false;
+
+    // Return immediately if in warmup
+    {
+        LOCK(cs_rpcWarmup);
+        if (fRPCInWarmup)
+            throw JSONRPCError(RPC_IN_WARMUP, rpcWarmupStatus);
+    }
+
+    result = executeRaw(*it->second, request);
+    return true;
+}
+
+std::string CRPCTable::executeRaw(const CRPCCommand& cmd, const JSONRPCRequest& request) const
+{
+    g_rpcSignals.PreCommand(cmd);
+    auto start = gStatEngineInstance.GetCurrentSystemTime();
+
+    // See if this request reply is cached, identical requests in flight are executed once
+    std::string ret = cache->GetRawRpcCache(request);
+    if (ret.empty())
+    {
+        ret = cache->ExecuteRawRpc(request, [&]()
         {
-            throw JSONRPCError(RPC_MISC_ERROR, e.what());
-        }
+            std::string result;
+            try
+            {
+                // Execute, convert arguments to array if necessary
+                if (request.params.isObject()) {
+                    result = cmd.rawActor(transformNamedArguments(request, cmd.argNames));
+                } else {
+                    result = cmd.rawActor(request);
+                }
+
+                // Save return value in cache for later
+                cache->PutRawRpcCache(request, result);
+            }
+            catch (const std::exception& e)
+            {
+                throw JSONRPCError(RPC_MISC_ERROR, e.what());
+            }
+
+            return result;
+        });
     }
 
     auto stop = gStatEngineInstance.GetCurrentSystemTime();
@@ -132,6 +132,7 @@ void RPCUnsetTimerInterface(RPCTimerInterface *iface);
 void RPCRunLater(const std::string& name, std::function<void()> func, int64_t nSeconds);
 
 typedef UniValue(*rpcfn_type)(const JSONRPCRequest& jsonRequest);
+typedef std::string(*rpcrawfn_type)(const JSONRPCRequest& jsonRequest);
 
 class CRPCCommand
 {
@@ -140,6 +141,9 @@ public:
     std::string name;
     rpcfn_type actor;
     std::vector<std::string> argNames;
+
+    /** Handler returning result as JSON text - used instead of actor if set */
+    rpcrawfn_type rawActor = nullptr;
 };
 
 /**
@@ -150,6 +154,8 @@ class CRPCTable
 private:
     std::map<std::string, const CRPCCommand*> mapCommands;
     std::unique_ptr<RPCCache> cache {new RPCCache()};
+
+    std::string executeRaw(const CRPCCommand& cmd, const JSONRPCRequest& request) const;
 public:
     const CRPCCommand* operator[](const std::string& name) const;
     std::string help(const std::string& name, const JSONRPCRequest& helpreq) const;
@@ -163,6 +169,15 @@ public:
      */
     UniValue execute(const JSONRPCRequest &request) const;
 
+    /**
+     * Execute a method registered with raw JSON handler without building UniValue result.
+     * @param request The JSONRPCRequest to execute
+     * @param[out] result JSON text of the result
+     * @returns false if method has no raw handler - execute() should be used.
+     * @throws an exception (UniValue) when an error happens.
+     */
+    bool executeRaw(const JSONRPCRequest &request, std::string& result) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -205,7 +220,13 @@ extern std::string HelpExampleRpc(const std::string& methodname, const std::stri
 void StartRPC();
 void InterruptRPC();
 void StopRPC();
-std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, const CRPCTable& tableRPC);
+/** Runs task on another thread with its own database connection, returns false if task is not accepted */
+typedef std::function<bool(std::function<void(const DbConnectionRef&)>)> RPCBatchSpawn;
+
+/** Execute batch request. With spawn up to parallel elements are executed concurrently,
+ * results are returned in order of requests. */
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, const CRPCTable& tableRPC,
+    const RPCBatchSpawn& spawn = nullptr, int parallel = 1);
 
 // Retrieves any serialization flags requested in command line argument
 int RPCSerializationFlags();
@@ -4,6 +4,7 @@
 
 #include "chainparams.h"
 #include "validation.h"
+#include "rpc/cache.h"
 #include "clientversion.h"
 #include <boost/thread.hpp>
 #include <chrono>
@@ -227,6 +228,12 @@ namespace Statistic
             rpcStat.pushKV("AvgReqTime", GetAvgRequestTimeSince(since).count());
             rpcStat.pushKV("AvgExecTime", GetAvgExecutionTimeSince(since).count());
             rpcStat.pushKV("UniqueIPs", (int) unique_ips_count);
+
+            // Totals since start of cacheable requests executed and served by identical request in flight
+            auto[executed, coalesced] = RPCCache::CoalesceStatistic();
+            rpcStat.pushKV("CacheExecuted", executed);
+            rpcStat.pushKV("CacheCoalesced", coalesced);
+
             if (g_logger->WillLogCategory(BCLog::STATDETAIL))
             {
                 rpcStat.pushKV("UniqueIps", unique_ips_json);
@@ -265,6 +272,8 @@ namespace Statistic
             sqlite3_db_status(db, SQLITE_DBSTATUS_CACHE_SPILL, &current, &highWater, true);
             sqlStats.pushKV("CacheSpill", current);
 
+            sqlStats.pushKV("WAL", PocketServices::WalCheckpointerInst.Stats());
+
             result.pushKV("SQL", sqlStats);
 
             return result;
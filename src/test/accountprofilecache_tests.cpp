@@ -0,0 +1,132 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/services/ChainPostProcessing.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+using namespace PocketDb;
+using namespace PocketServices;
+
+BOOST_FIXTURE_TEST_SUITE(accountprofilecache_tests, TestingSetup)
+
+static const int BASE_HEIGHT = 1000000;
+static const int ACCOUNTS = 8;
+
+struct TestPostProcessing : public ChainPostProcessing
+{
+    using ChainPostProcessing::InvalidateAccountProfiles;
+};
+
+static void Exec(const std::string& sql)
+{
+    BOOST_REQUIRE(sqlite3_exec(SQLiteDbInst.m_db, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK);
+}
+
+static std::string Address(int id)
+{
+    return "addr" + std::to_string(id);
+}
+
+// Accounts with ids 1..ACCOUNTS registered in the first block
+static void InsertAccounts()
+{
+    for (int id = 1; id <= ACCOUNTS; id++)
+        Exec(strprintf("insert into Transactions (Type, Hash, Time, Height, Last, Id, String1) values (100, 'account%d', 0, %d, 1, %d, '%s')",
+            id, BASE_HEIGHT, id, Address(id)));
+}
+
+static void FillCache()
+{
+    int64_t version = AccountProfileCacheInst.Version();
+    for (int id = 1; id <= ACCOUNTS; id++)
+    {
+        UniValue profile(UniValue::VOBJ);
+        profile.pushKV("address", Address(id));
+        AccountProfileCacheInst.Put(id, Address(id), profile, version);
+    }
+}
+
+static std::set<int> Cached()
+{
+    std::set<int> ids;
+    for (int id = 1; id <= ACCOUNTS; id++)
+    {
+        UniValue profile;
+        if (AccountProfileCacheInst.Get(id, profile))
+            ids.insert(id);
+    }
+    return ids;
+}
+
+static TransactionIndexingInfo TxInfo(TxType type)
+{
+    TransactionIndexingInfo txInfo;
+    txInfo.Hash = InsecureRand256().GetHex();
+    txInfo.BlockNumber = 1;
+    txInfo.Time = 0;
+    txInfo.Type = type;
+    return txInfo;
+}
+
+BOOST_AUTO_TEST_CASE(profile_cache_block_touches)
+{
+    AccountProfileCacheInst.Clear();
+    InsertAccounts();
+
+    // Transaction String1/2/3 and account ratings touch accounts
+    int height = BASE_HEIGHT + 1;
+    Exec(strprintf("insert into Transactions (Type, Hash, Time, Height, String1, String2) values (302, 'subscribe', 0, %d, '%s', '%s')",
+        height, Address(1), Address(2)));
+    Exec(strprintf("insert into Transactions (Type, Hash, Time, Height, String1, String3) values (204, 'comment', 0, %d, 'nobody', '%s')",
+        height, Address(3)));
+    Exec(strprintf("insert into Ratings (Type, Last, Height, Id, Value) values (0, 1, %d, 4, 10), (111, 1, %d, 5, 6), (112, 1, %d, 6, 1), (113, 1, %d, 7, 2)",
+        height, height, height, height));
+    // Other ratings do not change profiles
+    Exec(strprintf("insert into Ratings (Type, Last, Height, Id, Value) values (2, 1, %d, 8, 10)", height));
+
+    FillCache();
+    int64_t versionBefore = AccountProfileCacheInst.Version();
+
+    TestPostProcessing::InvalidateAccountProfiles(height, { TxInfo(TxType::ACTION_SUBSCRIBE), TxInfo(TxType::CONTENT_COMMENT) });
+    BOOST_CHECK(Cached() == std::set<int>({ 8 }));
+
+    // Profile read before the block is not cached again
+    UniValue profile(UniValue::VOBJ);
+    AccountProfileCacheInst.Put(1, Address(1), profile, versionBefore);
+    AccountProfileCacheInst.Put(8, Address(8), profile, versionBefore);
+    BOOST_CHECK(Cached() == std::set<int>({ 8 }));
+
+    // Block without account changes keeps all profiles
+    FillCache();
+    TestPostProcessing::InvalidateAccountProfiles(height + 1, { TxInfo(TxType::CONTENT_POST) });
+    BOOST_CHECK_EQUAL(Cached().size(), (size_t) ACCOUNTS);
+}
+
+BOOST_AUTO_TEST_CASE(profile_cache_delete_and_rollback)
+{
+    AccountProfileCacheInst.Clear();
+    InsertAccounts();
+
+    // Deleted account changes profiles of its subscriptions - all profiles are dropped
+    FillCache();
+    int64_t versionBefore = AccountProfileCacheInst.Version();
+    TestPostProcessing::InvalidateAccountProfiles(BASE_HEIGHT + 1, { TxInfo(TxType::ACCOUNT_DELETE) });
+    BOOST_CHECK(Cached().empty());
+
+    AccountProfileCacheInst.Put(1, Address(1), UniValue(UniValue::VOBJ), versionBefore);
+    BOOST_CHECK(Cached().empty());
+
+    // Rollback drops all profiles
+    FillCache();
+    BOOST_CHECK_EQUAL(Cached().size(), (size_t) ACCOUNTS);
+    BOOST_CHECK(ChainPostProcessing::Rollback(BASE_HEIGHT + 1));
+    BOOST_CHECK(Cached().empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -10,6 +10,7 @@
 #include <random.h>
 #include <key.h>
 #include <keystore.h>
+#include <version.h>
 
 #include <test/test_pocketcoin.h>
 
@@ -18,6 +19,10 @@
 #include <validation.h>
 #include <consensus/validation.h>
 
+#include "pocketdb/pocketnet.h"
+#include "pocketdb/models/dto/action/ScoreContent.h"
+#include "pocketdb/services/Serializer.h"
+
 std::vector<std::pair<uint256, CTransactionRef>> extra_txn;
 
 struct RegtestingSetup : public TestingSetup {
@@ -26,7 +31,7 @@ struct RegtestingSetup : public TestingSetup {
 
 BOOST_FIXTURE_TEST_SUITE(blockencodings_tests, RegtestingSetup)
 
-static CBlock BuildBlockTestCase() {
+static CBlock BuildBlockTestCase(bool pocket = false) {
     CBlock block;
     CMutableTransaction tx;
     CBasicKeyStore keystore;
@@ -62,6 +67,11 @@ static CBlock BuildBlockTestCase() {
         tx.vin[i].prevout.n = 0;
     }
     tx.vout[0].nValue = 1000;
+    // Pocket transaction - score with payload relayed next to the block
+    if (pocket) {
+        tx.vout[0].nValue = 0;
+        tx.vout[0].scriptPubKey = CScript() << OP_RETURN << ParseHex(OR_SCORE) << ToByteVector(InsecureRand256());
+    }
     block.vtx[2] = MakeTransactionRef(tx);
 
     bool mutated;
@@ -366,4 +376,186 @@ BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BOOST_CHECK_EQUAL(req1.indexes[3], req2.indexes[3]);
 }
 
+// Pocket part of the block as the sender has it - vtx[2] scores contentHash
+static PocketHelpers::PocketBlockRef BuildPocketBlockTestCase(const CBlock& block, const std::string& contentHash) {
+    auto[ok, pocketBlock] = PocketServices::Serializer::DeserializeBlock(block);
+    BOOST_REQUIRE(ok);
+
+    for (const auto& ptx : pocketBlock) {
+        if (*ptx->GetHash() != block.vtx[2]->GetHash().GetHex())
+            continue;
+
+        auto score = std::static_pointer_cast<PocketTx::ScoreContent>(ptx);
+        score->SetAddress(InsecureRand256().GetHex());
+        score->SetContentTxHash(contentHash);
+        score->SetValue(5);
+    }
+
+    return std::make_shared<PocketHelpers::PocketBlock>(pocketBlock);
+}
+
+static void CheckPocketScore(const CBlock& block, const PocketHelpers::PocketBlockRef& pocketBlock, const std::string& contentHash) {
+    BOOST_REQUIRE(pocketBlock);
+
+    PocketHelpers::PTransactionRef found;
+    for (const auto& ptx : *pocketBlock)
+        if (*ptx->GetHash() == block.vtx[2]->GetHash().GetHex())
+            found = ptx;
+
+    BOOST_REQUIRE(found);
+    auto score = std::static_pointer_cast<PocketTx::ScoreContent>(found);
+    BOOST_REQUIRE(score->GetContentTxHash());
+    BOOST_CHECK_EQUAL(*score->GetContentTxHash(), contentHash);
+    BOOST_REQUIRE(score->GetValue());
+    BOOST_CHECK_EQUAL(*score->GetValue(), 5);
+}
+
+// cmpctblock message of COMPACT_POCKET_VERSION peers - compact block followed by pocket payloads
+static UniValue CompactPocketRoundTrip(const CBlock& block, const std::string& data, CBlockHeaderAndShortTxIDs& shortIDs) {
+    CDataStream stream(SER_NETWORK, COMPACT_POCKET_VERSION);
+    stream << CBlockHeaderAndShortTxIDs(block, true) << data;
+
+    stream >> shortIDs;
+    return PocketServices::Serializer::DeserializeData(stream);
+}
+
+BOOST_AUTO_TEST_CASE(PocketDataNotInMempoolRTTest)
+{
+    CTxMemPool senderPool;
+    CTxMemPool pool;
+    CBlock block(BuildBlockTestCase(true));
+    auto contentHash = InsecureRand256().GetHex();
+    auto senderPocketBlock = BuildPocketBlockTestCase(block, contentHash);
+
+    CValidationState state;
+    BOOST_CHECK_MESSAGE(CheckBlock(block, state, Params().GetConsensus()), "CheckBlock of initial block failed!");
+    BOOST_CHECK(PocketHelpers::TransactionHelper::IsPocketTransaction(block.vtx[2]));
+
+    // Nothing is in sender mempool - payload of score is sent with the block
+    std::string data;
+    BOOST_CHECK(GetCompactPocketData(block, senderPocketBlock, senderPool, data));
+
+    CBlockHeaderAndShortTxIDs shortIDs;
+    UniValue pocketData = CompactPocketRoundTrip(block, data, shortIDs);
+    BOOST_CHECK(pocketData.exists(block.vtx[2]->GetHash().GetHex()));
+
+    PartiallyDownloadedBlock partialBlock(&pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+    partialBlock.AddPocketData(pocketData);
+    BOOST_CHECK( partialBlock.IsTxAvailable(0));
+    BOOST_CHECK(!partialBlock.IsTxAvailable(1));
+    BOOST_CHECK(!partialBlock.IsTxAvailable(2));
+
+    // Transactions come with getblocktxn, payload is taken from received data
+    CBlock block2;
+    PocketHelpers::PocketBlockRef pocketBlock;
+    BOOST_CHECK(partialBlock.FillBlock(block2, {block.vtx[1], block.vtx[2]}, pocketBlock) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    CheckPocketScore(block, pocketBlock, contentHash);
+}
+
+BOOST_AUTO_TEST_CASE(PocketDataInMempoolRTTest)
+{
+    CTxMemPool senderPool;
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    CBlock block(BuildBlockTestCase(true));
+    auto contentHash = InsecureRand256().GetHex();
+    auto senderPocketBlock = BuildPocketBlockTestCase(block, contentHash);
+
+    {
+        LOCK2(senderPool.cs, pool.cs);
+        senderPool.addUnchecked(entry.FromTx(block.vtx[2]));
+        pool.addUnchecked(entry.FromTx(block.vtx[2]));
+    }
+
+    // Score was relayed with its payload - only the block is sent
+    std::string data;
+    BOOST_CHECK(GetCompactPocketData(block, senderPocketBlock, senderPool, data));
+
+    CBlockHeaderAndShortTxIDs shortIDs;
+    UniValue pocketData = CompactPocketRoundTrip(block, data, shortIDs);
+    BOOST_CHECK(!pocketData.exists(block.vtx[2]->GetHash().GetHex()));
+
+    // Mempool transactions keep payloads in pocket store with empty height
+    PocketDb::TransRepoInst.InsertTransactions(*senderPocketBlock);
+
+    std::string fullData;
+    BOOST_CHECK(GetCompactPocketData(block, nullptr, senderPool, fullData));
+    {
+        // Without pocket part of the block payloads are read from pocket store
+        UniValue full;
+        BOOST_CHECK(full.read(fullData));
+        BOOST_CHECK(!full.exists(block.vtx[2]->GetHash().GetHex()));
+    }
+
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+        partialBlock.AddPocketData(pocketData);
+        BOOST_CHECK(partialBlock.IsTxAvailable(2));
+
+        CBlock block2;
+        PocketHelpers::PocketBlockRef pocketBlock;
+        BOOST_CHECK(partialBlock.FillBlock(block2, {block.vtx[1]}, pocketBlock) == READ_STATUS_OK);
+        BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+        CheckPocketScore(block, pocketBlock, contentHash);
+    }
+
+    // Payload is lost from pocket store - reconstruction fails and block is requested with getdata
+    std::vector<std::string> hashes;
+    for (const auto& ptx : *senderPocketBlock)
+        hashes.push_back(*ptx->GetHash());
+    PocketDb::TransRepoInst.CleanTransactions(hashes);
+
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+        partialBlock.AddPocketData(pocketData);
+
+        CBlock block2;
+        PocketHelpers::PocketBlockRef pocketBlock;
+        BOOST_CHECK(partialBlock.FillBlock(block2, {block.vtx[1]}, pocketBlock) == READ_STATUS_FAILED);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PocketDataExtraPoolRTTest)
+{
+    CTxMemPool pool;
+    CBlock block(BuildBlockTestCase(true));
+    auto contentHash = InsecureRand256().GetHex();
+    auto senderPocketBlock = BuildPocketBlockTestCase(block, contentHash);
+
+    // Extra pool transactions have no payload in pocket store
+    std::vector<std::pair<uint256, CTransactionRef>> extra_pocket_txn = {{block.vtx[2]->GetWitnessHash(), block.vtx[2]}};
+
+    std::string data;
+    BOOST_CHECK(GetCompactPocketData(block, senderPocketBlock, pool, data));
+
+    CBlockHeaderAndShortTxIDs shortIDs;
+    UniValue pocketData = CompactPocketRoundTrip(block, data, shortIDs);
+
+    // Without received payload the transaction is requested with getblocktxn
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_pocket_txn) == READ_STATUS_OK);
+        BOOST_CHECK(partialBlock.IsTxAvailable(2));
+        partialBlock.AddPocketData(UniValue(UniValue::VOBJ));
+        BOOST_CHECK(!partialBlock.IsTxAvailable(2));
+    }
+
+    // Received payload completes transaction from extra pool
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_pocket_txn) == READ_STATUS_OK);
+        partialBlock.AddPocketData(pocketData);
+        BOOST_CHECK(partialBlock.IsTxAvailable(2));
+
+        CBlock block2;
+        PocketHelpers::PocketBlockRef pocketBlock;
+        BOOST_CHECK(partialBlock.FillBlock(block2, {block.vtx[1]}, pocketBlock) == READ_STATUS_OK);
+        CheckPocketScore(block, pocketBlock, contentHash);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <blockreader.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <streams.h>
+#include <validation.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockreader_tests, BasicTestingSetup)
+
+static CBlock MakeBlock(uint32_t nTime, int txCount)
+{
+    CBlock block;
+    block.nVersion = 1;
+    block.nTime = nTime;
+
+    for (int i = 0; i < txCount; i++)
+    {
+        CMutableTransaction tx;
+        tx.nTime = nTime;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(InsecureRand256(), i);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = i + 1;
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        block.vtx.push_back(MakeTransactionRef(std::move(tx)));
+    }
+
+    return block;
+}
+
+// Append block the same way as WriteBlockToDisk and return its position
+static CDiskBlockPos AppendBlock(const CBlock& block)
+{
+    CDiskBlockPos pos(0, 0);
+    CAutoFile file(fsbridge::fopen(GetBlockPosFilename(pos, "blk"), "ab"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+
+    fseek(file.Get(), 0, SEEK_END);
+    unsigned int nSize = GetSerializeSize(block, file.GetVersion());
+    file << Params().MessageStart() << nSize;
+    pos.nPos = (unsigned int) ftell(file.Get());
+    file << block;
+
+    return pos;
+}
+
+static unsigned int TxOffset(const CBlock& block, size_t index)
+{
+    unsigned int offset = GetSizeOfCompactSize(block.vtx.size());
+    for (size_t i = 0; i < index; i++)
+        offset += ::GetSerializeSize(*block.vtx[i], CLIENT_VERSION);
+    return offset;
+}
+
+BOOST_AUTO_TEST_CASE(read_mapped)
+{
+    SetDataDir("blockreader_mapped");
+    ClearDatadirCache();
+    fs::create_directories(GetBlocksDir());
+
+    CBlockReader reader;
+    CBlock first = MakeBlock(1000, 3);
+    CDiskBlockPos firstPos = AppendBlock(first);
+
+    CBlock block;
+    BOOST_CHECK(reader.ReadBlock(firstPos, block));
+    BOOST_CHECK(block.GetHash() == first.GetHash());
+    BOOST_CHECK_EQUAL(block.vtx.size(), 3U);
+    BOOST_CHECK(block.vtx[2]->GetHash() == first.vtx[2]->GetHash());
+
+    // File grows after mapping - block behind the mapped end is read after remapping
+    CBlock second = MakeBlock(2000, 5);
+    CDiskBlockPos secondPos = AppendBlock(second);
+    BOOST_CHECK(reader.ReadBlock(secondPos, block));
+    BOOST_CHECK(block.GetHash() == second.GetHash());
+
+    // Not existing file and position are not read
+    BOOST_CHECK(!reader.ReadBlock(CDiskBlockPos(1, 8), block));
+    BOOST_CHECK(!reader.ReadBlock(CDiskBlockPos(0, secondPos.nPos + 1000000), block));
+}
+
+BOOST_AUTO_TEST_CASE(read_transaction)
+{
+    SetDataDir("blockreader_transaction");
+    ClearDatadirCache();
+    fs::create_directories(GetBlocksDir());
+
+    CBlockReader reader;
+    CBlock stored = MakeBlock(3000, 4);
+    CDiskBlockPos pos = AppendBlock(stored);
+
+    uint256 blockHash;
+    CTransactionRef tx;
+    BOOST_CHECK(reader.ReadTransaction(pos, TxOffset(stored, 2), stored.vtx[2]->GetHash(), blockHash, tx));
+    BOOST_CHECK(tx->GetHash() == stored.vtx[2]->GetHash());
+    BOOST_CHECK(blockHash == stored.GetHash());
+
+    // Hash of other transaction at the offset is not accepted
+    BOOST_CHECK(!reader.ReadTransaction(pos, TxOffset(stored, 1), stored.vtx[2]->GetHash(), blockHash, tx));
+}
+
+BOOST_AUTO_TEST_CASE(recent_blocks)
+{
+    SetDataDir("blockreader_recent");
+    ClearDatadirCache();
+
+    CBlockReader reader;
+    CBlock stored = MakeBlock(4000, 2);
+    CDiskBlockPos pos(0, 8);
+
+    BOOST_CHECK(reader.GetRecent(pos) == nullptr);
+    reader.PutRecent(pos, stored);
+
+    auto recent = reader.GetRecent(pos);
+    BOOST_REQUIRE(recent != nullptr);
+    BOOST_CHECK(recent->GetHash() == stored.GetHash());
+
+    // Transactions of recent blocks are found without block file
+    uint256 blockHash;
+    CTransactionRef tx;
+    BOOST_CHECK(reader.ReadTransaction(pos, 0, stored.vtx[1]->GetHash(), blockHash, tx));
+    BOOST_CHECK(tx == stored.vtx[1]);
+    BOOST_CHECK(blockHash == stored.GetHash());
+
+    // Only recent blocks of the removed file are dropped
+    CDiskBlockPos otherPos(1, 8);
+    reader.PutRecent(otherPos, stored);
+    reader.ForgetFile(0);
+    BOOST_CHECK(reader.GetRecent(pos) == nullptr);
+    BOOST_CHECK(reader.GetRecent(otherPos) != nullptr);
+
+    // Least recently used blocks are dropped first
+    for (int i = 0; i < DEFAULT_BLOCK_READ_CACHE; i++)
+        reader.PutRecent(CDiskBlockPos(2, 8 + i), stored);
+    BOOST_CHECK(reader.GetRecent(otherPos) == nullptr);
+    BOOST_CHECK(reader.GetRecent(CDiskBlockPos(2, 8)) != nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,216 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/pocketnet.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+
+using namespace PocketDb;
+using namespace PocketTx;
+
+BOOST_FIXTURE_TEST_SUITE(chainrollback_tests, TestingSetup)
+
+static const int BASE_HEIGHT = 1000000;
+
+struct TestBlock
+{
+    std::string Hash;
+    int Height;
+    std::vector<TransactionIndexingInfo> Txs;
+    std::shared_ptr<std::vector<Rating>> Ratings = std::make_shared<std::vector<Rating>>();
+};
+
+static void Exec(const std::string& sql)
+{
+    BOOST_REQUIRE(sqlite3_exec(SQLiteDbInst.m_db, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK);
+}
+
+// All rows of the query as "col|col|..." strings
+static std::vector<std::string> Select(const std::string& sql)
+{
+    std::vector<std::string> rows;
+
+    sqlite3_stmt* stmt = nullptr;
+    BOOST_REQUIRE(sqlite3_prepare_v2(SQLiteDbInst.m_db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK);
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        std::string row;
+        for (int i = 0; i < sqlite3_column_count(stmt); i++)
+        {
+            auto text = sqlite3_column_text(stmt, i);
+            row += (text ? std::string((const char*) text) : "null") + "|";
+        }
+        rows.push_back(row);
+    }
+    sqlite3_finalize(stmt);
+
+    return rows;
+}
+
+// Everything connected blocks write and rollback has to restore
+static std::vector<std::string> ChainState()
+{
+    std::vector<std::string> state;
+    for (const auto& sql : {
+        "select Hash, BlockHash, Height, Last, Id from Transactions where Height is not null order by Hash",
+        "select TxHash, Number, TxHeight, SpentHeight, SpentTxHash from TxOutputs where TxHeight is not null order by TxHash, Number",
+        "select Type, Id, Height, Last, Value from Ratings order by Type, Id, Height",
+        "select AddressHash, Height, Last, Value from Balances order by AddressHash, Height"
+    })
+    {
+        auto rows = Select(sql);
+        state.insert(state.end(), rows.begin(), rows.end());
+        state.emplace_back("--");
+    }
+    return state;
+}
+
+// Random blocks with account edits, post edits, subscribes, spends and ratings -
+// transactions are written without height as after mempool acceptance
+static std::vector<TestBlock> MakeBlocks(int count)
+{
+    std::vector<TestBlock> blocks;
+    std::vector<std::string> roots;
+    std::vector<std::pair<std::string, int>> unspent;
+
+    auto address = []() { return "addr" + std::to_string(InsecureRandRange(6)); };
+
+    for (int b = 0; b < count; b++)
+    {
+        TestBlock block;
+        block.Hash = InsecureRand256().GetHex();
+        block.Height = BASE_HEIGHT + b;
+
+        std::set<std::pair<int, std::string>> edited;
+        int txCount = 3 + InsecureRandRange(5);
+        for (int n = 0; n < txCount; n++)
+        {
+            TransactionIndexingInfo txInfo;
+            txInfo.Hash = InsecureRand256().GetHex();
+            txInfo.BlockNumber = n;
+            txInfo.Time = block.Height;
+
+            std::string string1 = address();
+            std::string string2;
+            switch (InsecureRandRange(3))
+            {
+            case 0:
+                txInfo.Type = TxType::ACCOUNT_USER;
+                break;
+            case 1:
+                txInfo.Type = TxType::CONTENT_POST;
+                string2 = roots.empty() || InsecureRandBool() ? txInfo.Hash : roots[InsecureRandRange(roots.size())];
+                break;
+            default:
+                txInfo.Type = TxType::ACTION_SUBSCRIBE;
+                string2 = address();
+                break;
+            }
+
+            // Full scan restores all rows of the previous height - one edit per Id in block
+            auto key = txInfo.Type == TxType::CONTENT_POST ? string2 : string1 + "|" + string2;
+            if (!edited.emplace((int) txInfo.Type, key).second)
+                continue;
+
+            if (string2 == txInfo.Hash)
+                roots.push_back(txInfo.Hash);
+
+            Exec(strprintf("insert into Transactions (Type, Hash, Time, String1, String2) values (%d, '%s', %d, '%s', %s)",
+                (int) txInfo.Type, txInfo.Hash, txInfo.Time, string1, string2.empty() ? "null" : "'" + string2 + "'"));
+
+            if (!unspent.empty() && InsecureRandBool())
+            {
+                auto i = InsecureRandRange(unspent.size());
+                txInfo.Inputs.push_back(unspent[i]);
+                unspent.erase(unspent.begin() + i);
+            }
+
+            Exec(strprintf("insert into TxOutputs (TxHash, Number, AddressHash, Value, ScriptPubKey) values ('%s', 0, '%s', %d, '')",
+                txInfo.Hash, address(), 1 + InsecureRandRange(1000)));
+            unspent.emplace_back(txInfo.Hash, 0);
+
+            block.Txs.push_back(txInfo);
+        }
+
+        int ratingCount = InsecureRandRange(4);
+        for (int n = 0; n < ratingCount; n++)
+        {
+            Rating rating;
+            rating.SetType(RatingType::RATING_ACCOUNT);
+            rating.SetHeight(block.Height);
+            rating.SetId(n);
+            rating.SetValue(1 + InsecureRandRange(10));
+            block.Ratings->push_back(rating);
+        }
+
+        blocks.push_back(block);
+    }
+
+    return blocks;
+}
+
+static void Connect(std::vector<TestBlock>& blocks, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i++)
+    {
+        ChainRepoInst.IndexBlock(blocks[i].Hash, blocks[i].Height, blocks[i].Txs);
+        RatingsRepoInst.InsertRatings(blocks[i].Ratings);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rollback_undo_matches_full_scan)
+{
+    SeedInsecureRand(true);
+
+    const size_t count = 12;
+    const size_t fork = 6;
+    auto blocks = MakeBlocks(count);
+
+    Connect(blocks, 0, fork);
+    auto forkState = ChainState();
+
+    // Rollback with undo records
+    Connect(blocks, fork, count);
+    BOOST_CHECK(ChainState() != forkState);
+    BOOST_CHECK(ChainRepoInst.Rollback(BASE_HEIGHT + fork));
+    BOOST_CHECK(ChainState() == forkState);
+
+    // Same blocks without block markers - rollback falls back to full scan
+    Connect(blocks, fork, count);
+    Exec("delete from LastUndo where Type = 0");
+    BOOST_CHECK(ChainRepoInst.Rollback(BASE_HEIGHT + fork));
+    BOOST_CHECK(ChainState() == forkState);
+
+    // Repeated rollback of removed range is no-op
+    BOOST_CHECK(ChainRepoInst.Rollback(BASE_HEIGHT + fork));
+    BOOST_CHECK(ChainState() == forkState);
+}
+
+BOOST_AUTO_TEST_CASE(exists_block_reports_stale_height)
+{
+    SeedInsecureRand(true);
+
+    auto blocks = MakeBlocks(3);
+    Connect(blocks, 0, 3);
+
+    auto[tipExists, tipLast] = ChainRepoInst.ExistsBlock(blocks[2].Hash, blocks[2].Height);
+    BOOST_CHECK(tipExists && tipLast);
+
+    auto[prevExists, prevLast] = ChainRepoInst.ExistsBlock(blocks[1].Hash, blocks[1].Height);
+    BOOST_CHECK(prevExists && !prevLast);
+
+    // Tip was disconnected without rollback - other block at the same height must roll it back first
+    auto[staleExists, staleLast] = ChainRepoInst.ExistsBlock(InsecureRand256().GetHex(), blocks[2].Height);
+    BOOST_CHECK(!staleExists && !staleLast);
+
+    BOOST_CHECK(ChainRepoInst.Rollback(blocks[2].Height));
+    auto[nextExists, nextLast] = ChainRepoInst.ExistsBlock(InsecureRand256().GetHex(), blocks[2].Height);
+    BOOST_CHECK(!nextExists && nextLast);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
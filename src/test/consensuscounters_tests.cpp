@@ -0,0 +1,124 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/pocketnet.h>
+#include <pocketdb/repositories/ConsensusCounters.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace PocketDb;
+
+BOOST_FIXTURE_TEST_SUITE(consensuscounters_tests, TestingSetup)
+
+static const std::vector<TxType> COUNTED_TYPES = {
+    ACCOUNT_USER, CONTENT_POST, CONTENT_VIDEO, CONTENT_ARTICLE, ACTION_SCORE_CONTENT, ACTION_SCORE_COMMENT
+};
+
+static void Exec(const std::string& sql)
+{
+    BOOST_REQUIRE(sqlite3_exec(SQLiteDbInst.m_db, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK);
+}
+
+// Random social transactions of addresses in block at height
+static void ConnectBlock(int height, const std::vector<std::string>& addresses)
+{
+    int count = InsecureRandRange(6);
+    for (int i = 0; i < count; i++)
+    {
+        std::string hash = InsecureRand256().GetHex();
+        std::string address = addresses[InsecureRandRange(addresses.size())];
+        TxType type = COUNTED_TYPES[InsecureRandRange(COUNTED_TYPES.size())];
+
+        // Edited content is not original - its String2 points to the first version
+        std::string root = InsecureRandBool() ? hash : InsecureRand256().GetHex();
+
+        Exec(strprintf("insert into Transactions (Type, Hash, Time, BlockHash, Height, String1, String2) values (%d, '%s', %d, '%s', %d, '%s', '%s')",
+            (int) type, hash, height, "block" + std::to_string(height), height, address, root));
+    }
+}
+
+// Block disconnect returns transactions back to mempool
+static void DisconnectBlocks(int height)
+{
+    Exec(strprintf("update Transactions set Height = null, BlockHash = null where Height >= %d", height));
+}
+
+// Counters answer every window exactly as the SQL queries of ConsensusRepository
+static void CheckCounts(ConsensusCounters& counters, const std::vector<std::string>& addresses, int from, int tip)
+{
+    for (const auto& address : addresses)
+    {
+        for (int height = from; height <= tip + 1; height++)
+        {
+            int count = -1;
+            BOOST_REQUIRE(counters.CountChain(CONTENT_POST, address, height, true, count));
+            BOOST_CHECK_EQUAL(count, ConsensusRepoInst.CountChainPostHeight(address, height));
+
+            BOOST_REQUIRE(counters.CountChain(CONTENT_VIDEO, address, height, true, count));
+            BOOST_CHECK_EQUAL(count, ConsensusRepoInst.CountChainVideo(address, height));
+
+            BOOST_REQUIRE(counters.CountChain(CONTENT_ARTICLE, address, height, true, count));
+            BOOST_CHECK_EQUAL(count, ConsensusRepoInst.CountChainArticle(address, height));
+
+            BOOST_REQUIRE(counters.CountChain(ACTION_SCORE_CONTENT, address, height, false, count));
+            BOOST_CHECK_EQUAL(count, ConsensusRepoInst.CountChainScoreContentHeight(address, height));
+
+            BOOST_REQUIRE(counters.CountChain(ACTION_SCORE_COMMENT, address, height, false, count));
+            BOOST_CHECK_EQUAL(count, ConsensusRepoInst.CountChainScoreCommentHeight(address, height));
+
+            BOOST_REQUIRE(counters.CountChain(ACCOUNT_USER, address, height, false, count));
+            BOOST_CHECK_EQUAL(count, ConsensusRepoInst.CountChainAccount(ACCOUNT_USER, address, height));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(counters_match_sql)
+{
+    // Repository counts below run in database
+    ConsensusCountersInst.Clear();
+
+    std::vector<std::string> addresses;
+    for (int i = 0; i < 3; i++)
+        addresses.push_back(InsecureRand256().GetHex());
+
+    // Heights above the test chain - nothing else is stored there
+    const int start = 1000000;
+    ConsensusCounters counters;
+    int count = 0;
+    BOOST_CHECK(!counters.CountChain(CONTENT_POST, addresses[0], start, true, count));
+
+    for (int height = start; height < start + 20; height++)
+    {
+        ConnectBlock(height, addresses);
+        counters.Index(height);
+    }
+    CheckCounts(counters, addresses, start, start + 19);
+
+    // Rollback of several blocks and connecting other blocks instead
+    DisconnectBlocks(start + 12);
+    counters.Rollback(start + 12);
+    CheckCounts(counters, addresses, start, start + 11);
+
+    for (int height = start + 12; height < start + 25; height++)
+    {
+        ConnectBlock(height, addresses);
+        counters.Index(height);
+    }
+    CheckCounts(counters, addresses, start, start + 24);
+
+    // Not sequential block reloads the whole window
+    ConnectBlock(start + 30, addresses);
+    counters.Index(start + 30);
+    CheckCounts(counters, addresses, start, start + 30);
+
+    // Rollback below the covered window is answered by database
+    counters.Rollback(start - 5000);
+    BOOST_CHECK(!counters.CountChain(CONTENT_POST, addresses[0], start, true, count));
+
+    DisconnectBlocks(start);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
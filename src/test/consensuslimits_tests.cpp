@@ -0,0 +1,54 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <chainparams.h>
+#include <pocketdb/consensus/Base.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace PocketConsensus;
+
+BOOST_FIXTURE_TEST_SUITE(consensuslimits_tests, BasicTestingSetup)
+
+static void CheckNetworkLimits(const std::string& chain, NetworkId network)
+{
+    SelectParams(chain);
+
+    for (const auto& [type, limits] : m_consensus_limits)
+    {
+        const auto& values = limits.at(network);
+        for (const auto& [height, value] : values)
+        {
+            // Value starts at its height and is kept until the next one
+            for (int h : { height - 1, height, height + 1 })
+            {
+                if (h < 0)
+                    continue;
+
+                auto it = values.upper_bound(h);
+                int64_t expected = it != values.begin() ? std::prev(it)->second : 0;
+                BOOST_CHECK_EQUAL(BaseConsensus(h).GetConsensusLimit(type), expected);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(consensuslimits_epochs)
+{
+    CheckNetworkLimits(CBaseChainParams::MAIN, NetworkMain);
+    CheckNetworkLimits(CBaseChainParams::TESTNET, NetworkTest);
+    SelectParams(CBaseChainParams::MAIN);
+}
+
+BOOST_AUTO_TEST_CASE(consensuslimits_checkpoints)
+{
+    ConsensusCheckpoint<BaseConsensus> checkpoint{ 1757000, 947500, nullptr };
+    BOOST_CHECK_EQUAL(checkpoint.Height(NetworkMain), 1757000);
+    BOOST_CHECK_EQUAL(checkpoint.Height(NetworkTest), 947500);
+    BOOST_CHECK_EQUAL(checkpoint.Height(NetworkRegTest), 1757000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,62 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <utils/html.h>
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(html_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(html_clear_tags)
+{
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags(""), "");
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags("plain text"), "plain text");
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags("<p>Hello <b>world</b></p>"), "Hello world");
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags("a > b"), "a  b");
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags("a < b"), "a ");
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags("<a href=\"x\">link</a> tail"), "link tail");
+
+    // Long runs go through the vectorized search
+    std::string longText(100, 'x');
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags(longText + "<br/>" + longText), longText + longText);
+    BOOST_CHECK_EQUAL(HtmlUtils::ClearHtmlTags("<" + longText + ">" + longText), longText);
+}
+
+BOOST_AUTO_TEST_CASE(html_url_encode)
+{
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlEncode(""), "");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlEncode("abc-XYZ_09.~"), "abc-XYZ_09.~");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlEncode("a b&c"), "a%20b%26c");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlEncode(std::string("\n\0", 2)), "%0A%00");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlEncode("\xD0\x9F"), "%D0%9F");
+}
+
+BOOST_AUTO_TEST_CASE(html_url_decode)
+{
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode(""), "");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode("plain"), "plain");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode("a+b%20c"), "a b c");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode("%d0%9F"), "\xD0\x9F");
+
+    // Malformed escapes are kept as is
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode("100%"), "100%");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode("%2"), "%2");
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode("%zz%41"), "%zzA");
+
+    std::string longText(100, 'x');
+    BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode(longText + "%41" + longText + "+"), longText + "A" + longText + " ");
+
+    for (const std::string& value : { std::string("hello world"), std::string("\x01\xFF/?#[]@!$&'()*+,;="), longText })
+        BOOST_CHECK_EQUAL(HtmlUtils::UrlDecode(HtmlUtils::UrlEncode(value)), value);
+}
+
+BOOST_AUTO_TEST_CASE(html_string_to_lower)
+{
+    std::string value = "Hello WORLD 123 \xD0\x9F";
+    HtmlUtils::StringToLower(value);
+    BOOST_CHECK_EQUAL(value, "hello world 123 \xD0\x9F");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <httpworkqueue.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(httpworkqueue_tests, BasicTestingSetup)
+
+class TestClosure final : public HTTPClosure
+{
+public:
+    TestClosure(std::string peer, std::string method, int* rejected = nullptr) :
+        m_peer(std::move(peer)), m_method(std::move(method)), m_rejected(rejected)
+    {
+    }
+
+    void operator()(DbConnectionRef&) override {}
+    std::string Peer() const override { return m_peer; }
+    std::string Method() const override { return m_method; }
+    void Reject(int nStatus, const std::string&) override
+    {
+        if (m_rejected)
+            *m_rejected = nStatus;
+    }
+
+private:
+    std::string m_peer;
+    std::string m_method;
+    int* m_rejected;
+};
+
+static std::string Next(HTTPWorkQueue& queue, std::string* peer = nullptr)
+{
+    HTTPWorkQueue::Item item;
+    BOOST_REQUIRE(queue.GetNext(item, nullptr, nullptr));
+    if (peer)
+        *peer = item->Peer();
+    return item->Method();
+}
+
+BOOST_AUTO_TEST_CASE(parse_method)
+{
+    std::string body = R"({"params": ["x"], "method" : "getnodeinfo", "id": 1})";
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(body.data(), body.size()), "getnodeinfo");
+
+    body = R"( [{"method": "getnodeinfo"}])";
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(body.data(), body.size()), "batch");
+
+    // Method keys inside params do not change the called method
+    body = R"({"params": {"method": "gettime"}, "id": "method", "method": "search"})";
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(body.data(), body.size()), "search");
+    body = R"({"params": ["\"method\": \"gettime\"", [{"method": "gettime"}]], "method": "search"})";
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(body.data(), body.size()), "search");
+    body = R"({"params": {"method": "gettime"}})";
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(body.data(), body.size()), "");
+
+    body = R"({"method": 1})";
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(body.data(), body.size()), "");
+    BOOST_CHECK_EQUAL(RPCMethodCosts::ParseMethod(nullptr, 0), "");
+}
+
+BOOST_AUTO_TEST_CASE(cost_classes)
+{
+    RPCMethodCosts costs;
+    BOOST_CHECK(costs.Configure({ "getnodeinfo:cheap", "search:heavy" }));
+    BOOST_CHECK(!costs.Configure({ "getnodeinfo" }));
+    BOOST_CHECK(!costs.Configure({ "getnodeinfo:fast" }));
+
+    BOOST_CHECK(costs.Class("getnodeinfo") == RPCCostClass::Cheap);
+    BOOST_CHECK(costs.Class("search") == RPCCostClass::Heavy);
+    BOOST_CHECK(costs.Class("unknown") == RPCCostClass::Normal);
+
+    // Configured class wins over observed latency
+    costs.Observe("search", 1);
+    BOOST_CHECK(costs.Class("search") == RPCCostClass::Heavy);
+
+    costs.Observe("gettime", 1);
+    BOOST_CHECK(costs.Class("gettime") == RPCCostClass::Cheap);
+    costs.Observe("getfeed", 2000);
+    BOOST_CHECK(costs.Class("getfeed") == RPCCostClass::Heavy);
+    BOOST_CHECK_EQUAL(costs.Expected("getfeed"), 2000);
+}
+
+BOOST_AUTO_TEST_CASE(weighted_lanes)
+{
+    RPCMethodCosts costs;
+    costs.Configure({ "cheap:cheap", "heavy:heavy" });
+    HTTPWorkQueue queue(16, 0, costs);
+
+    for (int i = 0; i < 8; i++)
+        BOOST_CHECK(queue.Add(std::make_unique<TestClosure>("a", "heavy")));
+    for (int i = 0; i < 8; i++)
+        BOOST_CHECK(queue.Add(std::make_unique<TestClosure>("a", "cheap")));
+    BOOST_CHECK_EQUAL(queue.Size(), 16U);
+
+    // Cheap lane is served four times per one heavy request
+    int cheap = 0;
+    for (int i = 0; i < 5; i++)
+        cheap += Next(queue) == "cheap";
+    BOOST_CHECK_EQUAL(cheap, 4);
+
+    // Full lane does not block admission of other lanes
+    RPCMethodCosts costs2;
+    costs2.Configure({ "cheap:cheap", "heavy:heavy" });
+    HTTPWorkQueue small(2, 0, costs2);
+    BOOST_CHECK(small.Add(std::make_unique<TestClosure>("a", "heavy")));
+    BOOST_CHECK(small.Add(std::make_unique<TestClosure>("a", "heavy")));
+    BOOST_CHECK(!small.Add(std::make_unique<TestClosure>("a", "heavy")));
+    BOOST_CHECK(small.Add(std::make_unique<TestClosure>("a", "cheap")));
+}
+
+BOOST_AUTO_TEST_CASE(fair_peers)
+{
+    RPCMethodCosts costs;
+    HTTPWorkQueue queue(16, 0, costs);
+
+    for (int i = 0; i < 4; i++)
+        queue.Add(std::make_unique<TestClosure>("a", "m"));
+    queue.Add(std::make_unique<TestClosure>("b", "m"));
+
+    // Single request of the second peer does not wait for all requests of the first one
+    std::string first, second;
+    Next(queue, &first);
+    Next(queue, &second);
+    BOOST_CHECK_EQUAL(first, "a");
+    BOOST_CHECK_EQUAL(second, "b");
+}
+
+BOOST_AUTO_TEST_CASE(deadline_shedding)
+{
+    RPCMethodCosts costs;
+    costs.Observe("slow", 5000);
+    HTTPWorkQueue queue(16, 1000, costs);
+
+    int rejected = 0;
+    queue.Add(std::make_unique<TestClosure>("a", "slow", &rejected));
+
+    // Slow request can not complete within timeout and is rejected without execution
+    HTTPWorkQueue::Item item;
+    BOOST_CHECK(!queue.GetNext(item, nullptr, nullptr));
+    BOOST_CHECK_EQUAL(rejected, HTTP_SERVICE_UNAVAILABLE);
+    BOOST_CHECK_EQUAL(queue.Shed(), 1);
+
+    queue.Add(std::make_unique<TestClosure>("a", "fast"));
+    BOOST_CHECK_EQUAL(Next(queue), "fast");
+    BOOST_CHECK_EQUAL(queue.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(shedding_decays)
+{
+    RPCMethodCosts costs;
+    costs.Observe("slow", 5000);
+    HTTPWorkQueue queue(16, 1000, costs);
+
+    for (int i = 0; i < 16; i++)
+        queue.Add(std::make_unique<TestClosure>("a", "slow"));
+
+    // Single slow call does not reject the method forever - it is executed again after few rejections
+    BOOST_CHECK_EQUAL(Next(queue), "slow");
+    BOOST_CHECK(queue.Shed() > 0);
+    BOOST_CHECK(queue.Shed() < 16);
+    BOOST_CHECK(costs.Expected("slow") <= 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
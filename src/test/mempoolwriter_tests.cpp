@@ -0,0 +1,161 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/pocketnet.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace PocketDb;
+using namespace PocketHelpers;
+using namespace PocketServices;
+
+BOOST_FIXTURE_TEST_SUITE(mempoolwriter_tests, TestingSetup)
+
+static PocketBlock MakePocketBlock(std::vector<std::string>& hashes, int count)
+{
+    PocketBlock pocketBlock;
+    for (int i = 0; i < count; i++)
+    {
+        auto ptx = TransactionHelper::CreateInstance(TxType::ACCOUNT_USER);
+        ptx->SetHash(InsecureRand256().GetHex());
+        ptx->SetTime(GetTime());
+
+        hashes.push_back(*ptx->GetHash());
+        pocketBlock.push_back(ptx);
+    }
+    return pocketBlock;
+}
+
+// Transaction is committed - visible for other connection
+static bool ExistsCommitted(const std::string& hash)
+{
+    sqlite3* db = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    auto path = GetDataDir() / "pocketdb" / "main.sqlite3";
+    BOOST_REQUIRE(sqlite3_open_v2(path.string().c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK);
+    BOOST_REQUIRE(sqlite3_prepare_v2(db, "select 1 from Transactions where Hash = ?", -1, &stmt, nullptr) == SQLITE_OK);
+    sqlite3_bind_text(stmt, 1, hash.c_str(), -1, SQLITE_TRANSIENT);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return exists;
+}
+
+static void ExecGroupStep(const std::string& sql)
+{
+    SQLiteGroupScope scope;
+    BOOST_REQUIRE(SQLiteDbInst.BeginTransaction());
+    BOOST_REQUIRE(sqlite3_exec(SQLiteDbInst.m_db, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK);
+    BOOST_REQUIRE(SQLiteDbInst.CommitTransaction());
+}
+
+BOOST_AUTO_TEST_CASE(group_read_and_foreign_write)
+{
+    std::vector<std::pair<int64_t, bool>> finished;
+    SQLiteDbInst.SetGroupFinished([&finished](int64_t groupId, bool committed) { finished.emplace_back(groupId, committed); });
+
+    std::vector<std::string> hashes;
+    auto grouped = MakePocketBlock(hashes, 2);
+    {
+        SQLiteGroupScope scope;
+        TransRepoInst.InsertTransactions(grouped);
+    }
+    auto groupId = SQLiteGroupScope::LastGroup();
+
+    BOOST_CHECK_EQUAL(get<0>(SQLiteDbInst.GroupState()), 1);
+    BOOST_CHECK(!ExistsCommitted(hashes[0]));
+
+    // Read of other transaction sees group changes and keeps the group open
+    BOOST_CHECK(TransRepoInst.Exists(hashes[0]));
+    BOOST_CHECK(TransRepoInst.Exists(hashes[1]));
+    BOOST_CHECK_EQUAL(get<0>(SQLiteDbInst.GroupState()), 1);
+    BOOST_CHECK(finished.empty());
+    BOOST_CHECK(!ExistsCommitted(hashes[0]));
+
+    // Foreign write is committed together with the group
+    auto foreign = MakePocketBlock(hashes, 1);
+    TransRepoInst.InsertTransactions(foreign);
+
+    BOOST_CHECK_EQUAL(get<0>(SQLiteDbInst.GroupState()), 0);
+    BOOST_REQUIRE_EQUAL(finished.size(), 1U);
+    BOOST_CHECK_EQUAL(finished[0].first, groupId);
+    BOOST_CHECK(finished[0].second);
+    for (const auto& hash : hashes)
+        BOOST_CHECK(ExistsCommitted(hash));
+
+    // Next group step opens new group
+    auto next = MakePocketBlock(hashes, 1);
+    {
+        SQLiteGroupScope scope;
+        TransRepoInst.InsertTransactions(next);
+    }
+    BOOST_CHECK_EQUAL(SQLiteGroupScope::LastGroup(), groupId + 1);
+    BOOST_CHECK(SQLiteDbInst.CommitGroup());
+    BOOST_CHECK(ExistsCommitted(hashes.back()));
+
+    SQLiteDbInst.SetGroupFinished(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(failed_group_replayed)
+{
+    gArgs.ForceSetArg("-sqlmempoolbatchms", "100000");
+
+    boost::thread_group threadGroup;
+    MempoolWriterInst.Start(threadGroup);
+
+    // Deferred foreign key fails commit of the whole group
+    BOOST_REQUIRE(sqlite3_exec(SQLiteDbInst.m_db, R"sql(
+        create table GroupTestParent (Id int primary key);
+        create table GroupTestChild (ParentId int references GroupTestParent (Id) deferrable initially deferred);
+        pragma foreign_keys = on;
+    )sql", nullptr, nullptr, nullptr) == SQLITE_OK);
+
+    std::vector<std::string> hashes;
+    auto pocketBlock = MakePocketBlock(hashes, 3);
+    MempoolWriterInst.Insert(pocketBlock);
+    ExecGroupStep("insert into GroupTestChild (ParentId) values (1)");
+
+    for (const auto& hash : hashes)
+        BOOST_CHECK(MempoolWriterInst.Exists(hash));
+
+    BOOST_CHECK(!SQLiteDbInst.CommitGroup());
+
+    // Rows are lost with the group - writer still reports them until they are executed again
+    for (const auto& hash : hashes)
+    {
+        BOOST_CHECK(!TransRepoInst.Exists(hash));
+        BOOST_CHECK(!ExistsCommitted(hash));
+        BOOST_CHECK(MempoolWriterInst.Exists(hash));
+    }
+
+    MempoolWriterInst.Flush();
+
+    for (const auto& hash : hashes)
+    {
+        BOOST_CHECK(ExistsCommitted(hash));
+        BOOST_CHECK(MempoolWriterInst.Exists(hash));
+    }
+
+    // Cleaned transactions are not reported after commit
+    MempoolWriterInst.Clean({ hashes[0] });
+    BOOST_CHECK(!MempoolWriterInst.Exists(hashes[0]));
+    MempoolWriterInst.Flush();
+    BOOST_CHECK(!ExistsCommitted(hashes[0]));
+    BOOST_CHECK(ExistsCommitted(hashes[1]));
+
+    MempoolWriterInst.Stop();
+    threadGroup.join_all();
+
+    BOOST_REQUIRE(sqlite3_exec(SQLiteDbInst.m_db, R"sql(
+        pragma foreign_keys = off;
+        drop table GroupTestChild;
+        drop table GroupTestParent;
+    )sql", nullptr, nullptr, nullptr) == SQLITE_OK);
+    SQLiteDbInst.SetGroupFinished(nullptr);
+    gArgs.ForceSetArg("-sqlmempoolbatchms", "50");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
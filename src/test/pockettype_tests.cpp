@@ -0,0 +1,180 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/helpers/TransactionHelper.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <utilstrencodings.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace PocketHelpers;
+
+BOOST_FIXTURE_TEST_SUITE(pockettype_tests, BasicTestingSetup)
+
+static const std::vector<std::string> OP_RETURN_MARKERS = {
+    OR_SCORE, OR_COMPLAIN, OR_POST, OR_POSTEDIT, OR_SUBSCRIBE, OR_SUBSCRIBEPRIVATE, OR_UNSUBSCRIBE,
+    OR_USERINFO, OR_BLOCKING, OR_UNBLOCKING, OR_COMMENT, OR_COMMENT_EDIT, OR_COMMENT_DELETE,
+    OR_COMMENT_SCORE, OR_VIDEO, OR_ARTICLE, OR_POLL, OR_POLL_SCORE, OR_TRANSLATE, OR_TRANSLATE_SCORE,
+    OR_VIDEO_SERVER, OR_MESSAGE_SERVER, OR_SERVER_PING, OR_CONTENT_DELETE, OR_CONTENT_BOOST,
+    OR_ACCOUNT_SETTING, OR_ACCOUNT_DELETE, OR_MODERATION_FLAG,
+};
+
+static CScript RawScript(const std::vector<unsigned char>& bytes)
+{
+    return CScript(bytes.begin(), bytes.end());
+}
+
+// Push with the given opcode - also not minimal encodings that asm prints as hex anyway
+static std::vector<unsigned char> Push(const std::vector<unsigned char>& data, opcodetype opcode)
+{
+    std::vector<unsigned char> result;
+    if (opcode < OP_PUSHDATA1)
+    {
+        result.push_back((unsigned char) data.size());
+    }
+    else if (opcode == OP_PUSHDATA1)
+    {
+        result.push_back(OP_PUSHDATA1);
+        result.push_back((unsigned char) data.size());
+    }
+    else if (opcode == OP_PUSHDATA2)
+    {
+        result.push_back(OP_PUSHDATA2);
+        result.push_back((unsigned char) (data.size() & 0xff));
+        result.push_back((unsigned char) (data.size() >> 8));
+    }
+    else
+    {
+        result.push_back(OP_PUSHDATA4);
+        for (int i = 0; i < 4; i++)
+            result.push_back((unsigned char) (data.size() >> (8 * i)));
+    }
+
+    result.insert(result.end(), data.begin(), data.end());
+    return result;
+}
+
+// Type from the script bytes and the memoized slot is the same as from the asm string
+static void CheckEquivalent(const CScript& script)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    mtx.vout.resize(1);
+    mtx.vout[0].scriptPubKey = script;
+    mtx.vout[0].nValue = 0;
+
+    auto tx = MakeTransactionRef(mtx);
+    std::vector<std::string> vasm;
+    TxType expected = TransactionHelper::ConvertOpReturnToType(TransactionHelper::ParseAsmType(tx, vasm));
+
+    BOOST_CHECK_MESSAGE(TransactionHelper::ParseOpReturnType(script) == expected, "script " + HexStr(script));
+    BOOST_CHECK(tx->GetPocketType() < 0);
+    BOOST_CHECK(TransactionHelper::ParseType(*tx) == expected);
+    BOOST_CHECK_EQUAL(tx->GetPocketType(), (int) expected);
+
+    // Memoized type is returned again and copied with the transaction
+    BOOST_CHECK(TransactionHelper::ParseType(tx) == expected);
+    CTransaction copy(*tx);
+    BOOST_CHECK_EQUAL(copy.GetPocketType(), (int) expected);
+}
+
+BOOST_AUTO_TEST_CASE(op_return_type_edge_cases)
+{
+    std::vector<opcodetype> pushes = { (opcodetype) 0x01, OP_PUSHDATA1, OP_PUSHDATA2, OP_PUSHDATA4 };
+
+    for (const auto& marker : OP_RETURN_MARKERS)
+    {
+        auto data = ParseHex(marker);
+        for (auto opcode : pushes)
+        {
+            auto bytes = Push(data, opcode);
+
+            // Marker alone, with payload hash after it and without OP_RETURN
+            std::vector<unsigned char> script = { OP_RETURN };
+            script.insert(script.end(), bytes.begin(), bytes.end());
+            CheckEquivalent(RawScript(script));
+
+            auto hash = InsecureRand256();
+            CheckEquivalent(RawScript(script) << std::vector<unsigned char>(hash.begin(), hash.end()));
+            CheckEquivalent(RawScript(bytes));
+
+            // Truncated marker data and truncated push length
+            for (size_t size = 1; size < script.size(); size++)
+                CheckEquivalent(RawScript(std::vector<unsigned char>(script.begin(), script.begin() + size)));
+
+            // Marker as the second push does not count
+            CheckEquivalent(CScript() << OP_RETURN << OP_DUP << data);
+            CheckEquivalent(CScript() << OP_RETURN << ParseHex("00112233445566") << data);
+        }
+
+        // Prefix and extension of marker are other types
+        data.pop_back();
+        CheckEquivalent(CScript() << OP_RETURN << data);
+        data.push_back(0x00);
+        data.push_back(0x00);
+        CheckEquivalent(CScript() << OP_RETURN << data);
+    }
+
+    // Pushes up to 4 bytes are numbers in asm
+    CheckEquivalent(CScript() << OP_RETURN);
+    CheckEquivalent(CScript() << OP_RETURN << OP_0);
+    CheckEquivalent(CScript() << OP_RETURN << OP_1NEGATE);
+    for (size_t size = 1; size <= 5; size++)
+        CheckEquivalent(CScript() << OP_RETURN << ParseHex(std::string(OR_POST).substr(0, size * 2)));
+
+    // Regular payments
+    CheckEquivalent(CScript() << OP_DUP << OP_HASH160 << ParseHex("00112233445566778899aabbccddeeff00112233") << OP_EQUALVERIFY << OP_CHECKSIG);
+    CheckEquivalent(CScript() << OP_TRUE);
+}
+
+BOOST_AUTO_TEST_CASE(op_return_type_random)
+{
+    for (int i = 0; i < 20000; i++)
+    {
+        std::vector<unsigned char> script;
+        if (InsecureRandRange(4) != 0)
+            script.push_back(OP_RETURN);
+
+        // Random bytes, random pushes and pushes of random markers
+        int parts = InsecureRandRange(4);
+        for (int part = 0; part < parts; part++)
+        {
+            std::vector<unsigned char> data;
+            switch (InsecureRandRange(3))
+            {
+                case 0:
+                    data = ParseHex(OP_RETURN_MARKERS[InsecureRandRange(OP_RETURN_MARKERS.size())]);
+                    break;
+                case 1:
+                    for (int j = InsecureRandRange(40); j > 0; j--)
+                        data.push_back((unsigned char) InsecureRandBits(8));
+                    break;
+                default:
+                    for (int j = InsecureRandRange(8); j > 0; j--)
+                        script.push_back((unsigned char) InsecureRandBits(8));
+                    continue;
+            }
+
+            opcodetype opcodes[] = { (opcodetype) 0x01, OP_PUSHDATA1, OP_PUSHDATA2, OP_PUSHDATA4 };
+            auto bytes = Push(data, data.size() < OP_PUSHDATA1 ? opcodes[InsecureRandRange(4)] : OP_PUSHDATA1);
+
+            // Occasionally cut inside of the push
+            if (InsecureRandRange(8) == 0)
+                bytes.resize(InsecureRandRange(bytes.size()));
+
+            script.insert(script.end(), bytes.begin(), bytes.end());
+        }
+
+        if (script.empty())
+            script.push_back(OP_RETURN);
+
+        CheckEquivalent(RawScript(script));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
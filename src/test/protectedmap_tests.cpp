@@ -0,0 +1,59 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <protectedmap.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(protectedmap_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(protectedmap_basic)
+{
+    ProtectedMap<std::string, int> map;
+    BOOST_CHECK(map.empty());
+
+    for (int i = 0; i < 100; i++)
+        map.insert_or_assign(std::to_string(i), i);
+
+    // Assign does not change size
+    map.insert_or_assign("1", 1000);
+    BOOST_CHECK_EQUAL(map.count(), 100);
+
+    BOOST_CHECK_EQUAL(map.erase("2"), 1U);
+    BOOST_CHECK_EQUAL(map.erase("2"), 0U);
+    BOOST_CHECK_EQUAL(map.count(), 99);
+
+    int sum = 0;
+    map.Iterate([&](std::pair<const std::string, int>& elem) { sum += elem.second; });
+    BOOST_CHECK_EQUAL(sum, 4950 - 1 + 1000 - 2);
+}
+
+BOOST_AUTO_TEST_CASE(protectedmap_snapshot)
+{
+    ProtectedMap<std::string, int> map;
+    map.insert_or_assign("a", 1);
+    map.insert_or_assign("b", 2);
+
+    // Callbacks run without locks - map can be changed from inside
+    int visited = 0;
+    map.Iterate([&](std::pair<const std::string, int>& elem)
+    {
+        visited += 1;
+        elem.second += 10;
+        map.erase("a");
+        map.erase("b");
+        map.insert_or_assign("c", 3);
+    });
+
+    BOOST_CHECK_EQUAL(visited, 2);
+    BOOST_CHECK_EQUAL(map.count(), 1);
+
+    // Changes of the element made by callback are kept
+    map.Iterate([&](std::pair<const std::string, int>& elem) { elem.second += 10; });
+    map.Iterate([&](std::pair<const std::string, int>& elem) { BOOST_CHECK_EQUAL(elem.second, 13); });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
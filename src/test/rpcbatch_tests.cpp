@@ -0,0 +1,161 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <rpc/server.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+#include <condition_variable>
+#include <set>
+#include <thread>
+
+BOOST_FIXTURE_TEST_SUITE(rpcbatch_tests, BasicTestingSetup)
+
+// Batch elements record threads executing them and order of completion,
+// batchwait returns only after batchrelease was executed by other thread
+static Mutex cs_batch_test;
+static std::condition_variable batch_test_cond;
+static bool batch_test_released = false;
+static std::set<std::thread::id> batch_test_threads;
+static std::vector<std::string> batch_test_finished;
+
+static UniValue batchwait(const JSONRPCRequest& request)
+{
+    WAIT_LOCK(cs_batch_test, lock);
+    batch_test_threads.insert(std::this_thread::get_id());
+    bool released = batch_test_cond.wait_for(lock, std::chrono::seconds(10), [] { return batch_test_released; });
+    batch_test_finished.push_back(request.strMethod);
+    return released;
+}
+
+static UniValue batchrelease(const JSONRPCRequest& request)
+{
+    LOCK(cs_batch_test);
+    batch_test_threads.insert(std::this_thread::get_id());
+    batch_test_released = true;
+    batch_test_finished.push_back(request.strMethod);
+    batch_test_cond.notify_all();
+    return true;
+}
+
+static UniValue batchecho(const JSONRPCRequest& request)
+{
+    LOCK(cs_batch_test);
+    batch_test_threads.insert(std::this_thread::get_id());
+    batch_test_finished.push_back(request.strMethod);
+    return request.params[0];
+}
+
+static const CRPCCommand batchCommands[] =
+{ //  category  name            actor (function)  argNames
+  //  --------  --------------  ----------------  ----------
+    { "test",   "batchwait",    &batchwait,       {} },
+    { "test",   "batchrelease", &batchrelease,    {} },
+    { "test",   "batchecho",    &batchecho,       {"value"} },
+};
+
+// Helper threads are joined even if checks of the batch reply fail
+struct BatchHelpers
+{
+    std::vector<std::thread> threads;
+
+    void Join()
+    {
+        for (auto& thread : threads)
+            if (thread.joinable())
+                thread.join();
+    }
+
+    ~BatchHelpers() { Join(); }
+};
+
+static UniValue ExecBatch(const CRPCTable& table, const std::string& strRequest, const RPCBatchSpawn& spawn, int parallel)
+{
+    UniValue valRequest;
+    BOOST_REQUIRE(valRequest.read(strRequest));
+
+    JSONRPCRequest jreq;
+    UniValue reply;
+    BOOST_REQUIRE(reply.read(JSONRPCExecBatch(jreq, valRequest.get_array(), table, spawn, parallel)));
+    BOOST_REQUIRE(reply.isArray());
+    BOOST_REQUIRE_EQUAL(reply.size(), valRequest.size());
+
+    // Replies follow requests whatever order elements completed in
+    for (size_t i = 0; i < reply.size(); i++) {
+        BOOST_CHECK(find_value(reply[i], "error").isNull());
+        BOOST_CHECK_EQUAL(find_value(reply[i], "id").get_int(), (int) i);
+    }
+
+    return reply;
+}
+
+BOOST_AUTO_TEST_CASE(rpc_batch_order)
+{
+    if (RPCIsInWarmup(nullptr))
+        SetRPCWarmupFinished();
+
+    CRPCTable table;
+    for (const auto& command : batchCommands)
+        table.appendCommand(command.name, &command);
+
+    // Thread backed spawn - helpers run outside of the calling thread
+    BatchHelpers helpers;
+    RPCBatchSpawn spawn = [&helpers](std::function<void(const DbConnectionRef&)> func) {
+        helpers.threads.emplace_back([func]() { func(nullptr); });
+        return true;
+    };
+
+    // One helper - the first element completes last, only after the other thread
+    // executed all elements after it
+    UniValue reply = ExecBatch(table, R"([
+        {"method": "batchwait", "params": [], "id": 0},
+        {"method": "batchecho", "params": ["a"], "id": 1},
+        {"method": "batchecho", "params": ["b"], "id": 2},
+        {"method": "batchrelease", "params": [], "id": 3}
+    ])", spawn, 2);
+    helpers.Join();
+
+    BOOST_CHECK_EQUAL(helpers.threads.size(), 1U);
+    BOOST_CHECK(find_value(reply[0], "result").get_bool());
+    BOOST_CHECK_EQUAL(find_value(reply[1], "result").get_str(), "a");
+    BOOST_CHECK_EQUAL(find_value(reply[2], "result").get_str(), "b");
+    BOOST_CHECK(find_value(reply[3], "result").get_bool());
+
+    {
+        LOCK(cs_batch_test);
+        BOOST_CHECK_EQUAL(batch_test_threads.size(), 2U);
+        BOOST_REQUIRE_EQUAL(batch_test_finished.size(), 4U);
+        BOOST_CHECK_EQUAL(batch_test_finished.back(), "batchwait");
+
+        batch_test_threads.clear();
+        batch_test_finished.clear();
+    }
+
+    // Rejected helpers leave the whole batch to the calling thread
+    size_t rejected = 0;
+    RPCBatchSpawn rejecting = [&rejected](std::function<void(const DbConnectionRef&)>) {
+        rejected++;
+        return false;
+    };
+
+    reply = ExecBatch(table, R"([
+        {"method": "batchecho", "params": [10], "id": 0},
+        {"method": "batchecho", "params": [20], "id": 1},
+        {"method": "batchecho", "params": [30], "id": 2}
+    ])", rejecting, 4);
+
+    BOOST_CHECK_EQUAL(rejected, 1U);
+    for (size_t i = 0; i < reply.size(); i++)
+        BOOST_CHECK_EQUAL(find_value(reply[i], "result").get_int(), (int) (i + 1) * 10);
+
+    LOCK(cs_batch_test);
+    BOOST_CHECK_EQUAL(batch_test_threads.size(), 1U);
+    BOOST_CHECK(*batch_test_threads.begin() == std::this_thread::get_id());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
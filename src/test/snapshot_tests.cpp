@@ -0,0 +1,208 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/services/Snapshot.h>
+#include <util.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+using namespace PocketServices;
+
+BOOST_FIXTURE_TEST_SUITE(snapshot_tests, BasicTestingSetup)
+
+static void Exec(const fs::path& file, const std::string& sql)
+{
+    sqlite3* db = nullptr;
+    BOOST_REQUIRE(sqlite3_open(file.string().c_str(), &db) == SQLITE_OK);
+    BOOST_REQUIRE(sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK);
+    sqlite3_close(db);
+}
+
+static int Count(const fs::path& file, const std::string& sql)
+{
+    sqlite3* db = nullptr;
+    sqlite3_stmt* stmt = nullptr;
+    BOOST_REQUIRE(sqlite3_open(file.string().c_str(), &db) == SQLITE_OK);
+    BOOST_REQUIRE(sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK);
+    BOOST_REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+    int count = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return count;
+}
+
+// Pocket DB with two blocks and one mempool transaction
+static fs::path MakePocketDb(const std::string& name)
+{
+    fs::path dbPath = GetDataDir() / name;
+    fs::create_directories(dbPath);
+
+    Exec(dbPath / "main.sqlite3", R"sql(
+        create table Transactions (Hash text, Height int, BlockHash text);
+        create table Payload (TxHash text, String1 text);
+        create table TxOutputs (TxHash text, Number int);
+        create table TxInputs (SpentTxHash text, TxHash text, Number int);
+        insert into Transactions values ('a', 1, 'b1'), ('b', 2, 'b2'), ('m', null, null);
+        insert into Payload values ('a', 'x'), ('m', 'y');
+        insert into TxOutputs values ('b', 0), ('m', 0);
+        insert into TxInputs values ('m', 'b', 0);
+    )sql");
+
+    Exec(dbPath / "web.sqlite3", R"sql(
+        create table Tags (Id int, Value text);
+        insert into Tags values (1, 'tag');
+    )sql");
+
+    return dbPath;
+}
+
+static void WriteManifest(const fs::path& dir, const SnapshotManifest& manifest)
+{
+    std::ofstream out((dir / "manifest.txt").string(), std::ios::trunc);
+    out << "height " << manifest.Height << "\n";
+    out << "block " << manifest.BlockHash << "\n";
+    for (const auto& chunk : manifest.Chunks)
+        out << "chunk " << chunk.File << " " << chunk.Size << " " << chunk.Hash << "\n";
+    out << "hash " << manifest.Hash().GetHex() << "\n";
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_roundtrip)
+{
+    SetDataDir("snapshot_roundtrip");
+    ClearDatadirCache();
+
+    fs::path source = MakePocketDb("source");
+    fs::path dir = GetDataDir() / "snapshot";
+
+    // Small chunks - every database is split into several files
+    int readSnapshots = 0;
+    auto exported = Snapshot::Export(source, dir, 4096, [&readSnapshots]() { readSnapshots++; });
+    BOOST_CHECK_EQUAL(readSnapshots, 1);
+    BOOST_CHECK_EQUAL(exported.Height, 2);
+    BOOST_CHECK_EQUAL(exported.BlockHash, "b2");
+    BOOST_CHECK(exported.Chunks.size() > 2);
+
+    // Not empty directory is not overwritten
+    BOOST_CHECK_THROW(Snapshot::Export(source, dir, 4096), std::runtime_error);
+
+    SnapshotManifest manifest;
+    uint256 hash;
+    BOOST_CHECK(Snapshot::ReadManifest(dir, manifest, hash));
+    BOOST_CHECK(hash == exported.Hash());
+    BOOST_CHECK_EQUAL(manifest.Height, exported.Height);
+    BOOST_CHECK_EQUAL(manifest.BlockHash, exported.BlockHash);
+    BOOST_REQUIRE_EQUAL(manifest.Chunks.size(), exported.Chunks.size());
+    for (size_t i = 0; i < manifest.Chunks.size(); i++)
+    {
+        BOOST_CHECK_EQUAL(manifest.Chunks[i].File, exported.Chunks[i].File);
+        BOOST_CHECK_EQUAL(manifest.Chunks[i].Size, exported.Chunks[i].Size);
+        BOOST_CHECK_EQUAL(manifest.Chunks[i].Hash, exported.Chunks[i].Hash);
+    }
+
+    gArgs.ForceSetArg("-pocketdbsnapshothash", hash.GetHex());
+
+    std::string error;
+    fs::path target = GetDataDir() / "target";
+    BOOST_CHECK(Snapshot::Import(dir, target, error));
+    BOOST_CHECK(fs::exists(target / "web.sqlite3"));
+    BOOST_CHECK(!fs::exists(target / "main.sqlite3.snapshot"));
+
+    // Blocks are restored, mempool transaction is not
+    BOOST_CHECK_EQUAL(Count(target / "main.sqlite3", "select count(*) from Transactions"), 2);
+    BOOST_CHECK_EQUAL(Count(target / "main.sqlite3", "select count(*) from Transactions where Height is null"), 0);
+    BOOST_CHECK_EQUAL(Count(target / "main.sqlite3", "select count(*) from Payload"), 1);
+    BOOST_CHECK_EQUAL(Count(target / "main.sqlite3", "select count(*) from TxOutputs"), 1);
+    BOOST_CHECK_EQUAL(Count(target / "main.sqlite3", "select count(*) from TxInputs"), 0);
+    BOOST_CHECK_EQUAL(Count(target / "web.sqlite3", "select count(*) from Tags"), 1);
+
+    // Source still has its mempool
+    BOOST_CHECK_EQUAL(Count(source / "main.sqlite3", "select count(*) from Transactions where Height is null"), 1);
+
+    gArgs.ForceSetArg("-pocketdbsnapshothash", "");
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_rejected)
+{
+    SetDataDir("snapshot_rejected");
+    ClearDatadirCache();
+
+    fs::path dir = GetDataDir() / "snapshot";
+    auto exported = Snapshot::Export(MakePocketDb("source"), dir, 4096);
+    std::string error;
+
+    // Snapshot with unknown hash is not loaded
+    gArgs.ForceSetArg("-pocketdbsnapshothash", uint256().GetHex());
+    BOOST_CHECK(!Snapshot::Import(dir, GetDataDir() / "untrusted", error));
+    BOOST_CHECK(!fs::exists(GetDataDir() / "untrusted" / "main.sqlite3"));
+
+    // Web database left without main is not overwritten
+    gArgs.ForceSetArg("-pocketdbsnapshothash", exported.Hash().GetHex());
+    fs::path webOnly = GetDataDir() / "webonly";
+    fs::create_directories(webOnly);
+    Exec(webOnly / "web.sqlite3", "create table Local (Id int); insert into Local values (1);");
+    BOOST_CHECK(!Snapshot::Import(dir, webOnly, error));
+    BOOST_CHECK_EQUAL(Count(webOnly / "web.sqlite3", "select count(*) from Local"), 1);
+    BOOST_CHECK(!fs::exists(webOnly / "main.sqlite3"));
+
+    // Corrupted chunk is detected before any database appears
+    {
+        std::fstream chunk((dir / exported.Chunks.back().File).string(), std::ios::in | std::ios::out | std::ios::binary);
+        char byte = (char) chunk.get();
+        chunk.seekp(0);
+        chunk.put((char) (byte ^ 1));
+    }
+    BOOST_CHECK(!Snapshot::Import(dir, GetDataDir() / "corrupted", error));
+    BOOST_CHECK(error.find("corrupted") != std::string::npos);
+    BOOST_CHECK(!fs::exists(GetDataDir() / "corrupted" / "main.sqlite3"));
+    BOOST_CHECK(!fs::exists(GetDataDir() / "corrupted" / "web.sqlite3"));
+    BOOST_CHECK(!fs::exists(GetDataDir() / "corrupted" / "main.sqlite3.snapshot"));
+
+    gArgs.ForceSetArg("-pocketdbsnapshothash", "");
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_manifest_paths)
+{
+    SetDataDir("snapshot_manifest");
+    ClearDatadirCache();
+
+    fs::path dir = GetDataDir() / "snapshot";
+    fs::create_directories(dir);
+
+    SnapshotManifest manifest;
+    manifest.Height = 10;
+    manifest.BlockHash = "b10";
+    manifest.Chunks.push_back({ "main.0000.chunk", 1, "00" });
+
+    SnapshotManifest read;
+    uint256 hash;
+    WriteManifest(dir, manifest);
+    BOOST_CHECK(Snapshot::ReadManifest(dir, read, hash));
+    BOOST_CHECK(hash == manifest.Hash());
+
+    // Chunk files outside of snapshot directory are not accepted even with valid hash
+    for (const std::string& file : { "../main.0000.chunk", "sub/main.0000.chunk", "sub\\main.0000.chunk" })
+    {
+        manifest.Chunks[0].File = file;
+        WriteManifest(dir, manifest);
+
+        SnapshotManifest rejected;
+        BOOST_CHECK(!Snapshot::ReadManifest(dir, rejected, hash));
+    }
+
+    // Manifest changed after hashing is not accepted
+    manifest.Chunks[0].File = "main.0000.chunk";
+    WriteManifest(dir, manifest);
+    {
+        std::ofstream out((dir / "manifest.txt").string(), std::ios::app);
+        out << "chunk web.0000.chunk 1 00\n";
+    }
+    SnapshotManifest changed;
+    BOOST_CHECK(!Snapshot::ReadManifest(dir, changed, hash));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
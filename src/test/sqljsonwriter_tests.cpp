@@ -0,0 +1,161 @@
+// Copyright (c) 2018-2022 The Pocketnet developers
+// Distributed under the Apache 2.0 software license, see the accompanying
+// https://www.apache.org/licenses/LICENSE-2.0
+
+#include <pocketdb/helpers/SqlJsonWriter.h>
+
+#include <test/test_pocketcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+#include <limits>
+
+using namespace PocketHelpers;
+
+BOOST_FIXTURE_TEST_SUITE(sqljsonwriter_tests, BasicTestingSetup)
+
+// Strings with every escaped character, DEL, UTF-8 and invalid UTF-8 bytes
+static std::vector<std::string> TestStrings()
+{
+    std::vector<std::string> values = {
+        "",
+        "plain text",
+        "quote \" backslash \\ slash /",
+        "\b\t\n\f\r",
+        "del \x7f end",
+        "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80",
+        "invalid \xc3\x28 \xff\xfe \x80",
+        "\\u0000 \\\" \"\\",
+    };
+
+    std::string controls;
+    for (int c = 1; c < 0x20; c++)
+        controls += (char) c;
+    values.push_back(controls);
+
+    for (int n = 0; n < 500; n++)
+    {
+        std::string value;
+        int size = InsecureRandRange(40);
+        for (int i = 0; i < size; i++)
+            value += (char) (1 + InsecureRandRange(255));
+        values.push_back(value);
+    }
+
+    return values;
+}
+
+BOOST_AUTO_TEST_CASE(sqljsonwriter_string)
+{
+    for (const auto& value : TestStrings())
+    {
+        std::string out;
+        SqlJsonWriter::WriteString(out, value.data(), value.size());
+        BOOST_CHECK_EQUAL(out, UniValue(value).write());
+    }
+}
+
+static const SqlJsonSchema testSchema = {
+    { "text", 0 },
+    { "textRequired", 0, SqlJsonType::Text, true },
+    { "int", 1, SqlJsonType::Int },
+    { "real", 2, SqlJsonType::Real },
+    { "bool", 3, SqlJsonType::Bool },
+    { "json", 4, SqlJsonType::Json },
+    { "const", 1, SqlJsonType::Text, false, "true" },
+    { "null", 5 },
+    { "nullRequired", 5, SqlJsonType::Text, true },
+};
+
+// Object built the way repositories did before SqlJsonWriter - TryGetColumn* and pushKV
+static UniValue ReadRow(sqlite3_stmt* stmt)
+{
+    UniValue record(UniValue::VOBJ);
+
+    auto isNull = [stmt](int column) { return sqlite3_column_type(stmt, column) == SQLITE_NULL; };
+    auto text = [stmt](int column) { return std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, column))); };
+
+    if (!isNull(0)) record.pushKV("text", text(0));
+    record.pushKV("textRequired", isNull(0) ? "" : text(0));
+    if (!isNull(1)) record.pushKV("int", (int64_t) sqlite3_column_int64(stmt, 1));
+    if (!isNull(2)) record.pushKV("real", sqlite3_column_double(stmt, 2));
+    if (!isNull(3)) record.pushKV("bool", sqlite3_column_int64(stmt, 3) == 1);
+    if (!isNull(4))
+    {
+        UniValue json;
+        json.read(text(4));
+        record.pushKV("json", json);
+    }
+    if (!isNull(1)) record.pushKV("const", "true");
+    record.pushKV("nullRequired", "");
+
+    return record;
+}
+
+BOOST_AUTO_TEST_CASE(sqljsonwriter_rows)
+{
+    sqlite3* db = nullptr;
+    BOOST_REQUIRE(sqlite3_open(":memory:", &db) == SQLITE_OK);
+    BOOST_REQUIRE(sqlite3_exec(db, "create table t (t text, i int, r real, b int, j text, n text)", nullptr, nullptr, nullptr) == SQLITE_OK);
+
+    std::vector<int64_t> ints = { 0, 1, -1, 100000000, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min() };
+    std::vector<double> reals = { 0.0, 0.1, -2.5, 1.0 / 3, 1e300, -1e-300, 5e-324, 123456789012345678.0, 1e16, 0.30000000000000004 };
+
+    auto strings = TestStrings();
+    // Text written with NUL inside is read up to it
+    strings.push_back(std::string("before\0after", 12));
+
+    sqlite3_stmt* insert = nullptr;
+    BOOST_REQUIRE(sqlite3_prepare_v2(db, "insert into t values (?, ?, ?, ?, ?, null)", -1, &insert, nullptr) == SQLITE_OK);
+    for (size_t n = 0; n < strings.size(); n++)
+    {
+        UniValue json(UniValue::VARR);
+        json.push_back((int64_t) n);
+        json.push_back(std::to_string(n) + " \"json\"");
+
+        // Each column is NULL in a quarter of rows
+        auto bindNull = [&](int column) { return InsecureRandRange(4) == 0 && sqlite3_bind_null(insert, column) == SQLITE_OK; };
+        if (!bindNull(1)) sqlite3_bind_text(insert, 1, strings[n].data(), strings[n].size(), SQLITE_TRANSIENT);
+        if (!bindNull(2)) sqlite3_bind_int64(insert, 2, ints[n % ints.size()]);
+        if (!bindNull(3)) sqlite3_bind_double(insert, 3, reals[n % reals.size()] * (n % 3 == 2 ? -1 : 1));
+        if (!bindNull(4)) sqlite3_bind_int64(insert, 4, InsecureRandRange(3));
+        if (!bindNull(5)) sqlite3_bind_text(insert, 5, json.write().c_str(), -1, SQLITE_TRANSIENT);
+
+        BOOST_REQUIRE(sqlite3_step(insert) == SQLITE_DONE);
+        sqlite3_reset(insert);
+        sqlite3_clear_bindings(insert);
+    }
+    sqlite3_finalize(insert);
+
+    // Nested arrays check element separators on both levels
+    SqlJsonWriter writer;
+    UniValue expected(UniValue::VARR);
+
+    writer.BeginArray();
+    for (const auto& where : { "rowid % 2 = 0", "rowid % 2 = 1", "0" })
+    {
+        UniValue rows(UniValue::VARR);
+        writer.BeginArray();
+
+        sqlite3_stmt* stmt = nullptr;
+        BOOST_REQUIRE(sqlite3_prepare_v2(db, (std::string("select * from t where ") + where).c_str(), -1, &stmt, nullptr) == SQLITE_OK);
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            writer.WriteRow(stmt, testSchema);
+            rows.push_back(ReadRow(stmt));
+        }
+        sqlite3_finalize(stmt);
+
+        writer.EndArray();
+        expected.push_back(rows);
+    }
+    writer.EndArray();
+
+    sqlite3_close(db);
+
+    BOOST_CHECK(writer.Str() == expected.write());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1055,11 +1055,10 @@ void CTxMemPool::RemoveStaged(setEntries& stage, bool updateDescendants, MemPool
 
 void CTxMemPool::CleanSQLite(const std::unordered_set<std::string>& hashes, const std::string& func, MemPoolRemovalReason reason)
 {
+    PocketServices::MempoolWriterInst.Clean(hashes);
+
     for (const auto& hash : hashes)
-    {
-        PocketDb::TransRepoInst.CleanTransaction(hash);
         LogPrint(BCLog::SYNC, "%s: Clean SQLite mempool tx %s with reason %d\n", hash, func, (int)reason);
-    }
 }
 
 int CTxMemPool::Expire(int64_t time)
@@ -2,91 +2,142 @@
     Utilities for working with HTML
 */
 #include "utils/html.h"
+#include "utilstrencodings.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace HtmlUtils
 {
+    // Find first of two bytes in [begin, end) - returns end if not found.
+    // Texts are mostly plain words so long runs are skipped 16 bytes at a time.
+    static const char* FindAny(const char* begin, const char* end, char a, char b)
+    {
+        const char* p = begin;
+
+#if defined(__SSE2__)
+        const __m128i va = _mm_set1_epi8(a);
+        const __m128i vb = _mm_set1_epi8(b);
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+            if (mask != 0)
+                return p + __builtin_ctz(mask);
+        }
+#endif
+
+        for (; p < end; p++)
+            if (*p == a || *p == b)
+                return p;
+
+        return end;
+    }
+
+    // RFC 3986 unreserved characters - independent of current locale
+    static bool IsUnreserved(unsigned char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '-' || c == '_' || c == '.' || c == '~';
+    }
+
     std::string ClearHtmlTags(const std::string& value)
     {
-        bool copy = true;
-        std::string plainString = "";
-        std::stringstream convertStream;
+        std::string result;
+        result.reserve(value.size());
+
+        const char* p = value.data();
+        const char* end = p + value.size();
 
-        // remove all xml tags
-        for (size_t i = 0; i < value.length(); i++)
+        // Text outside of tags is copied by runs, stray '>' is dropped
+        while (p < end)
         {
-            convertStream << value[i];
+            const char* mark = FindAny(p, end, '<', '>');
+            result.append(p, mark);
+            if (mark == end)
+                break;
 
-            if (convertStream.str().compare("<") == 0) copy = false;
-            else if (convertStream.str().compare(">") == 0)
+            p = mark + 1;
+            if (*mark == '<')
             {
-                copy = true;
-                convertStream.str(std::string());
-                continue;
-            }
+                const char* close = static_cast<const char*>(memchr(p, '>', end - p));
+                if (!close)
+                    break;
 
-            if (copy) plainString.append(convertStream.str());
-
-            convertStream.str(std::string());
+                p = close + 1;
+            }
         }
 
-        return plainString;
+        return result;
     }
 
     std::string UrlEncode(const std::string& value)
     {
-        std::string new_str = "";
-        char c;
-        int ic;
-        const char* chars = value.c_str();
-        char bufHex[10];
-        int len = value.length();
-        
-        for (int i = 0; i < len; i++) {
-            c = chars[i];
-            ic = c;
-            if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~')
-                new_str += c;
-            else {
-                #ifdef WIN32
-                sprintf_s(bufHex, "%X", c);
-                #else
-                sprintf(bufHex, "%X", c);
-                #endif
-                if (ic < 16)
-                    new_str += "%0";
-                else
-                    new_str += "%";
-                new_str += bufHex;
+        static const char hex[] = "0123456789ABCDEF";
+
+        size_t size = value.size();
+        for (unsigned char c : value)
+            if (!IsUnreserved(c))
+                size += 2;
+
+        std::string result(size, '\0');
+        char* out = &result[0];
+        for (unsigned char c : value)
+        {
+            if (IsUnreserved(c))
+            {
+                *out++ = (char) c;
+            }
+            else
+            {
+                *out++ = '%';
+                *out++ = hex[c >> 4];
+                *out++ = hex[c & 15];
             }
         }
-        return new_str;
+
+        return result;
     }
 
     std::string UrlDecode(const std::string& value)
     {
-        std::string ret;
-        char ch;
-        int i, ii, len = value.length();
-
-        for (i = 0; i < len; i++) {
-            if (value[i] != '%') {
-                if (value[i] == '+')
-                    ret += ' ';
-                else
-                    ret += value[i];
+        std::string result;
+        result.reserve(value.size());
+
+        const char* p = value.data();
+        const char* end = p + value.size();
+
+        while (p < end)
+        {
+            const char* mark = FindAny(p, end, '%', '+');
+            result.append(p, mark);
+            if (mark == end)
+                break;
+
+            p = mark + 1;
+            if (*mark == '+')
+            {
+                result += ' ';
+                continue;
             }
-            else {
-                #ifdef WIN32
-                sscanf_s(value.substr(i + 1, 2).c_str(), "%x", &ii);
-                #else
-                sscanf(value.substr(i + 1, 2).c_str(), "%x", &ii);
-                #endif
-                ch = static_cast<char>(ii);
-                ret += ch;
-                i = i + 2;
+
+            // Malformed escape sequence is kept as is
+            int hi = end - p >= 2 ? HexDigit(p[0]) : -1;
+            int lo = hi >= 0 ? HexDigit(p[1]) : -1;
+            if (lo < 0)
+            {
+                result += '%';
+                continue;
             }
+
+            result += static_cast<char>((hi << 4) | lo);
+            p += 2;
         }
-        return ret;
+
+        return result;
     }
 
     void StringToLower(std::string& value)
@@ -94,4 +145,4 @@ namespace HtmlUtils
         std::transform(value.begin(), value.end(), value.begin(), [](char c) { return 'A' <= c && c <= 'Z' ? c ^ 32 : c; });
     }
 
-} // namespace HtmlUtils
\ No newline at end of file
+} // namespace HtmlUtils
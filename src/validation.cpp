@@ -6,6 +6,7 @@
 #include <validation.h>
 
 #include <arith_uint256.h>
+#include <blockreader.h>
 #include <chain.h>
 #include <chainparams.h>
 #include <checkpoints.h>
@@ -44,6 +45,9 @@
 #include "pocketdb/services/ChainPostProcessing.h"
 #include "pocketdb/services/Accessor.h"
 #include "pocketdb/consensus/Helper.h"
+#include "pocketdb/SQLiteConnection.h"
+
+#include <future>
 
 
 #if defined(NDEBUG)
@@ -190,7 +194,7 @@ public:
 
     // Block disconnection on our pcoinsTip:
     bool DisconnectTip(CValidationState& state, const CChainParams& chainparams,
-        DisconnectedBlockTransactions* disconnectpool);
+        DisconnectedBlockTransactions* disconnectpool, bool fPocketRollback = true);
 
     // Manual block validity manipulation:
     bool
@@ -222,8 +226,8 @@ private:
     bool ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew,
         const std::shared_ptr<const CBlock>& pblock,
         const std::shared_ptr<PocketHelpers::PocketBlock>& pocketBlockPart,
-        ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool) EXCLUSIVE_LOCKS_REQUIRED(
-        cs_main);
+        ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool,
+        bool fPocketChecked = false) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     void NotifyWSClients(const CBlock& block, CBlockIndex* blockIndex);
 
@@ -1066,7 +1070,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
 
         // Restore and validate pocketnet part
         PTransactionRef _pocketTx = pocketTx;
-        if (!_pocketTx && !PocketDb::TransRepoInst.Exists(tx.GetHash().GetHex()))
+        if (!_pocketTx && !PocketServices::MempoolWriterInst.Exists(tx.GetHash().GetHex()))
         {
             // Try deserialize transaction
             if (auto[ok, val] = PocketServices::Serializer::DeserializeTransaction(ptx); ok && val)
@@ -1128,7 +1132,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
             try
             {
                 PocketBlock pocketBlock{_pocketTx};
-                PocketDb::TransRepoInst.InsertTransactions(pocketBlock);
+                PocketServices::MempoolWriterInst.Insert(pocketBlock);
             }
             catch (const std::exception& e)
             {
@@ -1276,24 +1280,36 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
-
-    // Read block
-    try
+    // Recently read blocks are already checked
+    if (auto recent = g_block_reader.GetRecent(pos))
     {
-        filein >> block;
-    } catch (const std::exception& e)
+        block = *recent;
+        return true;
+    }
+
+    // Read block from mapped file or with the file stream if it can not be mapped
+    if (!g_block_reader.ReadBlock(pos, block))
     {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        // Open history file to read
+        CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull())
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+
+        // Read block
+        try
+        {
+            filein >> block;
+        } catch (const std::exception& e)
+        {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
     }
 
     // Check the header
     if (block.IsProofOfWork() && !CheckProofOfWork(block.GetHash(), block.nBits, consensusParams, 0))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
 
+    g_block_reader.PutRecent(pos, block);
     return true;
 }
 
@@ -2483,82 +2499,103 @@ bool CChainState::ConnectBlock(const CBlock& block, const PocketBlockRef& pocket
                 REJECT_INVALID, "bad-cb-amount");
     }
 
-    if (!control.Wait())
-        return state.DoS(100, error("%s: CheckQueue failed", __func__), REJECT_INVALID, "block-validation-failed");
-
     // -----------------------------------------------------------------------------------------------------------------
-    // We can skip some of the on-demand checks or partial reindexing
+    // Pocketnet checks do not depend on the script results - they run in this thread while
+    // the script check workers verify signatures. Script failure is still reported first.
     int64_t nTime5 = GetTimeMicros();
+    CValidationState pocketState;
+    bool enablePocketConnect = false;
 
-    // We can skip checking and indexing existing data to avoid duplication of work.
-    auto[blockExists, blockLast] = PocketDb::ChainRepoInst.ExistsBlock(block.GetHash().GetHex(), pindex->nHeight);
-
-    // Rollback db if need
-    if ((blockExists && blockLast) || (!blockExists && !blockLast))
+    auto checkPocket = [&]() -> bool
     {
-        if (!PocketServices::ChainPostProcessing::Rollback(pindex->nHeight))
-            return error("ConnectBlock: Rollback (Pocketnet part) %s failed", pindex->GetBlockHash().ToString());
-    }
+        // We can skip some of the on-demand checks or partial reindexing
+        // We can skip checking and indexing existing data to avoid duplication of work.
+        auto[blockExists, blockLast] = PocketDb::ChainRepoInst.ExistsBlock(block.GetHash().GetHex(), pindex->nHeight);
 
-    // If the block is not in the database or it is the last one, we have to check and index
-    bool enablePocketConnect = (!blockExists || blockLast);
-    int skipValidation = gArgs.GetArg("-skip-validation", -1);
+        // Rollback db if need
+        if ((blockExists && blockLast) || (!blockExists && !blockLast))
+        {
+            if (!PocketServices::ChainPostProcessing::Rollback(pindex->nHeight))
+                return error("ConnectBlock: Rollback (Pocketnet part) %s failed", pindex->GetBlockHash().ToString());
+        }
+
+        // If the block is not in the database or it is the last one, we have to check and index
+        enablePocketConnect = (!blockExists || blockLast);
+        int skipValidation = gArgs.GetArg("-skip-validation", -1);
     
-    if (enablePocketConnect && pindex->nHeight > skipValidation)
-    {
-        // Checks PoS logic
-        if (pindex->nHeight == (int)Params().GetConsensus().nHeight_version_1_0_0_pre)
+        if (enablePocketConnect && pindex->nHeight > skipValidation)
         {
-            if (pindex->GetBlockHash().GetHex() != Params().GetConsensus().sVersion_1_0_0_pre_checkpoint)
+            // Checks PoS logic
+            if (pindex->nHeight == (int)Params().GetConsensus().nHeight_version_1_0_0_pre)
             {
-                return state.DoS(100, error("ConnectBlock() : incorrect proof of stake transaction checkpoint"));
+                if (pindex->GetBlockHash().GetHex() != Params().GetConsensus().sVersion_1_0_0_pre_checkpoint)
+                {
+                    return pocketState.DoS(100, error("ConnectBlock() : incorrect proof of stake transaction checkpoint"));
+                }
             }
-        }
 
-        if (pindex->nHeight > (int)Params().GetConsensus().nHeight_version_1_0_0_pre && block.IsProofOfStake())
-        {
-            int64_t nCalculatedStakeReward = GetProofOfStakeReward(pindex->nHeight, nFees, chainparams.GetConsensus());
-            if (nStakeReward > nCalculatedStakeReward)
-                return state.DoS(100, error("ConnectBlock() : coinstake pays too much(actual=%d vs calculated=%d)", nStakeReward, nCalculatedStakeReward));
+            if (pindex->nHeight > (int)Params().GetConsensus().nHeight_version_1_0_0_pre && block.IsProofOfStake())
+            {
+                int64_t nCalculatedStakeReward = GetProofOfStakeReward(pindex->nHeight, nFees, chainparams.GetConsensus());
+                if (nStakeReward > nCalculatedStakeReward)
+                    return pocketState.DoS(100, error("ConnectBlock() : coinstake pays too much(actual=%d vs calculated=%d)", nStakeReward, nCalculatedStakeReward));
+
+                int64_t nReward = GetProofOfStakeReward(pindex->nHeight, 0, chainparams.GetConsensus());
+
+                if (!CheckBlockRatingRewards(block, pindex->pprev, nReward, hashProofOfStakeSource))
+                {
+                    // We do not accept blocks that do not meet the consensus conditions,
+                    // but we should not mark them invalid for cases when the block is processed after the orphan.
+                    return false;
+                }
+            }
 
-            int64_t nReward = GetProofOfStakeReward(pindex->nHeight, 0, chainparams.GetConsensus());
+            int64_t nTime4 = GetTimeMicros();
+            nTimeVerify += nTime4 - nTime3;
+            LogPrint(BCLog::BENCH, "    - Checking rewards: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n",
+                MILLI * (nTime4 - nTime3), nInputs <= 1 ? 0 : MILLI * (nTime4 - nTime3) / (nInputs - 1), nTimeVerify * MICRO,
+                nTimeVerify * MILLI / nBlocksTotal);
 
-            if (!CheckBlockRatingRewards(block, pindex->pprev, nReward, hashProofOfStakeSource))
+            // -------------------------------------------------------------------------------------------------------------
+            // Pocketnet Consensus rules
+            if (auto[ok, result] = PocketConsensus::SocialConsensusHelper::Validate(block, pocketBlock, pindex->nHeight); !ok)
             {
-                // We do not accept blocks that do not meet the consensus conditions,
-                // but we should not mark them invalid for cases when the block is processed after the orphan.
-                return false;
+                LogPrintf("WARNING: SocialConsensus validating failed with result %d for block %s\n",
+                    (int)result, pindex->GetBlockHash().GetHex());
+
+                // We do not mark the block invalid for situations where the chain can be rebuilt.
+                // There is a danger of a fork in this case or endless attempts to connect an invalid or destroyed block - 
+                // we need to think about marking the block incomplete and requesting it from the network again.
+                return pocketState.DoS(200, false, REJECT_INCOMPLETE, "failed-validate-social-consensus", false, "", true);
             }
+        
+            LogPrint(BCLog::CONSENSUS, "    Block validated: %d BH: %s\n", pindex->nHeight, block.GetHash().GetHex());
+
+            nTime5 = GetTimeMicros();
+            nTimeVerify += nTime5 - nTime4;
+            LogPrint(BCLog::BENCH, "    - Consensus validation: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n",
+                MILLI * (nTime5 - nTime4), nInputs <= 1 ? 0 : MILLI * (nTime5 - nTime4) / (nInputs - 1), nTimeVerify * MICRO,
+                nTimeVerify * MILLI / nBlocksTotal);
         }
 
-        int64_t nTime4 = GetTimeMicros();
-        nTimeVerify += nTime4 - nTime3;
-        LogPrint(BCLog::BENCH, "    - Checking rewards: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n",
-            MILLI * (nTime4 - nTime3), nInputs <= 1 ? 0 : MILLI * (nTime4 - nTime3) / (nInputs - 1), nTimeVerify * MICRO,
-            nTimeVerify * MILLI / nBlocksTotal);
+        return true;
+    };
 
-        // -----------------------------------------------------------------------------------------------------------------
-        // Pocketnet Consensus rules
-        if (auto[ok, result] = PocketConsensus::SocialConsensusHelper::Validate(block, pocketBlock, pindex->nHeight); !ok)
-        {
-            LogPrintf("WARNING: SocialConsensus validating failed with result %d for block %s\n",
-                (int)result, pindex->GetBlockHash().GetHex());
+    bool fPocketValid = checkPocket();
 
-            // We do not mark the block invalid for situations where the chain can be rebuilt.
-            // There is a danger of a fork in this case or endless attempts to connect an invalid or destroyed block - 
-            // we need to think about marking the block incomplete and requesting it from the network again.
-            return state.DoS(200, false, REJECT_INCOMPLETE, "failed-validate-social-consensus", false, "", true);
-        }
-        
-        LogPrint(BCLog::CONSENSUS, "    Block validated: %d BH: %s\n", pindex->nHeight, block.GetHash().GetHex());
+    if (!control.Wait())
+        return state.DoS(100, error("%s: CheckQueue failed", __func__), REJECT_INVALID, "block-validation-failed");
 
-        nTime5 = GetTimeMicros();
-        nTimeVerify += nTime5 - nTime4;
-        LogPrint(BCLog::BENCH, "    - Consensus validation: %.2fms (%.3fms/txin) [%.2fs (%.2fms/blk)]\n",
-            MILLI * (nTime5 - nTime4), nInputs <= 1 ? 0 : MILLI * (nTime5 - nTime4) / (nInputs - 1), nTimeVerify * MICRO,
-            nTimeVerify * MILLI / nBlocksTotal);
+    if (!fPocketValid)
+    {
+        state = pocketState;
+        return false;
     }
 
+    int64_t nTimeWait = GetTimeMicros();
+    LogPrint(BCLog::BENCH, "    - Script checks wait: %.2fms\n", MILLI * (nTimeWait - nTime5));
+    nTime5 = nTimeWait;
+
     // -----------------------------------------------------------------------------------------------------------------
     // Finalize connect
     if (fJustCheck)
@@ -2600,6 +2637,10 @@ bool CChainState::ConnectBlock(const CBlock& block, const PocketBlockRef& pocket
             PocketServices::WebPostProcessorInst.Enqueue(pindex->nHeight);
     }
 
+    // Block committed to SQLite - good time for checkpoint WAL
+    if (enablePocketConnect)
+        PocketServices::WalCheckpointerInst.Notify(pindex->nHeight);
+
     // -----------------------------------------------------------------------------------------------------------------
     if (!WriteUndoDataForBlock(blockundo, state, pindex, chainparams))
         return false;
@@ -2871,9 +2912,12 @@ void static UpdateTip(const CBlockIndex* pindexNew, const CChainParams& chainPar
   * If disconnectpool is nullptr, then no disconnected transactions are added to
   * disconnectpool (note that the caller is responsible for mempool consistency
   * in any case).
+  *
+  * If fPocketRollback is false, the caller is responsible for rollback of pocket
+  * database after disconnecting - this allows rollback many blocks in one pass.
   */
 bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& chainparams,
-    DisconnectedBlockTransactions* disconnectpool)
+    DisconnectedBlockTransactions* disconnectpool, bool fPocketRollback)
 {
     CBlockIndex* pindexDelete = chainActive.Tip();
     assert(pindexDelete);
@@ -2890,7 +2934,7 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
         if (DisconnectBlock(block, pindexDelete, view) != DISCONNECT_OK)
             return error("DisconnectTip(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
 
-        if (!PocketServices::ChainPostProcessing::Rollback(chainActive.Height()))
+        if (fPocketRollback && !PocketServices::ChainPostProcessing::Rollback(chainActive.Height()))
             return error("DisconnectTip(): DisconnectBlock (Pocketnet part) %s failed", pindexDelete->GetBlockHash().ToString());
 
         bool flushed = view.Flush();
@@ -3014,13 +3058,14 @@ public:
 /**
  * Connect a new block to chainActive. pblock is either nullptr or a pointer to a CBlock
  * corresponding to pindexNew, to bypass loading it again from disk.
+ * fPocketChecked is set when stateless social checks of pocketBlockPart already passed.
  *
  * The block is added to connectTrace if connection succeeds.
  */
 bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainparams, CBlockIndex* pindexNew,
     const std::shared_ptr<const CBlock>& pblock,
     const std::shared_ptr<PocketHelpers::PocketBlock>& pocketBlockPart,
-    ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool)
+    ConnectTrace& connectTrace, DisconnectedBlockTransactions& disconnectpool, bool fPocketChecked)
 {
     assert(pindexNew->pprev == chainActive.Tip());
 
@@ -3047,7 +3092,9 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     else
         pocketBlock = pocketBlockPart;
 
-    if (auto[ok, result] = PocketConsensus::SocialConsensusHelper::Check(blockConnecting, pocketBlock, pindexNew->nHeight); !ok)
+    // Stateless checks of prefetched block already ran in background
+    bool fChecked = fPocketChecked && pblock && pocketBlockPart;
+    if (!fChecked && !std::get<0>(PocketConsensus::SocialConsensusHelper::Check(blockConnecting, pocketBlock, pindexNew->nHeight)))
     {
         pindexNew->nStatus &= ~BLOCK_HAVE_DATA;
         return state.DoS(200, false, REJECT_INCOMPLETE, "failed-find-social-payload", false, "", true);
@@ -3248,6 +3295,44 @@ void CChainState::PruneBlockIndexCandidates()
     assert(!setBlockIndexCandidates.empty());
 }
 
+/**
+ * Block and its social payload read ahead of ConnectTip. Empty members are read by ConnectTip itself.
+ */
+struct PrefetchedBlock
+{
+    std::shared_ptr<const CBlock> block;
+    PocketBlockRef pocketBlock;
+    // Stateless social checks of the payload passed
+    bool checked = false;
+};
+
+/**
+ * Read the next block to connect while the current one is connected. Runs without cs_main,
+ * so the block position is taken by the caller. Payload is read with a separate read-only
+ * connection - it is stored by AcceptBlock and is not changed by indexing of previous blocks.
+ * Stateless social checks do not depend on the chain either and run here too. Failed checks
+ * are repeated by ConnectTip, which reports the result.
+ */
+static PrefetchedBlock PrefetchBlock(const CDiskBlockPos pos, const uint256 hash, const int height,
+    const DbConnectionRef dbConnection, const Consensus::Params& consensusParams)
+{
+    PrefetchedBlock result;
+
+    auto block = std::make_shared<CBlock>();
+    if (!ReadBlockFromDisk(*block, pos, consensusParams) || block->GetHash() != hash)
+        return result;
+    result.block = block;
+
+    PocketBlockRef pocketBlock;
+    if (PocketServices::Accessor::GetBlock(*block, pocketBlock, *dbConnection->TransactionRepoInst))
+    {
+        result.pocketBlock = pocketBlock;
+        result.checked = std::get<0>(PocketConsensus::SocialConsensusHelper::Check(*block, pocketBlock, height));
+    }
+
+    return result;
+}
+
 /**
  * Try to make some progress towards making pindexMostWork the active block.
  * pblock is either nullptr or a pointer to a CBlock corresponding to pindexMostWork.
@@ -3263,12 +3348,18 @@ bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainPar
     const CBlockIndex* pindexFork = chainActive.FindFork(pindexMostWork);
 
     // Disconnect active blocks which are no longer in the best chain.
+    // Pocket database is rolled back once for all disconnected blocks - also when a disconnect fails midway.
+    // Rows left above the tip when the node stops before rollback are removed by ConnectBlock of the next
+    // block, ExistsBlock reports rows of other block at its height.
     bool fBlocksDisconnected = false;
     DisconnectedBlockTransactions disconnectpool;
     while (chainActive.Tip() && chainActive.Tip() != pindexFork)
     {
-        if (!DisconnectTip(state, chainparams, &disconnectpool))
+        if (!DisconnectTip(state, chainparams, &disconnectpool, false))
         {
+            if (fBlocksDisconnected && !PocketServices::ChainPostProcessing::Rollback(chainActive.Height() + 1))
+                LogPrintf("%s: Rollback (Pocketnet part) to height %d failed\n", __func__, chainActive.Height() + 1);
+
             // This is likely a fatal error, but keep the mempool consistent,
             // just in case. Only remove from the mempool in this case.
             UpdateMempoolForReorg(disconnectpool, false);
@@ -3277,8 +3368,16 @@ bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainPar
         fBlocksDisconnected = true;
     }
 
+    if (fBlocksDisconnected && !PocketServices::ChainPostProcessing::Rollback(chainActive.Height() + 1))
+    {
+        UpdateMempoolForReorg(disconnectpool, false);
+        return error("%s: Rollback (Pocketnet part) to height %d failed", __func__, chainActive.Height() + 1);
+    }
+
     // Build list of new blocks to connect.
     std::vector<CBlockIndex*> vpindexToConnect;
+    DbConnectionRef prefetchConnection;
+    bool fPrefetchFailed = false;
     bool fContinue = true;
     int nHeight = pindexFork ? pindexFork->nHeight : -1;
     while (fContinue && nHeight != pindexMostWork->nHeight)
@@ -3297,12 +3396,41 @@ bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainPar
         nHeight = nTargetHeight;
 
         // Connect new blocks.
-        for (CBlockIndex* pindexConnect : reverse_iterate(vpindexToConnect))
+        // The next block and its payload are read in background while the current block is connected.
+        std::future<PrefetchedBlock> prefetch;
+        for (auto it = vpindexToConnect.rbegin(); it != vpindexToConnect.rend(); ++it)
         {
+            CBlockIndex* pindexConnect = *it;
+
+            PrefetchedBlock prefetched;
+            if (prefetch.valid())
+                prefetched = prefetch.get();
+
+            auto itNext = std::next(it);
+            if (itNext != vpindexToConnect.rend() && !(*itNext == pindexMostWork && pblock) && ((*itNext)->nStatus & BLOCK_HAVE_DATA))
+            {
+                if (!prefetchConnection && !fPrefetchFailed)
+                {
+                    try
+                    {
+                        prefetchConnection = std::make_shared<PocketDb::SQLiteConnection>();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        LogPrintf("%s: Blocks are not prefetched - %s\n", __func__, e.what());
+                        fPrefetchFailed = true;
+                    }
+                }
+
+                if (prefetchConnection)
+                    prefetch = std::async(std::launch::async, PrefetchBlock, (*itNext)->GetBlockPos(),
+                        (*itNext)->GetBlockHash(), (*itNext)->nHeight, prefetchConnection, std::cref(chainparams.GetConsensus()));
+            }
+
             if (!ConnectTip(state, chainparams, pindexConnect,
-                pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(),
-                pindexConnect == pindexMostWork ? pocketBlock : nullptr,
-                connectTrace, disconnectpool))
+                pindexConnect == pindexMostWork && pblock ? pblock : prefetched.block,
+                pindexConnect == pindexMostWork && pblock ? pocketBlock : prefetched.pocketBlock,
+                connectTrace, disconnectpool, !(pindexConnect == pindexMostWork && pblock) && prefetched.checked))
             {
                 if (state.IsInvalid())
                 {
@@ -3514,16 +3642,22 @@ bool ActivateBestChain(CValidationState& state, const CChainParams& chainparams,
 
 bool DisconnectTip(CValidationState& state, const CChainParams& chainparams, int height)
 {
+    bool disconnected = true;
     while (chainActive.Tip() && chainActive.Height() > height)
     {
         if (ShutdownRequested())
-            return true;
+            break;
 
-        if (!g_chainstate.DisconnectTip(state, chainparams, nullptr))
-            return false;
+        if (!g_chainstate.DisconnectTip(state, chainparams, nullptr, false))
+        {
+            disconnected = false;
+            break;
+        }
     }
 
-    return true;
+    // Rollback pocket database for all disconnected blocks in one pass - also after a failed disconnect
+    bool rolledBack = PocketServices::ChainPostProcessing::Rollback(chainActive.Height() + 1);
+    return disconnected && rolledBack;
 }
 
 bool CChainState::PreciousBlock(CValidationState& state, const CChainParams& params, CBlockIndex* pindex)
@@ -4806,6 +4940,7 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it)
     {
         CDiskBlockPos pos(*it, 0);
+        g_block_reader.ForgetFile(*it);
         fs::remove(GetBlockPosFilename(pos, "blk"));
         fs::remove(GetBlockPosFilename(pos, "rev"));
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
@@ -5447,19 +5582,25 @@ bool CChainState::RewindBlockIndex(const CChainParams& params)
             // of the blockchain).
             break;
         }
-        if (!DisconnectTip(state, params, nullptr))
+        if (!DisconnectTip(state, params, nullptr, false))
         {
+            PocketServices::ChainPostProcessing::Rollback(chainActive.Height() + 1);
             return error("RewindBlockIndex: unable to disconnect block at height %i (%s)", pindex->nHeight,
                 FormatStateMessage(state));
         }
         // Occasionally flush state to disk.
         if (!FlushStateToDisk(params, state, FlushStateMode::PERIODIC))
         {
+            PocketServices::ChainPostProcessing::Rollback(chainActive.Height() + 1);
             LogPrintf("RewindBlockIndex: unable to flush state to disk (%s)\n", FormatStateMessage(state));
             return false;
         }
     }
 
+    // Rollback pocket database for all disconnected blocks in one pass
+    if (!PocketServices::ChainPostProcessing::Rollback(chainActive.Height() + 1))
+        return error("RewindBlockIndex: unable to rollback pocket database to height %i", chainActive.Height() + 1);
+
     // Reduce validity flag and have-data flags.
     // We do this after actual disconnecting, otherwise we'll end up writing the lack of data
     // to disk before writing the chainstate, resulting in a failure to continue if interrupted.
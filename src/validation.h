@@ -24,6 +24,7 @@
 #include <versionbits.h>
 #include <streams.h>
 #include <protectedmap.h>
+#include <websocket/addressindex.h>
 
 #include <algorithm>
 #include <exception>
@@ -44,6 +45,7 @@ using namespace PocketHelpers;
 
 extern std::shared_ptr<Queue<std::pair<CBlock, CBlockIndex*>>> notifyClientsQueue;
 extern std::shared_ptr<ProtectedMap<std::string, WSUser>> WSConnections;
+extern std::shared_ptr<WSAddressIndex> WSAddresses;
 
 class CBlockIndex;
 
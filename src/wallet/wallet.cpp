@@ -620,6 +620,7 @@ bool CWallet::IsSpent(const uint256& hash, unsigned int n) const
 void CWallet::AddToSpends(const COutPoint& outpoint, const uint256& wtxid)
 {
 	mapTxSpends.insert(std::make_pair(outpoint, wtxid));
+	MarkStakeDirty(outpoint.hash);
 
 	setLockedCoins.erase(outpoint);
 
@@ -813,6 +814,9 @@ void CWallet::MarkDirty()
 		LOCK(cs_wallet);
 		for (std::pair<const uint256, CWalletTx>& item : mapWallet)
 			item.second.MarkDirty();
+
+		// IsMine may be changed - rebuild stake index
+		fStakeIndexLoaded = false;
 	}
 }
 
@@ -911,6 +915,7 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, bool fFlushOnClose)
 
 	// Break debit/credit balance caches:
 	wtx.MarkDirty();
+	MarkStakeDirty(hash);
 
 	// Notify UI of new or updated transaction
 	NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -1021,6 +1026,7 @@ void CWallet::MarkInputsDirty(const CTransactionRef& tx)
 		auto it = mapWallet.find(txin.prevout.hash);
 		if (it != mapWallet.end()) {
 			it->second.MarkDirty();
+			MarkStakeDirty(txin.prevout.hash);
 		}
 	}
 }
@@ -1061,6 +1067,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
 			wtx.nIndex = -1;
 			wtx.setAbandoned();
 			wtx.MarkDirty();
+			MarkStakeDirty(now);
 			batch.WriteTx(wtx);
 			NotifyTransactionChanged(this, wtx.GetHash(), CT_UPDATED);
 			// Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
@@ -1118,6 +1125,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, const uint256& hashTx)
 			wtx.nIndex = -1;
 			wtx.hashBlock = hashBlock;
 			wtx.MarkDirty();
+			MarkStakeDirty(now);
 			batch.WriteTx(wtx);
 			// Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
 			TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -1191,6 +1199,8 @@ void CWallet::TransactionAddedToMempool(const CTransactionRef& ptx) {
 	if (it != mapWallet.end()) {
 		it->second.fInMempool = true;
 	}
+
+	UpdateStakeIndex();
 }
 
 void CWallet::TransactionRemovedFromMempool(const CTransactionRef &ptx) {
@@ -1221,6 +1231,8 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
 	}
 
 	m_last_block_processed = pindex;
+
+	UpdateStakeIndex();
 }
 
 void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
@@ -1229,6 +1241,8 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
 	for (const CTransactionRef& ptx : pblock->vtx) {
 		SyncTransaction(ptx);
 	}
+
+	UpdateStakeIndex();
 }
 
 
@@ -3097,6 +3111,9 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
 		mapWallet.erase(it);
 	}
 
+	// Stake index keeps pointers to wallet transactions
+	fStakeIndexLoaded = false;
+
 	if (nZapSelectTxRet == DBErrors::NEED_REWRITE)
 	{
 		if (database->Rewrite("\x04pool"))
@@ -4492,93 +4509,178 @@ bool CWallet::GetKeyOrigin(const CKeyID& keyID, KeyOriginInfo& info) const
 	return true;
 }
 
-void CWallet::AvailableCoinsForStaking(std::vector<COutput>& vCoins, unsigned int nSpendTime) const {
-	vCoins.clear();
+void CWallet::RemoveStakeOutputs(const uint256& hash) const
+{
+	auto it = mapStakeOutputs.lower_bound(COutPoint(hash, 0));
+	while (it != mapStakeOutputs.end() && it->first.hash == hash) {
+		const CStakeOutput& output = it->second;
 
-	{
-		LOCK2(cs_main, cs_wallet);
-		for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it) {
-			const CWalletTx* pcoin = &(*it).second;
-			const uint256& wtxid = it->first;
+		auto range = mapStakeOutputsByTime.equal_range(output.nStakeTime);
+		for (auto itTime = range.first; itTime != range.second; ++itTime) {
+			if (itTime->second == it->first) {
+				mapStakeOutputsByTime.erase(itTime);
+				break;
+			}
+		}
 
-			// Filtering by tx timestamp instead of block timestamp may give false positives but never false negatives
-			if (pcoin->tx->nTime + Params().GetConsensus().nStakeMinAge > nSpendTime) {
-				continue;
+		if (output.fDest) {
+			auto itBalance = mapStakeBalances.find(output.dest);
+			if (itBalance != mapStakeBalances.end() && (itBalance->second -= output.nValue) <= 0) {
+				mapStakeBalances.erase(itBalance);
 			}
+		}
+
+		it = mapStakeOutputs.erase(it);
+	}
+}
 
-			if ((pcoin->IsCoinBase() || pcoin->IsCoinStake()) && pcoin->GetBlocksToMaturity() > 0) {
+void CWallet::UpdateStakeIndex() const
+{
+	AssertLockHeld(cs_main);
+	AssertLockHeld(cs_wallet);
+
+	nStakeTipHeight = chainActive.Height();
+
+	if (!fStakeIndexLoaded) {
+		mapStakeOutputs.clear();
+		mapStakeOutputsByTime.clear();
+		mapStakeBalances.clear();
+		setStakeDirty.clear();
+		for (const auto& item : mapWallet) {
+			setStakeDirty.insert(item.first);
+		}
+		fStakeIndexLoaded = true;
+	}
+
+	for (const uint256& hash : setStakeDirty) {
+		RemoveStakeOutputs(hash);
+
+		auto it = mapWallet.find(hash);
+		if (it == mapWallet.end()) {
+			continue;
+		}
+
+		const CWalletTx* pcoin = &it->second;
+		if (pcoin->isAbandoned() || pcoin->GetDepthInMainChain() < 1) {
+			continue;
+		}
+
+		const CBlockIndex* pindex = LookupBlockIndex(pcoin->hashBlock);
+		if (!pindex) {
+			continue;
+		}
+
+		for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
+			const CTxOut& txout = pcoin->tx->vout[i];
+
+			isminetype mine = IsMine(txout);
+			if (mine == ISMINE_NO || IsSpent(hash, i)) {
 				continue;
 			}
 
-			if (pcoin->isAbandoned()) {
-				continue;
+			CStakeOutput output;
+			output.tx = pcoin;
+			output.i = i;
+			output.nValue = txout.nValue;
+			output.mine = mine;
+			output.fDest = ExtractDestination(txout.scriptPubKey, output.dest);
+			output.nHeight = pindex->nHeight;
+			output.fMaturity = pcoin->IsCoinBase() || pcoin->IsCoinStake();
+			output.nStakeTime = pcoin->tx->nTime + Params().GetConsensus().nStakeMinAge;
+
+			COutPoint outpoint(hash, i);
+			mapStakeOutputsByTime.emplace(output.nStakeTime, outpoint);
+			if (output.fDest) {
+				mapStakeBalances[output.dest] += output.nValue;
 			}
+			mapStakeOutputs.emplace(outpoint, std::move(output));
+		}
+	}
 
-			int nDepth = pcoin->GetDepthInMainChain();
+	setStakeDirty.clear();
+}
+
+void CWallet::GetStakeOutputs(std::vector<CStakeOutput>& vOutputs, unsigned int nSpendTime) const
+{
+	vOutputs.clear();
 
-			if (nDepth < 1) {
+	const auto collect = [&]() {
+		// Filtering by tx timestamp instead of block timestamp may give false positives but never false negatives
+		for (auto it = mapStakeOutputsByTime.begin(); it != mapStakeOutputsByTime.upper_bound(nSpendTime); ++it) {
+			const CStakeOutput& output = mapStakeOutputs.at(it->second);
+
+			int nDepth = nStakeTipHeight - output.nHeight + 1;
+			if (output.fMaturity && (COINBASE_MATURITY + 1) - nDepth > 0) {
 				continue;
 			}
 
-			for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-				if (IsMine(pcoin->tx->vout[i])) {
-					if (!IsSpent(wtxid, i)) {
-						vCoins.push_back(COutput(pcoin, i, nDepth, true, (IsMine(pcoin->tx->vout[i]) & (ISMINE_SPENDABLE)) != ISMINE_NO));
-					}
-				}
+			// Addresses with all indexed outputs below threshold can't be used for staking
+			if (!output.fDest) {
+				continue;
+			}
+			auto itBalance = mapStakeBalances.find(output.dest);
+			if (itBalance == mapStakeBalances.end() || itBalance->second < Params().GetConsensus().nStakeMinimumThreshold) {
+				continue;
 			}
+
+			vOutputs.push_back(output);
+			vOutputs.back().nDepth = nDepth;
+		}
+
+		// Keep the order of mapWallet walk
+		std::sort(vOutputs.begin(), vOutputs.end(), [](const CStakeOutput& a, const CStakeOutput& b) {
+			return COutPoint(a.tx->GetHash(), a.i) < COutPoint(b.tx->GetHash(), b.i);
+		});
+	};
+
+	{
+		LOCK(cs_wallet);
+		if (fStakeIndexLoaded && setStakeDirty.empty()) {
+			collect();
+			return;
 		}
 	}
+
+	// Index is refreshed from validation notifications - cs_main is only required
+	// for changes made outside of them (wallet load, abandon, new own transactions)
+	LOCK2(cs_main, cs_wallet);
+	UpdateStakeIndex();
+	collect();
+}
+
+void CWallet::AvailableCoinsForStaking(std::vector<COutput>& vCoins, unsigned int nSpendTime) const {
+	vCoins.clear();
+
+	std::vector<CStakeOutput> vOutputs;
+	GetStakeOutputs(vOutputs, nSpendTime);
+
+	for (const auto& output : vOutputs) {
+		vCoins.push_back(COutput(output.tx, output.i, output.nDepth, true, (output.mine & ISMINE_SPENDABLE) != ISMINE_NO));
+	}
 }
 
 // Select some coins without random shuffle or best subset approximation
 bool CWallet::SelectCoinsForStaking(int64_t nTargetValue, unsigned int nSpendTime, std::set<std::pair<const CWalletTx*, unsigned int>> & setCoinsRet, int64_t & nValueRet) const
 {
-	std::vector<COutput> vCoins;
-	AvailableCoinsForStaking(vCoins, nSpendTime);
+	std::vector<CStakeOutput> vOutputs;
+	GetStakeOutputs(vOutputs, nSpendTime);
 
-	LogPrint(BCLog::WALLET, "Available coins count %d BestHeader: %d %s\n", vCoins.size(), chainActive.Tip()->nHeight, chainActive.Tip()->GetBlockHash().GetHex());
+	LogPrint(BCLog::WALLET, "Available coins count %d\n", vOutputs.size());
 	setCoinsRet.clear();
 	nValueRet = 0;
 
+	// Get the balances of matured outputs
 	std::map<CTxDestination, CAmount> amounts;
-
-	// Get the balances
-	for (auto & output : vCoins) {
-		const CWalletTx *pcoin = output.tx;
-		int i = output.i;
-
-		int64_t n = pcoin->tx->vout[i].nValue;
-		CTxDestination addr;
-		if (!ExtractDestination(pcoin->tx->vout[i].scriptPubKey, addr)) {
-			continue;
-		}
-
-		auto it = amounts.find(addr);
-
-		if (it == amounts.end()) {
-			amounts[addr] = n;
-		}
-		else {
-			amounts[addr] = amounts[addr] + n;
-		}
+	for (auto & output : vOutputs) {
+		amounts[output.dest] += output.nValue;
 	}
 
-	for (auto & output : vCoins) {
+	for (auto & output : vOutputs) {
 		const CWalletTx *pcoin = output.tx;
 		int i = output.i;
 
-		CTxDestination addr;
-		if (!ExtractDestination(pcoin->tx->vout[i].scriptPubKey, addr)) {
-			continue;
-		}
-
-		if (amounts.find(addr) != amounts.end()) {
-			if (amounts[addr] < Params().GetConsensus().nStakeMinimumThreshold) {
-				continue;
-			}
-		}
-		else {
+		auto itAmount = amounts.find(output.dest);
+		if (itAmount == amounts.end() || itAmount->second < Params().GetConsensus().nStakeMinimumThreshold) {
 			continue;
 		}
 
@@ -4587,7 +4689,7 @@ bool CWallet::SelectCoinsForStaking(int64_t nTargetValue, unsigned int nSpendTim
 			break;
 		}
 
-		int64_t n = pcoin->tx->vout[i].nValue;
+		int64_t n = output.nValue;
 
 		std::pair<int64_t, std::pair<const CWalletTx*, unsigned int> > coin = std::make_pair(n, std::make_pair(pcoin, i));
 
@@ -4646,13 +4748,34 @@ bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, int
 		return false;
 	}
 
+	// Kernel inputs are resolved once per tip and kept between search rounds
+	static Mutex cs_stakeKernels;
+	static StakeKernelTable stakeKernels;
+	LOCK(cs_stakeKernels);
+
+	std::vector<StakeKernelTable::Coin> vStakeCoins;
+	vStakeCoins.reserve(setCoins.size());
+	for (auto & pcoin : setCoins)
+		vStakeCoins.push_back({ pcoin.first->tx, pcoin.second, pcoin.first->hashBlock });
+
+	auto vCandidates = stakeKernels.Update(pindexPrev, nBits, vStakeCoins);
+	auto itCandidate = vCandidates.begin();
+
 	int64_t nCredit = 0;
 	CScript scriptPubKeyKernel;
 	CDataStream hashProofOfStakeSource(SER_GETHASH, 0);
 	for (auto & pcoin : setCoins) {
 		static int nMaxStakeSearchInterval = 60;
+		unsigned int nSearch = (unsigned int)std::min(nSearchInterval, (int64_t)nMaxStakeSearchInterval);
+
+		// Skip timestamps that can't meet the target - kernel is confirmed with CheckKernel below
+		const StakeKernelTable::Candidate* candidate = *itCandidate++;
+		unsigned int nKernelOffset = 0;
+		if (!candidate || nSearch == 0 || !stakeKernels.Search(*candidate, txNew.nTime, nSearch, nKernelOffset))
+			continue;
+
 		bool fKernelFound = false;
-		for (unsigned int n = 0; n < fmin(nSearchInterval, (int64_t)nMaxStakeSearchInterval) && !fKernelFound && pindexPrev == chainActive.Tip(); n++) {
+		for (unsigned int n = nKernelOffset; n < nSearch && !fKernelFound && pindexPrev == chainActive.Tip(); n++) {
 			boost::this_thread::interruption_point();
 			// Search backward in time from the given txNew timestamp
 			// Search nSearchInterval seconds back up to nMaxStakeSearchInterval
@@ -543,6 +543,29 @@ public:
     }
 };
 
+/** Confirmed unspent output of the wallet kept in stake index */
+struct CStakeOutput
+{
+    const CWalletTx* tx;
+    unsigned int i;
+    CAmount nValue;
+    isminetype mine;
+
+    /** Destination extracted once on indexing, fDest is false for non-standard scripts */
+    CTxDestination dest;
+    bool fDest;
+
+    /** Height of the block containing tx, coinbase and coinstake outputs require COINBASE_MATURITY */
+    int nHeight;
+    bool fMaturity;
+
+    /** Earliest stake time: tx time + nStakeMinAge */
+    unsigned int nStakeTime;
+
+    /** Depth at the moment of selection */
+    int nDepth;
+};
+
 /** Private key that includes an expiration date in case it never gets used. */
 class CWalletKey
 {
@@ -641,6 +664,24 @@ private:
      * Should be called with pindexBlock and posInBlock if this is for a transaction that is included in a block. */
     void SyncTransaction(const CTransactionRef& tx, const CBlockIndex *pindex = nullptr, int posInBlock = 0, bool update_tx = true) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /**
+     * Stakeable outputs index. Transactions are marked dirty when wallet state of them or of
+     * their spends changed and are re-indexed from the validation notifications (or lazily
+     * on next read), so stake selection reads the index without walking mapWallet under cs_main.
+     * Protected by cs_wallet.
+     */
+    mutable std::map<COutPoint, CStakeOutput> mapStakeOutputs;
+    mutable std::multimap<unsigned int, COutPoint> mapStakeOutputsByTime;
+    mutable std::map<CTxDestination, CAmount> mapStakeBalances;
+    mutable std::set<uint256> setStakeDirty;
+    mutable bool fStakeIndexLoaded = false;
+    mutable int nStakeTipHeight = -1;
+
+    void MarkStakeDirty(const uint256& hash) { setStakeDirty.insert(hash); }
+    void RemoveStakeOutputs(const uint256& hash) const;
+    void UpdateStakeIndex() const;
+    void GetStakeOutputs(std::vector<CStakeOutput>& vOutputs, unsigned int nSpendTime) const;
+
     /* the HD chain data model (external chain counters) */
     CHDChain hdChain;
 
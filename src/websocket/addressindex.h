@@ -0,0 +1,66 @@
+#ifndef POCKETCOIN_WS_ADDRESSINDEX_H
+#define POCKETCOIN_WS_ADDRESSINDEX_H
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Websocket connection ids by subscribed address.
+// Several sockets can be subscribed to the same address, one socket has one address.
+class WSAddressIndex
+{
+public:
+    // Subscribe connection to address - previous subscription of connection is replaced
+    void Add(const std::string& id, const std::string& address)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        RemoveUnlocked(id);
+
+        m_connections[address].insert(id);
+        m_addresses.emplace(id, address);
+    }
+
+    void Remove(const std::string& id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        RemoveUnlocked(id);
+    }
+
+    std::vector<std::string> Get(const std::string& address)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = m_connections.find(address);
+        if (it == m_connections.end())
+            return {};
+
+        return { it->second.begin(), it->second.end() };
+    }
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::unordered_set<std::string>> m_connections;
+    std::unordered_map<std::string, std::string> m_addresses;
+
+    void RemoveUnlocked(const std::string& id)
+    {
+        auto it = m_addresses.find(id);
+        if (it == m_addresses.end())
+            return;
+
+        auto itConnections = m_connections.find(it->second);
+        if (itConnections != m_connections.end())
+        {
+            itConnections->second.erase(id);
+            if (itConnections->second.empty())
+                m_connections.erase(itConnections);
+        }
+
+        m_addresses.erase(it);
+    }
+};
+
+#endif // POCKETCOIN_WS_ADDRESSINDEX_H
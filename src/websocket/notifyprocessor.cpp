@@ -5,9 +5,10 @@
 #include "pocketdb/pocketnet.h"
 
 
-NotifyBlockProcessor::NotifyBlockProcessor(std::shared_ptr<ProtectedMap<std::string, WSUser>> WSConnections) 
+NotifyBlockProcessor::NotifyBlockProcessor(std::shared_ptr<ProtectedMap<std::string, WSUser>> WSConnections, std::shared_ptr<WSAddressIndex> WSAddresses)
 {
     m_WSConnections = std::move(WSConnections);
+    m_WSAddresses = std::move(WSAddresses);
 
     auto dbBasePath = (GetDataDir() / "pocketdb").string();
     sqliteDbInst = make_shared<SQLiteDatabase>(true);
@@ -375,78 +376,115 @@ void NotifyBlockProcessor::Process(std::pair<CBlock, CBlockIndex*> entry)
         contentsLang.pushKV(TransactionHelper::TxStringType(PocketHelpers::TransactionHelper::ConvertOpReturnToType(itemContent.first)), langContents);
     }
 
+    // Payloads are serialized once and the same buffer is shared by all sockets of the address
+    using OutMessageRef = std::shared_ptr<SimpleWeb::SocketServer<SimpleWeb::WS>::OutMessage>;
+    auto makeOutMessage = [](const std::string& text) {
+        auto out = std::make_shared<SimpleWeb::SocketServer<SimpleWeb::WS>::OutMessage>();
+        out->write(text.data(), static_cast<std::streamsize>(text.size()));
+        return out;
+    };
+
+    std::map<std::string, OutMessageRef> blockMessages;
+    std::unordered_set<std::string> notified;
+
     auto send = [&](std::pair<const std::string, WSUser>& connWS) {
-        UniValue msg(UniValue::VOBJ);
-        msg.pushKV("addr", connWS.second.Address);
-        msg.pushKV("stakeTxHash", _block_stake_txHash);
-        msg.pushKV("msg", "new block");
-        msg.pushKV("blockhash", _block_hash.GetHex());
-        msg.pushKV("time", std::to_string(block.nTime));
-        msg.pushKV("height", blockIndex->nHeight);
-        msg.pushKV("shares", sharesCnt);
-        msg.pushKV("contentsLang", contentsLang);
-
-        auto countResponse = notifierRepoInst->GetPostCountFromMySubscribes(connWS.second.Address, blockIndex->nHeight);
-        if (countResponse.exists("cntTotal"))
+        if (blockIndex->nHeight <= connWS.second.Block)
+            return;
+
+        auto itMsg = blockMessages.find(connWS.second.Address);
+        if (itMsg == blockMessages.end())
         {
-            msg.pushKV("sharesSubscr", countResponse["cntTotal"].get_int());
+            UniValue msg(UniValue::VOBJ);
+            msg.pushKV("addr", connWS.second.Address);
+            msg.pushKV("stakeTxHash", _block_stake_txHash);
+            msg.pushKV("msg", "new block");
+            msg.pushKV("blockhash", _block_hash.GetHex());
+            msg.pushKV("time", std::to_string(block.nTime));
+            msg.pushKV("height", blockIndex->nHeight);
+            msg.pushKV("shares", sharesCnt);
+            msg.pushKV("contentsLang", contentsLang);
+
+            auto countResponse = notifierRepoInst->GetPostCountFromMySubscribes(connWS.second.Address, blockIndex->nHeight);
+            if (countResponse.exists("cntTotal"))
+            {
+                msg.pushKV("sharesSubscr", countResponse["cntTotal"].get_int());
+
+                UniValue contentsSubscribes(UniValue::VOBJ);
+                contentsSubscribes.pushKV("share", (countResponse.exists("cntPost") ? countResponse["cntPost"].get_int() : 0));
+                contentsSubscribes.pushKV("video", (countResponse.exists("cntVideo") ? countResponse["cntVideo"].get_int() : 0));
+                contentsSubscribes.pushKV("article", (countResponse.exists("cntArticle") ? countResponse["cntArticle"].get_int() : 0));
 
-            UniValue contentsSubscribes(UniValue::VOBJ);
-            contentsSubscribes.pushKV("share", (countResponse.exists("cntPost") ? countResponse["cntPost"].get_int() : 0));
-            contentsSubscribes.pushKV("video", (countResponse.exists("cntVideo") ? countResponse["cntVideo"].get_int() : 0));
-            contentsSubscribes.pushKV("article", (countResponse.exists("cntArticle") ? countResponse["cntArticle"].get_int() : 0));
+                msg.pushKV("contentsSubscribes", contentsSubscribes);
+            }
 
-            msg.pushKV("contentsSubscribes", contentsSubscribes);
+            itMsg = blockMessages.emplace(connWS.second.Address, makeOutMessage(msg.write())).first;
         }
 
-        if (blockIndex->nHeight > connWS.second.Block)
+        try
         {
-            try
-            {
-                connWS.second.Connection->send(msg.write(), [](const SimpleWeb::error_code& ec) {});
-            }
-            catch (const std::exception& e)
-            {
-                LogPrintf("Error: CChainState::NotifyWSClients (1) - %s\n", e.what());
-            }
+            connWS.second.Connection->send(itMsg->second, [](const SimpleWeb::error_code& ec) {});
+        }
+        catch (const std::exception& e)
+        {
+            LogPrintf("Error: CChainState::NotifyWSClients (1) - %s\n", e.what());
+        }
+
+        // TODO: Notification from POCKETNET_TEAM
+        // if (txidpocketnet != "")
+        // {
+        //     try
+        //     {
+        //         UniValue m(UniValue::VOBJ);
+        //         m.pushKV("msg", "sharepocketnet");
+        //         m.pushKV("time", std::to_string(block.nTime));
+        //         m.pushKV("addrFrom", addrespocketnet);
+        //         if (pocketnetaccinfo.exists("name")) m.pushKV("nameFrom", pocketnetaccinfo["name"].get_str());
+        //         if (pocketnetaccinfo.exists("avatar")) m.pushKV("avatarFrom", pocketnetaccinfo["avatar"].get_str());
+        //         m.pushKV("txids", txidpocketnet.substr(0, txidpocketnet.size() - 1));
+        //         connWS.second.Connection->send(m.write(), [](const SimpleWeb::error_code& ec) {});
+        //     }
+        //     catch (const std::exception& e)
+        //     {
+        //         LogPrintf("Error: CChainState::NotifyWSClients (1) - %s\n", e.what());
+        //     }
+        // }
+
+        connWS.second.Block = blockIndex->nHeight;
+        notified.insert(connWS.first);
+    };
+    m_WSConnections->Iterate(send);
+
+    // Events are delivered only to the sockets of recipients that received this block
+    for (const auto& addressMessages : messages)
+    {
+        auto ids = m_WSAddresses->Get(addressMessages.first);
+        if (ids.empty())
+            continue;
+
+        std::vector<OutMessageRef> outMessages;
+        for (const auto& m : addressMessages.second)
+            outMessages.push_back(makeOutMessage(m.write()));
+
+        for (const auto& id : ids)
+        {
+            if (notified.find(id) == notified.end())
+                continue;
+
+            auto connWS = m_WSConnections->find(id);
+            if (!connWS)
+                continue;
 
-            // TODO: Notification from POCKETNET_TEAM
-            // if (txidpocketnet != "")
-            // {
-            //     try
-            //     {
-            //         UniValue m(UniValue::VOBJ);
-            //         m.pushKV("msg", "sharepocketnet");
-            //         m.pushKV("time", std::to_string(block.nTime));
-            //         m.pushKV("addrFrom", addrespocketnet);
-            //         if (pocketnetaccinfo.exists("name")) m.pushKV("nameFrom", pocketnetaccinfo["name"].get_str());
-            //         if (pocketnetaccinfo.exists("avatar")) m.pushKV("avatarFrom", pocketnetaccinfo["avatar"].get_str());
-            //         m.pushKV("txids", txidpocketnet.substr(0, txidpocketnet.size() - 1));
-            //         connWS.second.Connection->send(m.write(), [](const SimpleWeb::error_code& ec) {});
-            //     }
-            //     catch (const std::exception& e)
-            //     {
-            //         LogPrintf("Error: CChainState::NotifyWSClients (1) - %s\n", e.what());
-            //     }
-            // }
-
-            if (messages.find(connWS.second.Address) != messages.end())
+            for (const auto& outMessage : outMessages)
             {
-                for (auto m : messages[connWS.second.Address])
+                try
                 {
-                    try
-                    {
-                        connWS.second.Connection->send(m.write(), [](const SimpleWeb::error_code& ec) {});
-                    }
-                    catch (const std::exception& e)
-                    {
-                        LogPrintf("Error: CChainState::NotifyWSClients (2) - %s\n", e.what());
-                    }
+                    connWS->second.Connection->send(outMessage, [](const SimpleWeb::error_code& ec) {});
+                }
+                catch (const std::exception& e)
+                {
+                    LogPrintf("Error: CChainState::NotifyWSClients (2) - %s\n", e.what());
                 }
             }
-
-            connWS.second.Block = blockIndex->nHeight;
         }
-    };
-    m_WSConnections->Iterate(send);
+    }
 }
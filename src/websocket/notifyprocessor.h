@@ -3,6 +3,7 @@
 
 #include "eventloop.h"
 #include "protectedmap.h"
+#include "websocket/addressindex.h"
 #include "univalue.h"
 #include "websocket/ws.h"
 
@@ -20,13 +21,14 @@ typedef std::map<std::string, std::string> custom_fields;
 class NotifyBlockProcessor : public IQueueProcessor<std::pair<CBlock, CBlockIndex*>>
 {
 public:
-    explicit NotifyBlockProcessor(std::shared_ptr<ProtectedMap<std::string, WSUser>> WSConnections);
+    NotifyBlockProcessor(std::shared_ptr<ProtectedMap<std::string, WSUser>> WSConnections, std::shared_ptr<WSAddressIndex> WSAddresses);
     ~NotifyBlockProcessor() override;
     void Process(std::pair<CBlock, CBlockIndex*> entry) override;
 
 private:
     void PrepareWSMessage(std::map<std::string, std::vector<UniValue>>& messages, std::string msg_type, std::string addrTo, std::string txid, int64_t txtime, custom_fields cFields);
     std::shared_ptr<ProtectedMap<std::string, WSUser>> m_WSConnections;
+    std::shared_ptr<WSAddressIndex> m_WSAddresses;
     
     SQLiteDatabaseRef sqliteDbInst;
     NotifierRepositoryRef notifierRepoInst;